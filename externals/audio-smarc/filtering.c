@@ -24,88 +24,71 @@
 
 #include "filtering.h"
 
-#ifndef __SSE2__
+#if defined(__AVX__)
+
+#include <immintrin.h>
 
 double filter(const double* restrict filt, const double* restrict signal, const int K)
 {
-	register double v = 0.0;
-	for (int k=0;k<K;++k)
-		v+=filt[k]*signal[k];
-	return v;
+	// two accumulators to hide addition latency, unaligned loads so that
+	// the result does not depend on buffers alignment
+	__m256d v0 = _mm256_setzero_pd();
+	__m256d v1 = _mm256_setzero_pd();
+	int k=0;
+	for (;k+8<=K;k+=8) {
+		v0 = _mm256_add_pd(v0,_mm256_mul_pd(_mm256_loadu_pd(filt+k),_mm256_loadu_pd(signal+k)));
+		v1 = _mm256_add_pd(v1,_mm256_mul_pd(_mm256_loadu_pd(filt+k+4),_mm256_loadu_pd(signal+k+4)));
+	}
+	if (k+4<=K) {
+		v0 = _mm256_add_pd(v0,_mm256_mul_pd(_mm256_loadu_pd(filt+k),_mm256_loadu_pd(signal+k)));
+		k+=4;
+	}
+	v0 = _mm256_add_pd(v0,v1);
+	__m128d v = _mm_add_pd(_mm256_castpd256_pd128(v0),_mm256_extractf128_pd(v0,1));
+	double tmp[2];
+	_mm_storeu_pd(tmp,v);
+	double r = tmp[0] + tmp[1];
+	for (;k<K;++k)
+		r+=filt[k]*signal[k];
+	return r;
 }
 
-#else
+#elif defined(__SSE2__)
 
 #include <emmintrin.h>
 
-double basic_filter(const double* restrict filt, const double* restrict signal, const int K)
+double filter(const double* restrict filt, const double* restrict signal, const int K)
 {
-//	printf("basic filter for K=%i\n",K);
-	register double v = 0.0;
-	for (int k=0;k<K;++k)
-		v+=filt[k]*signal[k];
-	return v;
-}
-
-double sse_filtering_aligned(const double* restrict filt, const double* restrict signal, const int K) {
-//	printf("sse_filtering filt=%p signal=%p K=%i\n",filt,signal,K);
-	// filt and signal are 16 byte aligned, K % 2 = 0
-	__m128d v = _mm_setzero_pd();
+	// two accumulators to hide addition latency, unaligned loads so that
+	// the result does not depend on buffers alignment
+	__m128d v0 = _mm_setzero_pd();
+	__m128d v1 = _mm_setzero_pd();
 	int k=0;
-	for (;k<K-1;k+=2) {
-		__m128d f = _mm_load_pd(filt + k);
-		__m128d s = _mm_load_pd(signal + k);
-		v = _mm_add_pd(v,_mm_mul_pd(f,s));
+	for (;k+4<=K;k+=4) {
+		v0 = _mm_add_pd(v0,_mm_mul_pd(_mm_loadu_pd(filt+k),_mm_loadu_pd(signal+k)));
+		v1 = _mm_add_pd(v1,_mm_mul_pd(_mm_loadu_pd(filt+k+2),_mm_loadu_pd(signal+k+2)));
 	}
-	double tmp[2];
-	_mm_storeu_pd(tmp,v);
-	if (k==K)
-		return tmp[0] + tmp[1];
-	// else
-	return tmp[0] + tmp[1] + filt[k]*signal[k];
-}
-
-double sse_filtering_misaligned(const double* restrict filt, const double* restrict signal, const int K) {
-//	printf("sse_filtering_misaligned filt=%p signal=%p K=%i\n",filt,signal,K);
-	__m128d v = _mm_setzero_pd();
-	__m128d s = _mm_load1_pd(signal);
-	int k=0;
-	for (;k<K-4;k+=4) {
-		__m128d f = _mm_load_pd(filt + k);
-		__m128d s2 = _mm_load_pd(signal + k + 1);
-		s = _mm_shuffle_pd(s,s2,_MM_SHUFFLE2(0,1));
-		v = _mm_add_pd(v,_mm_mul_pd(f,s));
-		f = _mm_load_pd(filt + k + 2);
-		s = _mm_load_pd(signal + k + 3);
-		s2 = _mm_shuffle_pd(s2,s,_MM_SHUFFLE2(0,1));
-		v = _mm_add_pd(v,_mm_mul_pd(f,s2));
+	if (k+2<=K) {
+		v0 = _mm_add_pd(v0,_mm_mul_pd(_mm_loadu_pd(filt+k),_mm_loadu_pd(signal+k)));
+		k+=2;
 	}
+	v0 = _mm_add_pd(v0,v1);
 	double tmp[2];
-	_mm_storeu_pd(tmp,v);
-	for (;k<K;++k)
-		tmp[0]+=filt[k]*signal[k];
-	return tmp[0] + tmp[1];
+	_mm_storeu_pd(tmp,v0);
+	double r = tmp[0] + tmp[1];
+	if (k<K)
+		r+=filt[k]*signal[k];
+	return r;
 }
 
-double filter(const double* restrict filt, const double* restrict signal, int K)
+#else
+
+double filter(const double* restrict filt, const double* restrict signal, const int K)
 {
-	if (K<8)
-		return basic_filter(filt,signal,K);
-	double v = 0;
-	if ((((unsigned long)filt) & 15) != 0) { // if filt is not 16-bytes aligned
-		v += filt[0]*signal[0];
-		++filt;
-		++signal;
-		--K;
-	}
-	if ((((unsigned long)signal) & 15) == 0) { // if signal is 16-bytes aligned
-		return v + sse_filtering_aligned(filt,signal,K);
-	}
-	// else
-	return v + sse_filtering_misaligned(filt,signal,K);
+	register double v = 0.0;
+	for (int k=0;k<K;++k)
+		v+=filt[k]*signal[k];
+	return v;
 }
 
-
 #endif
-
-
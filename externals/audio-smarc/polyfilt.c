@@ -35,6 +35,10 @@ void polyfiltLM(struct PSFilter* pfilt, struct PSState* pstate,
 	const int L = pfilt->L;
 	const int K = pfilt->K;
 
+	// each output advances M/L input samples
+	const int advance = M / L;
+	const int phaseStep = M % L;
+
 	int signalPos = 0;
 	int outPos = 0;
 	int phase = pstate->phase;
@@ -58,9 +62,12 @@ void polyfiltLM(struct PSFilter* pfilt, struct PSState* pstate,
 		output[outPos++] = filter(pfilt->filters + phase*K,signal + signalPos, K);
 
 		// consume samples
-		phase += M;
-		signalPos += phase / L;
-		phase = phase % L;
+		signalPos += advance;
+		phase += phaseStep;
+		if (phase>=L) {
+			phase -= L;
+			signalPos++;
+		}
 	}
 
 	// report state values
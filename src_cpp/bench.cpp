@@ -0,0 +1,760 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include "argtable2.h"
+#include "yaafe-core/DataFlow.h"
+#include "yaafe-core/Engine.h"
+#include "yaafe-core/ComponentFactory.h"
+#include "yaafe-core/FeaturePlan.h"
+#include "yaafe-core/Profiler.h"
+#include "yaafe-core/Thread.h"
+
+using namespace YAAFE;
+using namespace std;
+
+#define BENCH_SAMPLERATE 16000
+
+/**
+ * A benchmark case describes how to build a representative input for a
+ * component: a chain of components computed from synthetic audio, which
+ * output is connected to nbInputs input ports of the benchmarked component.
+ * Components with named output ports list them in outputs.
+ */
+struct BenchCase {
+  const char* component;
+  const char* params;
+  const char* input;
+  int nbInputs;
+  const char* outputs;
+};
+
+#define FRAMES "FrameTokenizer blockSize=1024 stepSize=512"
+#define SPECTRUM FRAMES " > FFT FFTLength=1024 FFTWindow=Hanning > Abs"
+#define CQT_INPUT "Decimate2 > AdvancedFrameTokenizer blockSize=1024 outSampleRate=16000 outStepSize=512 > FFT FFTLength=1024 FFTWindow=None"
+#define CQT_PARAMS "CQTAlign=c CQTBinsPerOctave=36 CQTMaxFreq=0.29368 CQTMinFreq=0.14684"
+#define CHROMA CQT_INPUT " > CQT " CQT_PARAMS " > ChromaTune CQTBinsPerOctave=36 CQTMinFreq=73.42 CTInitDuration=15"
+
+// parameters and inputs follow the default feature definitions
+static const BenchCase s_cases[] = {
+  { "AC2LPC", "LPCNbCoeffs=10", FRAMES " > AutoCorrelation ACNbCoeffs=11", 1 },
+  { "Abs", "", FRAMES " > FFT FFTLength=1024 FFTWindow=Hanning", 1 },
+  { "AdvancedFrameTokenizer", "blockSize=1024 outSampleRate=16000 outStepSize=512", "Decimate2", 1 },
+  { "AmplitudeModulation", "EnDecim=200", "FrameTokenizer blockSize=32768 stepSize=16384 > Envelope EnDecim=200", 1 },
+  { "AutoCorrelation", "ACNbCoeffs=49", FRAMES, 1 },
+  { "AutoCorrelationPeaksIntegrator", "ACPInterPeakMinDist=5 ACPNbPeaks=3 ACPNorm=BPM NbFrames=128 StepNbFrames=64", SPECTRUM " > Sum", 1 },
+  { "CQT", CQT_PARAMS, CQT_INPUT, 1 },
+  { "Cepstrum", "CepsIgnoreFirstCoeff=1 CepsNbCoeffs=13", SPECTRUM " > MelFilterBank", 1 },
+  { "ChordDictDecoder", "ChordTypes=maj,min", CHROMA " > ChromaReduce > Chroma2ChordDict ChordNbHarmonics=1 ChordTypes=maj,min", 1 },
+  { "Chroma2ChordDict", "ChordNbHarmonics=1 ChordTypes=maj,min", CHROMA " > ChromaReduce", 1 },
+  { "ChromaReduce", "", CHROMA, 1 },
+  { "ChromaTune", "CQTBinsPerOctave=36 CQTMinFreq=73.42 CTInitDuration=15", CQT_INPUT " > CQT " CQT_PARAMS, 1 },
+  { "ComplexDomainFlux", "", FRAMES " > FFT FFTLength=1024 FFTWindow=Hanning", 1 },
+  { "Concatenate", "", SPECTRUM " > MelFilterBank", 3 },
+  { "Decimate2", "", "", 1 },
+  { "Derivate", "DO1Len=4 DO2Len=1 DOrder=1", SPECTRUM " > MelFilterBank > Cepstrum", 1 },
+  { "DvornikovDifferentiator", "DDOrder=0.08s", SPECTRUM " > LogCompression", 1 },
+  { "Envelope", "EnDecim=200", "FrameTokenizer blockSize=32768 stepSize=16384", 1 },
+  { "FFT", "FFTLength=1024 FFTWindow=Hanning", FRAMES, 1 },
+  { "FilterSmallValues", "FSVThreshold=0.001", SPECTRUM, 1 },
+  { "FrameTokenizer", "blockSize=1024 stepSize=512", "", 1 },
+  { "HalfHannFilter", "HHFOrder=0.175s", SPECTRUM, 1 },
+  { "HistogramIntegrator", "HInf=0 HNbBins=10 HSup=1 HWeighted=0 NbFrames=60 StepNbFrames=30", FRAMES " > ZCR", 1 },
+  { "HistogramSummary", "HInf=40 HSup=200", SPECTRUM " > Sum > AutoCorrelationPeaksIntegrator ACPInterPeakMinDist=5 ACPNbPeaks=3 ACPNorm=BPM NbFrames=32 StepNbFrames=4 > HistogramIntegrator HInf=40 HNbBins=80 HSup=200 HWeighted=1 NbFrames=8 StepNbFrames=4", 1 },
+  { "Join", "", SPECTRUM " > MelFilterBank", 2 },
+  { "LPC2LSF", "LSFDisplacement=1 LSFNbCoeffs=10", FRAMES " > AutoCorrelation ACNbCoeffs=11 > AC2LPC LPCNbCoeffs=10", 1 },
+  { "Loudness", "", SPECTRUM " > Sqr", 1 },
+  { "LoudnessDescriptors", "", SPECTRUM " > Sqr", 1, "Total,Sharpness,Spread" },
+  { "LoudnessSharpness", "", SPECTRUM " > Sqr > Loudness > Normalize NNorm=Sum", 1 },
+  { "LoudnessSpread", "", SPECTRUM " > Sqr > Loudness > Normalize NNorm=Sum", 1 },
+  { "MedianFilter", "MFOrder=0.75s", SPECTRUM " > MelFilterBank", 1 },
+  { "MelFilterBank", "MelMaxFreq=6854.0 MelMinFreq=130.0 MelNbFilters=40", SPECTRUM, 1 },
+  { "MultiOctaveCQT", "CQTAlign=c CQTBinsPerOctave=36 CQTMinFreq=73.42 CQTNbOctaves=3 stepSize=512", "", 1 },
+  { "Normalize", "NNorm=Sum", SPECTRUM " > Sqr > Loudness", 1 },
+  { "NormalizeMaxAll", "NMANbFrames=5000", SPECTRUM, 1 },
+  { "OBSI", "OBSIMinFreq=27.5", SPECTRUM " > Sqr", 1 },
+  { "Difference", "DiffNbCoeffs=0", SPECTRUM " > Sqr > OBSI OBSIMinFreq=27.5", 1 },
+  { "Rolloff", "", SPECTRUM " > Sqr", 1 },
+  { "Slope", "", SPECTRUM, 1 },
+  { "SlopeIntegrator", "NbFrames=60 StepNbFrames=30", SPECTRUM " > MelFilterBank > Cepstrum", 1 },
+  { "SpectralCrestFactorPerBand", "", SPECTRUM " > Sqr", 1 },
+  { "SpectralFlatnessPerBand", "", SPECTRUM " > Sqr", 1 },
+  { "SpectralDescriptors", "", SPECTRUM " > Sqr", 1,
+    "ShapeStatistics,Flatness,Rolloff,Slope,Decrease,SpectralFlatnessPerBand,SpectralCrestFactorPerBand,Variation" },
+  { "StatisticalIntegrator", "NbFrames=60 SICompute=MeanStddev StepNbFrames=30", SPECTRUM " > MelFilterBank > Cepstrum", 1 },
+  { "ShapeStatistics", "", SPECTRUM, 1 },
+  { "RMS", "", FRAMES, 1 },
+  { "ZCR", "", FRAMES, 1 },
+  { NULL, NULL, NULL, 0, NULL }
+};
+
+// input used for components without a dedicated benchmark case
+static const BenchCase s_defaultCase = { NULL, "", SPECTRUM, 1, NULL };
+
+struct BenchResult {
+  string name;
+  string description;
+  string status;
+  long long tokens;
+  double wallTime;
+  double nsPerToken;
+  double tokensPerSecond;
+  double mbPerSecond;
+  double realtimeFactor;
+};
+
+static ParameterMap parseParams(const string& str)
+{
+  ParameterMap params;
+  istringstream iss(str);
+  string kv;
+  while (iss >> kv) {
+    size_t eq = kv.find('=');
+    if (eq==string::npos)
+      continue;
+    params[kv.substr(0,eq)] = kv.substr(eq+1);
+  }
+  return params;
+}
+
+/**
+ * Build a dataflow 'Input > chain > component > Output', and name the
+ * benchmarked node 'bench'. Steps which do not reach an output are not
+ * run.
+ */
+static void buildCaseDataFlow(DataFlow& df, const BenchCase& bc,
+    const string& component)
+{
+  ParameterMap inputParams;
+  inputParams["SampleRate"] = "16000";
+  DataFlow::Node* prev = df.createNode(NodeDesc("Input",inputParams));
+  df.setNodeName(prev,"audio");
+  string chain = bc.input;
+  size_t pos = 0;
+  while (pos<chain.size()) {
+    size_t end = chain.find('>',pos);
+    if (end==string::npos)
+      end = chain.size();
+    istringstream iss(chain.substr(pos,end-pos));
+    string id;
+    iss >> id;
+    string rest;
+    getline(iss,rest);
+    DataFlow::Node* n = df.createNode(NodeDesc(id,parseParams(rest)));
+    df.link(prev,"",n,"");
+    prev = n;
+    pos = end+1;
+  }
+  DataFlow::Node* target = df.createNode(NodeDesc(component,parseParams(bc.params)));
+  df.setNodeName(target,"bench");
+  if (bc.nbInputs==1) {
+    df.link(prev,"",target,"");
+  } else {
+    for (int i=0;i<bc.nbInputs;i++) {
+      ostringstream port;
+      port << i;
+      df.link(prev,"",target,port.str());
+    }
+  }
+  string outputs = bc.outputs ? bc.outputs : "";
+  pos = 0;
+  do {
+    size_t end = outputs.find(',',pos);
+    if (end==string::npos)
+      end = outputs.size();
+    string port = outputs.substr(pos,end-pos);
+    DataFlow::Node* out = df.createNode(NodeDesc("Output",ParameterMap()));
+    df.setNodeName(out,port.empty() ? "out" : port);
+    df.link(target,port,out,"");
+    pos = end+1;
+  } while (pos<outputs.size());
+  df.useComponentLibrary("yaafe-components");
+}
+
+static void syntheticAudio(vector<double>& signal, double sampleRate)
+{
+  unsigned int seed = 12345;
+  for (size_t i=0;i<signal.size();i++) {
+    seed = seed * 1103515245 + 12345;
+    const double noise = ((seed >> 8) & 0xffff) / 65536.0 - 0.5;
+    const double t = i / sampleRate;
+    signal[i] = 0.5*sin(2*M_PI*440*t)*(1+0.5*sin(2*M_PI*6*t))
+        + 0.3*sin(2*M_PI*1250*t) + 0.1*noise;
+  }
+}
+
+/**
+ * Process the signal through the engine, by chunks of the prefered data
+ * block size. Returns the wall time spent in process and flush.
+ */
+static double runEngine(Engine& engine, const vector<double>& signal)
+{
+  engine.reset();
+  OutputBuffer* in = engine.getInput("audio");
+  const int chunk = DataBlock::preferedBlockSize();
+  const double start = Profiler::wallClock();
+  for (size_t pos=0;pos<signal.size();pos+=chunk) {
+    int n = min((size_t) chunk,signal.size()-pos);
+    in->write((double*) &signal[pos],n);
+    engine.process();
+  }
+  engine.flush();
+  const double elapsed = Profiler::wallClock() - start;
+  vector<string> outputs = engine.getOutputs();
+  for (size_t i=0;i<outputs.size();i++) {
+    InputBuffer* out = engine.getOutput(outputs[i]);
+    out->consumeTokens(out->availableTokens());
+  }
+  return elapsed;
+}
+
+typedef vector<vector<double> > EngineOutputs;
+
+/**
+ * Process the signal by chunks of the given size and read all outputs.
+ */
+static void computeOutputs(Engine& engine, const vector<double>& signal,
+    int chunk, EngineOutputs& outputs)
+{
+  engine.reset();
+  OutputBuffer* in = engine.getInput("audio");
+  for (size_t pos=0;pos<signal.size();pos+=chunk) {
+    int n = min((size_t) chunk,signal.size()-pos);
+    in->write((double*) &signal[pos],n);
+    engine.process();
+  }
+  engine.flush();
+  vector<string> names = engine.getOutputs();
+  outputs.resize(names.size());
+  for (size_t i=0;i<names.size();i++) {
+    InputBuffer* out = engine.getOutput(names[i]);
+    const int nbTokens = out->availableTokens();
+    outputs[i].resize((size_t) nbTokens * out->info().size);
+    if (nbTokens)
+      out->read(&outputs[i][0],nbTokens);
+    out->consumeTokens(nbTokens);
+  }
+}
+
+static bool sameOutputs(const EngineOutputs& a, const EngineOutputs& b)
+{
+  if (a.size()!=b.size())
+    return false;
+  for (size_t i=0;i<a.size();i++) {
+    if (a[i].size()!=b[i].size())
+      return false;
+    for (size_t j=0;j<a[i].size();j++)
+      if (!(fabs(a[i][j]-b[i][j]) <= 1e-9 * (1 + fabs(a[i][j]))))
+        return false;
+  }
+  return true;
+}
+
+/**
+ * Engine run in its own thread, either loaded from the dataflow or cloned
+ * from an engine loaded in the main thread.
+ */
+class EngineThread : public Thread
+{
+ public:
+  EngineThread(const DataFlow& d, const Engine* p, const vector<double>& s,
+      int c) : df(d), prototype(p), signal(s), chunk(c), ok(false) {}
+  virtual ~EngineThread() { join(); }
+
+  const DataFlow& df;
+  const Engine* prototype;
+  const vector<double>& signal;
+  int chunk;
+  bool ok;
+  EngineOutputs outputs;
+
+ protected:
+  virtual void run() {
+    Engine* engine = NULL;
+    if (prototype) {
+      engine = prototype->clone();
+    } else {
+      engine = new Engine();
+      if (!engine->load(df)) {
+        delete engine;
+        engine = NULL;
+      }
+    }
+    if (!engine)
+      return;
+    computeOutputs(*engine,signal,chunk,outputs);
+    delete engine;
+    ok = true;
+  }
+};
+
+/**
+ * Run nbThreads engines concurrently on the same signal, half of them
+ * loaded and half cloned, and compare their outputs with a run in the
+ * main thread. Each thread uses a different input chunk size.
+ */
+static string checkThreads(const DataFlow& df, int nbThreads, double duration)
+{
+  Engine engine;
+  if (!engine.load(df))
+    return "skipped";
+  vector<string> inputs = engine.getInputs();
+  if (inputs.size()!=1 || inputs[0]!="audio")
+    return "skipped";
+  const double sampleRate = engine.getInput("audio")->info().sampleRate;
+  vector<double> signal((size_t) (duration * sampleRate));
+  syntheticAudio(signal,sampleRate);
+  EngineOutputs reference;
+  computeOutputs(engine,signal,DataBlock::preferedBlockSize(),reference);
+  if (reference.empty())
+    return "no output";
+
+  vector<EngineThread*> threads;
+  for (int i=0;i<nbThreads;i++)
+    threads.push_back(new EngineThread(df, (i%2) ? &engine : NULL, signal,
+        1000 + 337*i));
+  for (size_t i=0;i<threads.size();i++)
+    threads[i]->start();
+  string status = "ok";
+  for (size_t i=0;i<threads.size();i++) {
+    threads[i]->join();
+    if (!threads[i]->ok)
+      status = "failed";
+    else if (status=="ok" && !sameOutputs(reference,threads[i]->outputs))
+      status = "MISMATCH";
+    delete threads[i];
+  }
+  return status;
+}
+
+static BenchResult emptyResult(const string& name, const string& description)
+{
+  BenchResult res;
+  res.name = name;
+  res.description = description;
+  res.tokens = 0;
+  res.wallTime = 0;
+  res.nsPerToken = 0;
+  res.tokensPerSecond = 0;
+  res.mbPerSecond = 0;
+  res.realtimeFactor = 0;
+  return res;
+}
+
+static BenchResult benchComponent(const string& component, const BenchCase& bc,
+    double duration, double minTime)
+{
+  string description = bc.params;
+  if (bc.input[0]!='\0')
+    description = string(bc.input) + " > " + description;
+  BenchResult res = emptyResult(component,description);
+
+  DataFlow df;
+  buildCaseDataFlow(df,bc,component);
+  Engine engine;
+  if (!engine.load(df)) {
+    res.status = "skipped";
+    return res;
+  }
+  engine.enableProfiling();
+  vector<double> signal((size_t) (duration * BENCH_SAMPLERATE));
+  syntheticAudio(signal,BENCH_SAMPLERATE);
+
+  // warm up, then run until enough time is spent in the component
+  runEngine(engine,signal);
+  engine.getProfiler()->clear();
+  const StepProfile* p = NULL;
+  const vector<StepProfile*>& steps = engine.getProfiler()->getSteps();
+  for (size_t i=0;i<steps.size();i++)
+    if (steps[i]->m_name=="bench")
+      p = steps[i];
+  double total = 0;
+  int runs = 0;
+  do {
+    total += runEngine(engine,signal);
+    runs++;
+  } while (p->m_wallTime < minTime && total < 20 * minTime);
+
+  res.status = "ok";
+  res.tokens = p->m_tokensIn;
+  res.wallTime = p->m_wallTime;
+  if (p->m_tokensIn==0 || p->m_wallTime<=0) {
+    res.status = "no output";
+    return res;
+  }
+  res.nsPerToken = 1e9 * p->m_wallTime / p->m_tokensIn;
+  res.tokensPerSecond = p->m_tokensIn / p->m_wallTime;
+  res.mbPerSecond = p->m_bytesIn / p->m_wallTime / (1024.0 * 1024.0);
+  res.realtimeFactor = runs * duration / p->m_wallTime;
+  return res;
+}
+
+/**
+ * Benchmark a whole dataflow with a single 'audio' input, the wall time
+ * being the time spent in process and flush of the engine.
+ */
+static BenchResult benchDataFlow(const string& name, const string& description,
+    const DataFlow& df, double duration, double minTime)
+{
+  BenchResult res = emptyResult(name,description);
+  Engine engine;
+  if (!engine.load(df)) {
+    res.status = "failed";
+    return res;
+  }
+  vector<string> inputs = engine.getInputs();
+  if (inputs.size()!=1 || inputs[0]!="audio") {
+    cerr << "ERROR: " << description << " " << name << " must have a single 'audio' input" << endl;
+    res.status = "failed";
+    return res;
+  }
+  const double sampleRate = engine.getInput("audio")->info().sampleRate;
+  vector<double> signal((size_t) (duration * sampleRate));
+  syntheticAudio(signal,sampleRate);
+
+  runEngine(engine,signal);
+  int runs = 0;
+  do {
+    res.wallTime += runEngine(engine,signal);
+    runs++;
+  } while (res.wallTime < minTime);
+
+  res.status = "ok";
+  res.tokens = (long long) runs * signal.size();
+  res.nsPerToken = 1e9 * res.wallTime / res.tokens;
+  res.tokensPerSecond = res.tokens / res.wallTime;
+  res.mbPerSecond = res.tokens * sizeof(double) / res.wallTime / (1024.0 * 1024.0);
+  res.realtimeFactor = runs * duration / res.wallTime;
+  return res;
+}
+
+static void printResult(const BenchResult& r)
+{
+  if (r.status!="ok") {
+    printf("%-32s %s\n", r.name.c_str(), r.status.c_str());
+    return;
+  }
+  printf("%-32s %12.2f ns/token %14.0f tokens/s %10.2f MB/s %10.1fx realtime\n",
+      r.name.c_str(), r.nsPerToken, r.tokensPerSecond, r.mbPerSecond,
+      r.realtimeFactor);
+}
+
+static void printThreadsResult(const string& name, int nbThreads,
+    const string& status)
+{
+  printf("%-32s %i threads %s\n", name.c_str(), nbThreads, status.c_str());
+}
+
+static void writeJSONString(ostream& os, const string& str)
+{
+  os << '"';
+  for (size_t i=0;i<str.size();i++) {
+    if (str[i]=='"' || str[i]=='\\')
+      os << '\\';
+    os << str[i];
+  }
+  os << '"';
+}
+
+static void writeResults(ostream& os, const char* key,
+    const vector<BenchResult>& results)
+{
+  os << "  ";
+  writeJSONString(os,key);
+  os << ": [";
+  for (size_t i=0;i<results.size();i++) {
+    const BenchResult& r = results[i];
+    // one result per line, so that --compare can read it back
+    os << (i ? ",\n" : "\n") << "    {\"name\": ";
+    writeJSONString(os,r.name);
+    os << ", \"status\": ";
+    writeJSONString(os,r.status);
+    os << ", \"nsPerToken\": " << r.nsPerToken
+       << ", \"tokensPerSecond\": " << r.tokensPerSecond
+       << ", \"mbPerSecond\": " << r.mbPerSecond
+       << ", \"realtimeFactor\": " << r.realtimeFactor
+       << ", \"tokens\": " << r.tokens
+       << ", \"wallTime\": " << r.wallTime
+       << ", \"case\": ";
+    writeJSONString(os,r.description);
+    os << "}";
+  }
+  os << "\n  ]";
+}
+
+static bool saveJSON(const string& filename,
+    const vector<BenchResult>& components,
+    const vector<BenchResult>& dataflows,
+    const vector<BenchResult>& featureplans)
+{
+  ofstream out(filename.c_str());
+  if (!out.is_open()) {
+    cerr << "ERROR: cannot open file " << filename << endl;
+    return false;
+  }
+  out << "{\n  \"version\": \"" << ComponentFactory::version() << "\",\n";
+  writeResults(out,"components",components);
+  out << ",\n";
+  writeResults(out,"dataflows",dataflows);
+  out << ",\n";
+  writeResults(out,"featureplans",featureplans);
+  out << "\n}\n";
+  return out.good();
+}
+
+/**
+ * Read nsPerToken values from a file written by saveJSON.
+ */
+static bool loadJSON(const string& filename, map<string,double>& values)
+{
+  ifstream in(filename.c_str());
+  if (!in.is_open()) {
+    cerr << "ERROR: cannot open file " << filename << endl;
+    return false;
+  }
+  string line;
+  while (getline(in,line)) {
+    size_t namePos = line.find("{\"name\": \"");
+    size_t nsPos = line.find("\"nsPerToken\": ");
+    if (namePos==string::npos || nsPos==string::npos)
+      continue;
+    namePos += 10;
+    size_t nameEnd = line.find('"',namePos);
+    values[line.substr(namePos,nameEnd-namePos)] = atof(line.c_str() + nsPos + 14);
+  }
+  return true;
+}
+
+/**
+ * Print relative changes against a previous run, and returns the number
+ * of benchmarks slower than threshold percents.
+ */
+static int compareResults(const map<string,double>& previous,
+    const vector<BenchResult>& results, double threshold)
+{
+  int regressions = 0;
+  for (size_t i=0;i<results.size();i++) {
+    const BenchResult& r = results[i];
+    map<string,double>::const_iterator it = previous.find(r.name);
+    if (r.status!="ok" || it==previous.end() || it->second<=0)
+      continue;
+    const double change = 100.0 * (r.nsPerToken - it->second) / it->second;
+    const bool regression = (change > threshold);
+    if (regression)
+      regressions++;
+    printf("%-32s %12.2f -> %12.2f ns/token %+7.1f%%%s\n", r.name.c_str(),
+        it->second, r.nsPerToken, change, regression ? "  REGRESSION" : "");
+  }
+  return regressions;
+}
+
+struct arg_lit *h, *nocomponents;
+struct arg_str *libs, *names;
+struct arg_file *dataflows, *featureplans, *json, *compare;
+struct arg_dbl *duration, *mintime, *threshold;
+struct arg_int *datablock, *blockbytes, *nbthreads;
+struct arg_end *end_;
+
+int main(int argc, char **argv)
+{
+  int exitcode = 0;
+  const char* progname = argv[0];
+
+  void* argtable[] = {
+    h = arg_lit0("h","help", "print this help and exit"),
+    libs = arg_strn("x","loadlibrary","libnames",0,10,"yaafe component library name to load."),
+    dataflows = arg_filen("c",NULL,"file",0,argc,"dataflow to benchmark end-to-end (may be repeated)"),
+    featureplans = arg_filen(NULL,"featureplan","file",0,argc,"feature plan to compile and benchmark end-to-end (may be repeated)"),
+    nocomponents = arg_lit0(NULL,"no-components","do not benchmark individual components"),
+    duration = arg_dbl0("d","duration","seconds","duration of synthetic audio signal (default 20)"),
+    mintime = arg_dbl0("t","time","seconds","minimum measured time per benchmark (default 0.2)"),
+    datablock = arg_int0("s",NULL, "datablocksize", "prefered data block size"),
+    blockbytes = arg_int0(NULL,"block-bytes","bytes","target size of data blocks in bytes"),
+    json = arg_file0("j","json","file","write results to JSON file"),
+    compare = arg_file0(NULL,"compare","file","compare with results of a previous run (JSON file)"),
+    threshold = arg_dbl0(NULL,"threshold","percent","slowdown reported as regression (default 10)"),
+    nbthreads = arg_int0(NULL,"threads","N","instead of benchmarking, check that N engines running concurrently give the single thread results"),
+    names = arg_strn(NULL,NULL,"COMPONENT",0,argc,"components to benchmark (default all)"),
+    end_ = arg_end(20) };
+
+  int nerrors = arg_parse(argc, argv, argtable);
+  double durationSec = 20.0;
+  double minTimeSec = 0.2;
+  double thresholdPct = 10.0;
+  vector<BenchResult> componentResults;
+  vector<BenchResult> dataflowResults;
+  vector<BenchResult> featureplanResults;
+
+  if (h->count > 0)
+  {
+    printf("%s benchmarks yaafe components and dataflows\n", progname);
+    printf("\n");
+    printf("Usage: %s", progname);
+    arg_print_syntax(stdout,argtable,"\n");
+    arg_print_glossary(stdout,argtable, " %-25s %s\n");
+    goto exit;
+  }
+
+  if (nerrors > 0)
+  {
+    arg_print_errors(stdout,end_, progname);
+    printf("Try '%s --help' for more information.\n", progname);
+    exitcode = 1;
+    goto exit;
+  }
+
+  if (duration->count)
+    durationSec = duration->dval[0];
+  if (mintime->count)
+    minTimeSec = mintime->dval[0];
+  if (threshold->count)
+    thresholdPct = threshold->dval[0];
+  if (datablock->count)
+    DataBlock::setPreferedBlockSize(datablock->ival[0]);
+  if (blockbytes->count)
+    DataBlock::setBlockBytes(blockbytes->ival[0]);
+  if (nbthreads->count && nbthreads->ival[0]<1)
+  {
+    cerr << "ERROR: invalid number of threads " << nbthreads->ival[0] << endl;
+    exitcode = 1;
+    goto exit;
+  }
+#ifndef WITH_THREADS
+  if (nbthreads->count)
+  {
+    cerr << "ERROR: --threads is not available, yaafe was built without WITH_THREADS" << endl;
+    exitcode = 1;
+    goto exit;
+  }
+#endif
+
+  exitcode = ComponentFactory::instance()->loadLibrary("yaafe-components");
+  if (exitcode)
+    goto exit;
+  for (int i=0;i<libs->count;i++)
+  {
+    exitcode = ComponentFactory::instance()->loadLibrary(libs->sval[i]);
+    if (exitcode)
+      goto exit;
+  }
+
+  if (!nocomponents->count)
+  {
+    vector<string> components;
+    const vector<const Component*>& cList = ComponentFactory::instance()->getPrototypeList();
+    for (size_t i=0;i<cList.size();i++)
+      components.push_back(cList[i]->getIdentifier());
+    sort(components.begin(),components.end());
+    for (size_t i=0;i<components.size();i++)
+    {
+      if (names->count) {
+        bool selected = false;
+        for (int n=0;n<names->count;n++)
+          if (components[i]==names->sval[n])
+            selected = true;
+        if (!selected)
+          continue;
+      }
+      const BenchCase* bc = &s_defaultCase;
+      for (const BenchCase* c=s_cases; c->component!=NULL; c++)
+        if (components[i]==c->component)
+          bc = c;
+      if (nbthreads->count) {
+        DataFlow df;
+        buildCaseDataFlow(df,*bc,components[i]);
+        string status = checkThreads(df,nbthreads->ival[0],durationSec);
+        printThreadsResult(components[i],nbthreads->ival[0],status);
+        if (status=="MISMATCH" || status=="failed")
+          exitcode = 3;
+        continue;
+      }
+      BenchResult r = benchComponent(components[i],*bc,durationSec,minTimeSec);
+      printResult(r);
+      componentResults.push_back(r);
+    }
+  }
+
+  for (int i=0;i<dataflows->count+featureplans->count;i++)
+  {
+    // dataflow files first, then feature plans compiled at the benchmark
+    // sample rate
+    const bool isPlan = (i>=dataflows->count);
+    const string filename = isPlan ? featureplans->filename[i-dataflows->count]
+        : dataflows->filename[i];
+    DataFlow fileFlow;
+    FeaturePlan plan(BENCH_SAMPLERATE);
+    const DataFlow& df = isPlan ? plan.getDataFlow() : fileFlow;
+    const bool loaded = isPlan ? plan.loadFeaturePlan(filename) : fileFlow.load(filename);
+    if (nbthreads->count) {
+      string status = loaded ? checkThreads(df,nbthreads->ival[0],durationSec) : "failed";
+      printThreadsResult(filename,nbthreads->ival[0],status);
+      if (status!="ok")
+        exitcode = 3;
+      continue;
+    }
+    const char* description = isPlan ? "featureplan" : "dataflow";
+    BenchResult r = loaded ? benchDataFlow(filename,description,df,durationSec,minTimeSec)
+        : emptyResult(filename,description);
+    if (!loaded)
+      r.status = "failed";
+    printResult(r);
+    (isPlan ? featureplanResults : dataflowResults).push_back(r);
+  }
+  if (nbthreads->count)
+    goto exit;
+
+  if (json->count && !saveJSON(json->filename[0],componentResults,dataflowResults,featureplanResults))
+    exitcode = -1;
+
+  if (compare->count)
+  {
+    map<string,double> previous;
+    if (!loadJSON(compare->filename[0],previous)) {
+      exitcode = -1;
+      goto exit;
+    }
+    printf("\nComparison with %s:\n", compare->filename[0]);
+    int regressions = compareResults(previous,componentResults,thresholdPct)
+        + compareResults(previous,dataflowResults,thresholdPct)
+        + compareResults(previous,featureplanResults,thresholdPct);
+    if (regressions>0) {
+      printf("%i benchmarks are more than %g%% slower\n", regressions, thresholdPct);
+      exitcode = 2;
+    }
+  }
+
+exit:
+  ComponentFactory::destroy();
+  arg_freetable(argtable, sizeof(argtable) / sizeof(argtable[0]));
+
+  return exitcode;
+}
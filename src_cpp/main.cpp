@@ -31,6 +31,7 @@
 #include "yaafe-core/OutputFormat.h"
 #include "yaafe-core/Engine.h"
 #include "yaafe-core/ComponentFactory.h"
+#include "yaafe-core/FeaturePlan.h"
 
 using namespace YAAFE;
 using namespace std;
@@ -88,10 +89,11 @@ void printOutputFormats()
   }
 }
 
-struct arg_lit *h, *version, *verbose, *l;
-struct arg_str *d, *libs, *outdir, *format, *formatparams;
-struct arg_file *files, *dataflow;
-struct arg_int *datablock;
+struct arg_lit *h, *version, *verbose, *l, *floatPrec, *noFusion, *resample, *normalize;
+struct arg_str *d, *libs, *outdir, *format, *formatparams, *features, *resamplequality;
+struct arg_file *files, *dataflow, *featureplan, *dumpdataflow, *profile, *trace;
+struct arg_int *datablock, *blockbytes, *rate, *readahead;
+struct arg_dbl *normalizemax;
 struct arg_end *end_;
 
 int main(int argc, char **argv)
@@ -106,12 +108,26 @@ int main(int argc, char **argv)
     verbose = arg_lit0(NULL, "verbose", "more logs"),
     l = arg_lit0("l", NULL, "list all available components"),
     d = arg_str0("d","describe","component", "Describe a component, show its parameters"),
-    datablock = arg_int0("s",NULL, "datablocksize", "prefered data block size"),
+    datablock = arg_int0("s",NULL, "datablocksize", "prefered data block size (number of values)"),
+    blockbytes = arg_int0(NULL,"block-bytes","bytes","target size of data blocks in bytes (default 32768)"),
+    floatPrec = arg_lit0(NULL, "float", "use single precision kernels in components supporting them"),
+    noFusion = arg_lit0(NULL, "no-fusion", "do not compute spectral descriptors sharing the same input in a single step"),
     libs = arg_strn("x","loadlibrary","libnames",0,10,"yaafe component library name to load."),
     dataflow = arg_file0("c",NULL,"file","dataflow to process"),
+    features = arg_strn("f","feature","featuredefinition",0,argc,"feature to extract, instead of a dataflow file"),
+    featureplan = arg_file0(NULL,"feature-plan","file","feature extraction plan, instead of a dataflow file"),
+    rate = arg_int0("r","rate","samplerate","analysis sample rate in Hz, for features given with -f or --feature-plan"),
+    resample = arg_lit0(NULL,"resample","resample input signal to the analysis sample rate"),
+    resamplequality = arg_str0(NULL,"resample-quality","high|medium|fast","resampling filter quality, lower quality is faster (default high)"),
+    normalize = arg_lit0("n","normalize","normalize input signal by removing mean and scale maximum absolute value to 0.98 (or other value given with --normalize-max)"),
+    normalizemax = arg_dbl0(NULL,"normalize-max","value","maximum absolute value of normalized input signal"),
+    dumpdataflow = arg_file0(NULL,"dump-dataflow","file","write the dataflow to process to file"),
     format = arg_str0("o", NULL,"format","output format, see available output formats below."),
     formatparams = arg_strn("p", NULL,"key=value",0,10,"output format parameters (see below)"),
     outdir = arg_str0("b", NULL,"dir","output base directory"),
+    profile = arg_file0(NULL, "profile","file","write per-component profiling statistics (JSON) to file"),
+    trace = arg_file0(NULL, "trace","file","write a trace of component calls (Chrome trace event format) to file"),
+    readahead = arg_int0(NULL, "read-ahead","blocks","decode audio this number of blocks in advance in a background thread, and open next file while processing current one"),
     files = arg_filen(NULL,NULL,"FILES",0,argc,"audio files to process"),
     end_ = arg_end(20) };
 
@@ -159,6 +175,8 @@ int main(int argc, char **argv)
 
   if (datablock->count)
     DataBlock::setPreferedBlockSize(datablock->ival[0]);
+  if (blockbytes->count)
+    DataBlock::setBlockBytes(blockbytes->ival[0]);
 
   // register io components
   exitcode = ComponentFactory::instance()->loadLibrary("yaafe-io");
@@ -185,24 +203,58 @@ int main(int argc, char **argv)
   }
 
 
-  if (files->count)
+  if (files->count || dumpdataflow->count)
   {
-    if (!dataflow->count) {
-      cerr << "ERROR: please specify a dataflow file with -c option !" << endl;
-      exitcode = -1; goto exit;
+    DataFlow fileFlow;
+    FeaturePlan plan(rate->count ? rate->ival[0] : 0,
+        normalize->count ? (normalizemax->count ? normalizemax->dval[0] : 0.98) : -1,
+        resample->count>0);
+    DataFlow* df = &fileFlow;
+    if (features->count || featureplan->count) {
+      // compile features into a dataflow
+      if (dataflow->count) {
+        cerr << "ERROR: cannot use -c option together with -f or --feature-plan options !" << endl;
+        exitcode = -1; goto exit;
+      }
+      if (!rate->count) {
+        cerr << "ERROR: please specify sample rate with -r option !" << endl;
+        exitcode = -1; goto exit;
+      }
+      if (featureplan->count && !plan.loadFeaturePlan(featureplan->filename[0])) {
+        exitcode = -1; goto exit;
+      }
+      for (int i=0;i<features->count;i++)
+      {
+        if (!plan.addFeature(features->sval[i])) {
+          exitcode = -1; goto exit;
+        }
+      }
+      df = &plan.getDataFlow();
+    } else {
+      if (!dataflow->count) {
+        cerr << "ERROR: please specify a dataflow file with -c option, or features with -f or --feature-plan options !" << endl;
+        exitcode = -1; goto exit;
+      }
+      if (!fileFlow.load(dataflow->filename[0])) {
+        cerr << "ERROR: cannot load dataflow from file " << dataflow->filename[0] << endl;
+        exitcode = -1; goto exit;
+      }
     }
 
-    DataFlow df;
-    if (!df.load(dataflow->filename[0])) {
-      cerr << "ERROR: cannot load dataflow from file " << dataflow->filename[0] << endl;
-      exitcode = -1; goto exit;
-    }
+    if (dumpdataflow->count)
+      df->save(dumpdataflow->filename[0]);
+    if (!files->count)
+      goto exit;
 
     Engine engine;
-    if (!engine.load(df)) {
+    engine.setFloatPrecision(floatPrec->count>0);
+    engine.setFusion(noFusion->count==0);
+    if (!engine.load(*df)) {
       cerr << "ERROR: cannot initialize dataflow engine" << endl;
       exitcode = -1; goto exit;
     }
+    if (profile->count || trace->count)
+      engine.enableProfiling(trace->count>0);
 
     AudioFileProcessor processor;
     {
@@ -226,14 +278,24 @@ int main(int argc, char **argv)
         exitcode = -1; goto exit;
       }
     }
+    if (readahead->count)
+      processor.setReadAhead(readahead->ival[0]);
+    if (resamplequality->count)
+      processor.setResampleQuality(resamplequality->sval[0]);
 
     for (int i=0;i<files->count; i++)
     {
-      int res = processor.processFile(engine, files->filename[i]);
+      int res = processor.processFile(engine, files->filename[i],
+          (i+1<files->count) ? files->filename[i+1] : "");
       if (res!=0) {
         cerr << "ERROR: error while processing " << files->filename[i] << endl;
       }
     }
+
+    if (profile->count && !engine.getProfiler()->saveJSON(profile->filename[0]))
+      exitcode = -1;
+    if (trace->count && !engine.getProfiler()->saveTrace(trace->filename[0]))
+      exitcode = -1;
   }
 
 #ifdef WITH_TIMERS
@@ -36,7 +36,7 @@ using namespace Eigen;
 namespace YAAFE
 {
 
-  Abs::Abs()
+  Abs::Abs() : m_float(false)
   {
   }
 
@@ -44,8 +44,16 @@ namespace YAAFE
   {
   }
 
+  ParameterDescriptorList Abs::getParameterDescriptorList() const
+  {
+    ParameterDescriptorList pList;
+    pList.push_back(kernelPrecisionParameter());
+    return pList;
+  }
+
   StreamInfo Abs::init(const ParameterMap& params, const StreamInfo& in)
   {
+    m_float = useFloatKernel(params);
     if (in.size%2 != 0)
     {
       cerr << "ERROR: Abs input size should be even" << endl;
@@ -54,10 +62,11 @@ namespace YAAFE
     return StreamInfo(in, in.size/2);
   }
 
-  inline double nonZeroNorm(double r, double i)
+  template<class T>
+  inline T nonZeroNorm(T r, T i)
   {
-    double n = std::sqrt(r*r + i*i);
-    return n ? n : EPS;
+    T n = std::sqrt(r*r + i*i);
+    return n ? n : (T) EPS;
   }
 
   void Abs::processToken(double* inData, const int inSize, double* outData, const int outSize)
@@ -66,4 +75,36 @@ namespace YAAFE
       outData[i] = nonZeroNorm(inData[2*i],inData[2*i+1]);
   }
 
+  // norms computed in the precision of the input
+  template<class I, class O>
+  static void absTokens(InputBuffer* in, OutputBuffer* out)
+  {
+    const int P = out->info().size;
+    while (!in->empty()) {
+      const I* inData = in->readToken<I>();
+      O* outData = out->writeToken<O>();
+      for (int i=0;i<P;++i)
+        outData[i] = nonZeroNorm(inData[2*i],inData[2*i+1]);
+      in->consumeToken();
+    }
+  }
+
+  bool Abs::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  {
+    InputBuffer* in = inp[0].data;
+    OutputBuffer* out = outp[0].data;
+    const bool floatIn = (in->sampleType()==FLOAT_SAMPLES);
+    const bool floatOut = (out->sampleType()==FLOAT_SAMPLES);
+    if (!floatIn && !floatOut)
+      return StateLessOneInOneOutComponent<Abs>::process(inp,outp);
+    if (in->empty()) return false;
+    if (floatIn && floatOut)
+      absTokens<float,float>(in,out);
+    else if (floatIn)
+      absTokens<float,double>(in,out);
+    else
+      absTokens<double,float>(in,out);
+    return true;
+  }
+
 }
@@ -40,8 +40,17 @@ namespace YAAFE
 
      const std::string getIdentifier() const  { return ABS_ID; }
 
+     virtual ParameterDescriptorList getParameterDescriptorList() const;
+
      StreamInfo init(const ParameterMap& params,const StreamInfo& in);
      void processToken(double* inData, const int inSize, double* out, const int outSize);
+     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+
+     virtual bool canReadFloat(int port) const { return m_float; }
+     virtual bool canWriteFloat(int port) const { return m_float; }
+
+   private:
+     bool m_float;
   };
 
 }
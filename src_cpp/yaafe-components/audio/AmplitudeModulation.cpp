@@ -26,7 +26,11 @@
 
 #include "MathUtils.h"
 #include <Eigen/Dense>
+#ifdef WITH_FFTW3
+#include <fftw3.h>
+#else
 #include <unsupported/Eigen/FFT>
+#endif
 
 #define TREM_FREQ 0
 #define TREM_STREN 1
@@ -42,6 +46,9 @@
 #define GRAIN_HZ_START 10.0
 #define GRAIN_HZ_END 40.0
 
+// number of envelope tokens transformed at once
+#define AM_BATCH_TOKENS 8
+
 using namespace std;
 using namespace Eigen;
 
@@ -52,34 +59,145 @@ namespace YAAFE
   {
    public:
      ComputingContext(const StreamInfo& in, int decim);
-     virtual ~ComputingContext() {};
+     virtual ~ComputingContext();
+
+     void transform(int nbTokens);
+     void computeFeatures(int t, double* values);
 
      int m_blockSize;
      int m_decim;
      int m_ncx;
+     int m_nbBins;
      int m_tremStart;
      int m_tremSize;
      int m_granStart;
      int m_granSize;
+     double m_sampleRate;
      VectorXd m_envHanning;
-     VectorXd m_ek;
+     // one zero-padded windowed envelope per column
+     MatrixXd m_fftInput;
+     MatrixXcd m_fftOutput;
+#ifdef WITH_FFTW3
+     fftw_plan m_fftPlan; // transforms a whole batch
+     fftw_plan m_fftTokenPlan; // transforms any single column
+#else
      FFT<double> m_fftPlan;
+#endif
   };
 
   AmplitudeModulation::ComputingContext::ComputingContext(const StreamInfo& in, int decim) :
-    m_blockSize(in.frameLength), m_decim(decim), m_ek(in.frameLength/2), m_fftPlan()
+    m_blockSize(in.frameLength), m_decim(decim), m_fftPlan()
   {
     m_ncx = in.frameLength / decim + 1;
+    m_nbBins = in.frameLength / 2;
     // compute band boundaries
     m_tremStart = (int) ceil(TREM_HZ_START * (in.frameLength) * decim / in.sampleRate) - 1;
     m_tremSize = (int) ceil(TREM_HZ_END * (in.frameLength) * decim / in.sampleRate) - m_tremStart;
     m_granStart = (int) ceil(GRAIN_HZ_START * (in.frameLength) * decim / in.sampleRate) - 1;
     m_granSize = (int) ceil(GRAIN_HZ_END * (in.frameLength) * decim / in.sampleRate) - m_granStart;
+    m_sampleRate = in.sampleRate;
 
     // compute hanning window for enveloppe
     m_envHanning = ehanning(m_ncx);
 
+    m_fftInput.resize(m_blockSize,AM_BATCH_TOKENS);
+    m_fftOutput.resize(m_blockSize/2+1,AM_BATCH_TOKENS);
+#ifdef WITH_FFTW3
+    int n = m_blockSize;
+    {
+      MutexLock lock(fftwPlannerMutex);
+      m_fftPlan = fftw_plan_many_dft_r2c(1, &n, AM_BATCH_TOKENS,
+          m_fftInput.data(), NULL, 1, m_fftInput.rows(),
+          (fftw_complex*) m_fftOutput.data(), NULL, 1, m_fftOutput.rows(),
+          FFTW_MEASURE);
+      // columns other than the first may not be SIMD aligned
+      m_fftTokenPlan = fftw_plan_dft_r2c_1d(n, m_fftInput.data(),
+          (fftw_complex*) m_fftOutput.data(), FFTW_MEASURE | FFTW_UNALIGNED);
+    }
+#else
     m_fftPlan.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+#endif
+    // padding is never written, zero it once
+    m_fftInput.setZero();
+  }
+
+  AmplitudeModulation::ComputingContext::~ComputingContext()
+  {
+#ifdef WITH_FFTW3
+    MutexLock lock(fftwPlannerMutex);
+    fftw_destroy_plan(m_fftPlan);
+    fftw_destroy_plan(m_fftTokenPlan);
+#endif
+  }
+
+  void AmplitudeModulation::ComputingContext::transform(int nbTokens)
+  {
+#ifdef WITH_FFTW3
+    if (nbTokens==AM_BATCH_TOKENS)
+    {
+      fftw_execute(m_fftPlan);
+      return;
+    }
+    // incomplete batch, do not transform unused columns
+    for (int t=0;t<nbTokens;t++)
+      fftw_execute_dft_r2c(m_fftTokenPlan,m_fftInput.col(t).data(),
+          (fftw_complex*) m_fftOutput.col(t).data());
+#else
+    for (int t=0;t<nbTokens;t++)
+      m_fftPlan.fwd(m_fftOutput.col(t).data(),m_fftInput.col(t).data(),m_blockSize);
+#endif
+  }
+
+  void AmplitudeModulation::ComputingContext::computeFeatures(int t, double* values)
+  {
+    // single pass on ek = |fft|: whole spectrum sum, and max and sum of
+    // tremolo and grain bands
+    const complex<double>* spec = m_fftOutput.col(t).data();
+    const int tremEnd = m_tremStart + m_tremSize;
+    const int granEnd = m_granStart + m_granSize;
+    double sum = 0.0;
+    double tremSum = 0.0;
+    double tremMax = -1.0;
+    int tremIndex = m_tremStart;
+    double granSum = 0.0;
+    double granMax = -1.0;
+    int granIndex = m_granStart;
+    for (int k=0;k<m_nbBins;k++)
+    {
+      const double ek = abs(spec[k]);
+      sum += ek;
+      if (k>=m_tremStart && k<tremEnd)
+      {
+        tremSum += ek;
+        if (ek>tremMax)
+        {
+          tremMax = ek;
+          tremIndex = k;
+        }
+      }
+      if (k>=m_granStart && k<granEnd)
+      {
+        granSum += ek;
+        if (ek>granMax)
+        {
+          granMax = ek;
+          granIndex = k;
+        }
+      }
+    }
+    const double mean_ek = sum / m_nbBins;
+
+    // tremolo features
+    values[TREM_FREQ] = tremIndex * m_sampleRate / (m_blockSize * m_decim);
+    values[TREM_STREN] = max(tremMax - mean_ek, 0.0);
+    values[TREM_STREN_HEUR] = max(tremMax - tremSum / m_tremSize, 0.0);
+    values[TREM_PROD] = values[TREM_FREQ] * values[TREM_STREN];
+
+    // grain features
+    values[GRAN_FREQ] = (double) granIndex * m_sampleRate / (m_blockSize * m_decim);
+    values[GRAN_STREN] = max(granMax - mean_ek, 0.0);
+    values[GRAN_STREN_HEUR] = max(granMax - granSum / m_granSize, 0.0);
+    values[GRAN_PROD] = values[GRAN_FREQ] * values[GRAN_STREN];
   }
 
   AmplitudeModulation::AmplitudeModulation() :
@@ -127,56 +245,22 @@ namespace YAAFE
     OutputBuffer* out = outp[0].data;
 
     assert(in->info().size==m_context->m_ncx);
-    VectorXd fftinput(in->info().frameLength);
-    VectorXcd fftoutput(in->info().frameLength/2+1);
-    for (;!in->empty();in->consumeToken())
+    const int ncx = m_context->m_ncx;
+    while (!in->empty())
     {
-      double* values = out->writeToken();
-
-      // compute ek
-      Map<VectorXd> env(in->readToken(),in->info().size);
-
-      fftinput.segment(0,m_context->m_ncx) = env.array() * m_context->m_envHanning.array();
-      fftinput.segment(m_context->m_ncx,fftinput.size()-m_context->m_ncx).setZero();
-      m_context->m_fftPlan.fwd(fftoutput,fftinput);
-      m_context->m_ek = fftoutput.segment(0, m_context->m_ek.size()).array().abs();
-      double mean_ek = m_context->m_ek.mean();
-
-      // compute tremolo features on ek
+      // window a batch of envelope tokens
+      const int nbTokens = min(in->blockAvailableTokens(),AM_BATCH_TOKENS);
+      for (int t=0;t<nbTokens;t++)
       {
-        VectorXd::Index index;
-        m_context->m_ek.segment(m_context->m_tremStart,m_context->m_tremSize).maxCoeff(&index);
-        index += m_context->m_tremStart;
-        double max = m_context->m_ek(index);
-        values[TREM_FREQ] = index * in->info().sampleRate / (in->info().frameLength
-            * m_context->m_decim);
-        values[TREM_STREN] = max - mean_ek;
-        if (values[TREM_STREN] < 0)
-          values[TREM_STREN] = 0.0;
-        values[TREM_STREN_HEUR] = max - m_context->m_ek.segment(m_context->m_tremStart,m_context->m_tremSize).mean();
-        if (values[TREM_STREN_HEUR] < 0)
-          values[TREM_STREN_HEUR] = 0.0;
-        values[TREM_PROD] = values[TREM_FREQ]
-          * values[TREM_STREN];
+        Map<ArrayXd> env(in->blockToken(t),ncx);
+        m_context->m_fftInput.col(t).head(ncx) = env * m_context->m_envHanning.array();
       }
+      in->consumeTokens(nbTokens);
 
-      // compute grain features on ek
-      {
-        VectorXd::Index index;
-        m_context->m_ek.segment(m_context->m_granStart,m_context->m_granSize).maxCoeff(&index);
-        index += m_context->m_granStart;
-        double max = m_context->m_ek(index);
-        values[GRAN_FREQ] = (double) index * in->info().sampleRate / (in->info().frameLength
-            * m_context->m_decim);
-        values[GRAN_STREN] = max - mean_ek;
-        if (values[GRAN_STREN] < 0)
-          values[GRAN_STREN] = 0.0;
-        values[GRAN_STREN_HEUR] = max - m_context->m_ek.segment(m_context->m_granStart,m_context->m_granSize).mean();
-        if (values[GRAN_STREN_HEUR] < 0)
-          values[GRAN_STREN_HEUR] = 0.0;
-        values[GRAN_PROD] = values[GRAN_FREQ]
-          * values[GRAN_STREN];
-      }
+      m_context->transform(nbTokens);
+
+      for (int t=0;t<nbTokens;t++)
+        m_context->computeFeatures(t,out->writeToken());
     }
     return true;
   }
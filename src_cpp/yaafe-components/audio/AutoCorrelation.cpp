@@ -30,7 +30,7 @@ using namespace std;
 namespace YAAFE
 {
 
-  AutoCorrelation::AutoCorrelation()
+  AutoCorrelation::AutoCorrelation() : m_float(false)
   {
   }
 
@@ -46,24 +46,27 @@ namespace YAAFE
     p.m_description = "Number of autocorrelation coefficients to keep";
     p.m_defaultValue = "49";
     pList.push_back(p);
+    pList.push_back(kernelPrecisionParameter());
     return pList;
   }
 
   StreamInfo AutoCorrelation::init(const ParameterMap& params, const StreamInfo& in)
   {
+    m_float = useFloatKernel(params);
     return StreamInfo(in, getIntParam("ACNbCoeffs",params));
   }
 
-  void AutoCorrelation::processToken(double* inPtr, const int inSize, double* outPtr, const int outSize)
+  template<typename T>
+  static void autocorrelation(const T* inPtr, const int inSize, double* outPtr, const int outSize)
   {
     // compute several lags at same time improve cache management and increase speed
     const int lMax = outSize;
     int l=0;
     for (double* rout=outPtr;l<lMax-4;l+=4,rout+=4)
     {
-      double *rin1=inPtr;
-      double *rin2=&inPtr[l];
-      double lv[4] = {0,0,0,0};
+      const T* rin1=inPtr;
+      const T* rin2=&inPtr[l];
+      T lv[4] = {0,0,0,0};
       int i = 0;
       for (;i<inSize-l-4;i+=4,rin1+=4,rin2+=4)
       {
@@ -83,11 +86,20 @@ namespace YAAFE
     // compute last lags
     for (;l<lMax;l++)
     {
-      double l0 = 0;
+      T l0 = 0;
       for (int i=0;i<inSize-l;i++)
         l0 += inPtr[i]*inPtr[i+l];
       outPtr[l] = l0;
     }
   }
 
+  void AutoCorrelation::processToken(double* inPtr, const int inSize, double* outPtr, const int outSize)
+  {
+    if (m_float) {
+      m_floatData.assign(inPtr,inPtr+inSize);
+      autocorrelation(&m_floatData[0],inSize,outPtr,outSize);
+    } else
+      autocorrelation(inPtr,inSize,outPtr,outSize);
+  }
+
 }
@@ -26,6 +26,7 @@
 #define AUTOCORRELATION_H_
 
 #include "yaafe-core/ComponentHelpers.h"
+#include <vector>
 
 #define AUTOCORRELATION_ID "AutoCorrelation"
 
@@ -44,6 +45,9 @@ namespace YAAFE
      StreamInfo init(const ParameterMap& params, const StreamInfo& in);
      void processToken(double* inData, const int inSize, double* outData, const int outSize);
 
+   private:
+     bool m_float;
+     std::vector<float> m_floatData;
   };
 
 }
@@ -33,7 +33,7 @@ using namespace std;
 namespace YAAFE
 {
 
-  AutoCorrelationPeaksIntegrator::AutoCorrelationPeaksIntegrator() : m_nbFrames(0)
+  AutoCorrelationPeaksIntegrator::AutoCorrelationPeaksIntegrator()
   {
   }
 
@@ -76,22 +76,8 @@ namespace YAAFE
   }
 
 
-  bool AutoCorrelationPeaksIntegrator::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  bool AutoCorrelationPeaksIntegrator::initIntegrator(const ParameterMap& params, const StreamInfo& in, StreamInfo& out)
   {
-    assert(inp.size()==1);
-    const StreamInfo& in = inp[0].data;
-
-    m_nbFrames = getIntParam("NbFrames",params);
-    if (m_nbFrames<=0) {
-      cerr << "ERROR: Invalid NbFrames parameter !" << endl;
-      return false;
-    }
-    m_stepNbFrames = getIntParam("StepNbFrames",params);
-    if (m_stepNbFrames<=0) {
-      cerr << "ERROR: Invalid stepNbFrames parameter !" << endl;
-      return false;
-    }
-
     m_nbPeaks = getIntParam("ACPNbPeaks",params);
     m_interPeakMinDist = getIntParam("ACPInterPeakMinDist",params);
     m_normFactor = 0;
@@ -99,63 +85,38 @@ namespace YAAFE
       m_normFactor = 60;
     else if (getStringParam("ACPNorm",params)=="Hz")
       m_normFactor = 1;
+    m_norm = m_normFactor * in.sampleRate / (double)in.sampleStep;
+    m_corr.resize(m_nbFrames);
 
-    StreamInfo out;
     out.size = 2*m_nbPeaks*in.size;
-    out.sampleRate = in.sampleRate;
-    out.sampleStep = m_stepNbFrames * in.sampleStep;
-    out.frameLength = in.frameLength + (m_nbFrames-1) * in.sampleStep;
-    outStreamInfo().add(out);
-
     return true;
   }
 
-  bool AutoCorrelationPeaksIntegrator::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  void AutoCorrelationPeaksIntegrator::emit(const double* window, double* outPtr)
   {
-    assert(inp.size()==1);
-    InputBuffer* in = inp[0].data;
-    assert(outp.size()==1);
-    OutputBuffer* out = outp[0].data;
-
-    if ((out->tokenno()==0) && (in->tokenno()!=-m_nbFrames/2))
-      in->prependZeros(m_nbFrames/2);
-    if (!in->hasTokens(m_nbFrames)) return false;
-
-    while (in->hasTokens(m_nbFrames))
+    for (int i = 0; i < m_size; i++)
     {
-      ArrayXXd inData(in->info().size,m_nbFrames);
-      in->read(inData.data(),m_nbFrames);
-      double* outPtr = out->writeToken();
-
-      for (int i = 0; i < in->info().size; i++)
-      {
-        findAutocorrPeaks(inData.data() + i,m_nbFrames,in->info().size,outPtr + (2*m_nbPeaks*i));
-      }
+      findAutocorrPeaks(window + i,m_nbFrames,m_size,outPtr + (2*m_nbPeaks*i));
+    }
 
-      if (m_normFactor)
-      {
-        // normalize indices
-        //            DVec outIndices(outPtr,in->info().size*m_nbPeaks,2);
-        //            outIndices = where(outIndices>0,(m_normFactor * in->info().sampleRate / (double)in->info().sampleStep) / outIndices,0);
-        double norm = m_normFactor * in->info().sampleRate / (double)in->info().sampleStep;
-        for (int i=0;i<in->info().size*m_nbPeaks;i++)
-          outPtr[2*i] = (outPtr[2*i]>0) ? norm / outPtr[2*i] : 0;
-      }
-      in->consumeTokens(m_stepNbFrames);
+    if (m_normFactor)
+    {
+      // normalize indices
+      for (int i=0;i<m_size*m_nbPeaks;i++)
+        outPtr[2*i] = (outPtr[2*i]>0) ? m_norm / outPtr[2*i] : 0;
     }
-    return true;
   }
 
-  void AutoCorrelationPeaksIntegrator::findAutocorrPeaks(double* data, int len, int stride, double* out)
+  void AutoCorrelationPeaksIntegrator::findAutocorrPeaks(const double* data, int len, int stride, double* out)
   {
-    Map<ArrayXd> inData(data,len,stride);
+    Map<const ArrayXd,0,InnerStride<> > inData(data,len,InnerStride<>(stride));
 
     // set out to 0
     for (int i=0;i<2*m_nbPeaks;i++)
       out[i] = 0.0;
 
     // compute autocorr
-    ArrayXd corr(len);
+    ArrayXd& corr = m_corr;
     for (int j=0;j<len;j++)
       corr(j) = (inData.segment(0,len-j) * inData.segment(j,len-j)).sum();
     corr /= corr(0);
@@ -221,11 +182,4 @@ namespace YAAFE
 
   }
 
-  void AutoCorrelationPeaksIntegrator::flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out)
-  {
-    in[0].data->appendZeros((m_nbFrames-1)/2);
-    process(in,out);
-  }
-
-
 }
@@ -25,14 +25,15 @@
 #ifndef AUTOCORRELATIONPEAKSINTEGRATOR_H_
 #define AUTOCORRELATIONPEAKSINTEGRATOR_H_
 
-#include "yaafe-core/Component.h"
+#include "yaafe-core/ComponentHelpers.h"
+#include <Eigen/Dense>
 
 #define AUTOCORRELATIONPEAKSINTEGRATOR_ID "AutoCorrelationPeaksIntegrator"
 
 namespace YAAFE
 {
 
-  class AutoCorrelationPeaksIntegrator: public YAAFE::ComponentBase<AutoCorrelationPeaksIntegrator>
+  class AutoCorrelationPeaksIntegrator: public YAAFE::WindowedIntegrator<AutoCorrelationPeaksIntegrator>
   {
    public:
      AutoCorrelationPeaksIntegrator();
@@ -42,18 +43,19 @@ namespace YAAFE
 
      virtual ParameterDescriptorList getParameterDescriptorList() const;
 
-     virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
-     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
-     virtual void flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+     void emit(const double* window, double* out);
+
+   protected:
+     virtual bool initIntegrator(const ParameterMap& params, const StreamInfo& in, StreamInfo& out);
 
    private:
-     int m_nbFrames;
-     int m_stepNbFrames;
      int m_nbPeaks;
      int m_interPeakMinDist;
      double m_normFactor;
+     double m_norm;
+     Eigen::ArrayXd m_corr;
 
-     void findAutocorrPeaks(double* data, int len, int stride, double* out);
+     void findAutocorrPeaks(const double* data, int len, int stride, double* out);
 
   };
 
@@ -10,6 +10,10 @@
 #include <algorithm>
 #include <unsupported/Eigen/FFT>
 #include <math.h>
+#include <string.h>
+
+// change when kernel computation or layout change
+#define CQT_KERNEL_VERSION 1
 
 using namespace std;
 using namespace YAAFE;
@@ -82,7 +86,24 @@ StreamInfo CQT::init(const ParameterMap& params, const StreamInfo& in)
         return StreamInfo();
     }
 
+	Kernel* kern = new Kernel();
+	m_kernel.reset(kern);
+	string cacheKey;
+	if (!KernelCache::directory().empty())
+	{
+		cacheKey = KernelCache::key(*this,params,in,CQT_KERNEL_VERSION);
+		if (kern->load(KernelCache::load(cacheKey),nbCoeffs,m_fftLen))
+			return StreamInfo(in,nbCoeffs);
+	}
+
+	std::vector<ArrayXcd> posFilters;
+	std::vector<ArrayXcd> negFilters;
 	double thres = 0.0075;
+#ifdef WITH_FFTW3
+	// Eigen's FFTW backend plans on first use and destroys the plan with
+	// fftPlan, keep the planner locked for the lifetime of fftPlan
+	MutexLock fftLock(fftwPlannerMutex);
+#endif
 	FFT<double> fftPlan;
 	VectorXcd tempKernel(m_fftLen);
 	VectorXcd specKernel(m_fftLen);
@@ -139,12 +160,12 @@ StreamInfo CQT::init(const ParameterMap& params, const StreamInfo& in)
             int last = posFreqs.size() - 1;
             while (abs(posFreqs(last))==0 && last>first)
                 last--;
-            m_kernPosStart.push_back(first);
-            m_kernPosFilters.push_back(VectorXcd(last-first+1));
-            m_kernPosFilters.back() = posFreqs.segment(first,last-first+1);
+            kern->posStart.push_back(first);
+            posFilters.push_back(VectorXcd(last-first+1));
+            posFilters.back() = posFreqs.segment(first,last-first+1);
 		} else {
-		    m_kernPosFilters.push_back(VectorXcd());
-		    m_kernPosStart.push_back(-1);
+		    posFilters.push_back(VectorXcd());
+		    kern->posStart.push_back(-1);
 		}
 		// sparsify neg
 		first = 0;
@@ -155,33 +176,131 @@ StreamInfo CQT::init(const ParameterMap& params, const StreamInfo& in)
             int last = negFreqs.size() - 1;
             while (abs(negFreqs(last))==0 && last>first)
                 last--;
-            m_kernNegStart.push_back(first);
-            m_kernNegFilters.push_back(VectorXcd(last - first+1));
-            m_kernNegFilters.back() = negFreqs.segment(first,last-first+1);
+            kern->negStart.push_back(first);
+            negFilters.push_back(VectorXcd(last - first+1));
+            negFilters.back() = negFreqs.segment(first,last-first+1);
         } else {
-            m_kernNegFilters.push_back(VectorXcd());
-            m_kernNegStart.push_back(-1);
+            negFilters.push_back(VectorXcd());
+            kern->negStart.push_back(-1);
         }
 	}
 
-	reverse(m_kernPosFilters.begin(), m_kernPosFilters.end());
-	reverse(m_kernPosStart.begin(), m_kernPosStart.end());
-	reverse(m_kernNegFilters.begin(), m_kernNegFilters.end());
-    reverse(m_kernNegStart.begin(), m_kernNegStart.end());
+	reverse(posFilters.begin(), posFilters.end());
+	reverse(kern->posStart.begin(), kern->posStart.end());
+	reverse(negFilters.begin(), negFilters.end());
+    reverse(kern->negStart.begin(), kern->negStart.end());
+
+    // store filters one after the other
+    for (int k=0;k<nbCoeffs;k++)
+    {
+        kern->posSize.push_back(posFilters[k].size());
+        kern->negSize.push_back(negFilters[k].size());
+    }
+    kern->computeOffsets();
+    kern->coeffs.resize(kern->posOffset.empty() ? 0 : kern->negOffset.back() + kern->negSize.back());
+    for (int k=0;k<nbCoeffs;k++)
+    {
+        std::copy(posFilters[k].data(),posFilters[k].data()+posFilters[k].size(),kern->coeffs.begin()+kern->posOffset[k]);
+        std::copy(negFilters[k].data(),negFilters[k].data()+negFilters[k].size(),kern->coeffs.begin()+kern->negOffset[k]);
+    }
+    kern->filters = kern->coeffs.empty() ? NULL : &kern->coeffs[0];
+
+    if (!cacheKey.empty())
+    {
+        vector<char> data = kern->serialize();
+        KernelCache::store(cacheKey,&data[0],data.size());
+    }
 
     return StreamInfo(in,nbCoeffs);
 }
 
 void CQT::processToken(double* inPtr, const int inSize, double* outPtr, const int outSize)
 {
-	assert(outSize==m_kernPosFilters.size());
+	const Kernel& kern = *m_kernel;
+	assert(outSize==kern.posStart.size());
     int fftSize = inSize / 2;
 	Map<ArrayXcd> inData((complex<double>*) inPtr, fftSize);
-	for (size_t k = 0; k < m_kernPosFilters.size(); k++)
+	for (size_t k = 0; k < kern.posStart.size(); k++)
 	{
-		outPtr[k] = abs( (m_kernPosStart[k]!=-1 ? (inData.segment(m_kernPosStart[k],m_kernPosFilters[k].size()) * m_kernPosFilters[k]).sum() : 0) +
-				         (m_kernNegStart[k]!=-1 ? (inData.segment(m_kernNegStart[k],m_kernNegFilters[k].size()).conjugate() * m_kernNegFilters[k]).sum() : 0));
+		outPtr[k] = abs( (kern.posStart[k]!=-1 ? (inData.segment(kern.posStart[k],kern.posSize[k]) * Map<const ArrayXcd>(kern.filters + kern.posOffset[k],kern.posSize[k])).sum() : 0) +
+				         (kern.negStart[k]!=-1 ? (inData.segment(kern.negStart[k],kern.negSize[k]).conjugate() * Map<const ArrayXcd>(kern.filters + kern.negOffset[k],kern.negSize[k])).sum() : 0));
 	}
 }
 
+void CQT::Kernel::computeOffsets()
+{
+    int offset = 0;
+    posOffset.resize(posSize.size());
+    negOffset.resize(negSize.size());
+    for (size_t k=0;k<posSize.size();k++)
+    {
+        posOffset[k] = offset;
+        offset += posSize[k];
+        negOffset[k] = offset;
+        offset += negSize[k];
+    }
+}
+
+// cached kernel layout: number of coefficients, then posStart, posSize,
+// negStart and negSize arrays, then filters aligned on 16 bytes
+static int kernelHeaderSize(int nbCoeffs)
+{
+    int s = (1 + 4*nbCoeffs) * sizeof(int);
+    return (s + 15) / 16 * 16;
+}
+
+vector<char> CQT::Kernel::serialize() const
+{
+    int nbCoeffs = posStart.size();
+    int header = kernelHeaderSize(nbCoeffs);
+    vector<char> data(header + coeffs.size()*sizeof(complex<double>),0);
+    int* ints = (int*) &data[0];
+    ints[0] = nbCoeffs;
+    std::copy(posStart.begin(),posStart.end(),ints+1);
+    std::copy(posSize.begin(),posSize.end(),ints+1+nbCoeffs);
+    std::copy(negStart.begin(),negStart.end(),ints+1+2*nbCoeffs);
+    std::copy(negSize.begin(),negSize.end(),ints+1+3*nbCoeffs);
+    if (!coeffs.empty())
+        memcpy(&data[header],&coeffs[0],coeffs.size()*sizeof(complex<double>));
+    return data;
+}
+
+static bool validFilter(int start, int size, int nbFreqs)
+{
+    if (start==-1)
+        return size==0;
+    return start>=0 && size>=0 && size<=nbFreqs-start;
+}
+
+bool CQT::Kernel::load(const SharedPtr<KernelCache::Entry>& entry, int nbCoeffs, int fftLen)
+{
+    if (entry.isNull())
+        return false;
+    size_t header = kernelHeaderSize(nbCoeffs);
+    const int* ints = (const int*) entry->data();
+    if (entry->size() < header || ints[0]!=nbCoeffs)
+        return false;
+    // filters are segments of the fftLen/2+1 positive or negative
+    // frequencies, files with filters out of this range are ignored
+    int nbFreqs = fftLen/2+1;
+    size_t nbFilters = 0;
+    for (int k=0;k<nbCoeffs;k++)
+    {
+        if (!validFilter(ints[1+k],ints[1+nbCoeffs+k],nbFreqs)
+            || !validFilter(ints[1+2*nbCoeffs+k],ints[1+3*nbCoeffs+k],nbFreqs))
+            return false;
+        nbFilters += ints[1+nbCoeffs+k] + ints[1+3*nbCoeffs+k];
+    }
+    if (entry->size() != header + nbFilters*sizeof(complex<double>))
+        return false;
+    posStart.assign(ints+1,ints+1+nbCoeffs);
+    posSize.assign(ints+1+nbCoeffs,ints+1+2*nbCoeffs);
+    negStart.assign(ints+1+2*nbCoeffs,ints+1+3*nbCoeffs);
+    negSize.assign(ints+1+3*nbCoeffs,ints+1+4*nbCoeffs);
+    computeOffsets();
+    filters = (const complex<double>*) (entry->data() + header);
+    cacheEntry = entry;
+    return true;
+}
+
 }
@@ -9,7 +9,10 @@
 #define CQT_H_
 
 #include "yaafe-core/ComponentHelpers.h"
+#include "yaafe-core/KernelCache.h"
+#include "yaafe-core/SharedPtr.h"
 #include <Eigen/Dense>
+#include <complex>
 
 #define CQT_ID "CQT"
 
@@ -29,14 +32,32 @@ public:
     virtual YAAFE::StreamInfo init(const YAAFE::ParameterMap& params, const YAAFE::StreamInfo& in);
     virtual void processToken(double* inData, const int inSize, double* out, const int outSize);
 
+    virtual Component* copy() const { return new CQT(*this); }
+
 private:
     int m_size;
     int m_fftLen;
 
-    std::vector<Eigen::ArrayXcd> m_kernPosFilters;
-    std::vector<Eigen::ArrayXcd> m_kernNegFilters;
-    std::vector<int> m_kernPosStart;
-    std::vector<int> m_kernNegStart;
+    // positive and negative frequencies filters of each coefficient, start
+    // is -1 for empty filters. Filters coefficients are stored one after
+    // the other, in coeffs or in a kernel cache entry.
+    struct Kernel {
+        Kernel() : filters(NULL) {}
+        std::vector<int> posStart;
+        std::vector<int> posSize;
+        std::vector<int> negStart;
+        std::vector<int> negSize;
+        std::vector<int> posOffset;
+        std::vector<int> negOffset;
+        const std::complex<double>* filters;
+        std::vector<std::complex<double> > coeffs;
+        SharedPtr<KernelCache::Entry> cacheEntry;
+
+        bool load(const SharedPtr<KernelCache::Entry>& entry, int nbCoeffs, int fftLen);
+        std::vector<char> serialize() const;
+        void computeOffsets();
+    };
+    SharedPtr<Kernel> m_kernel;
 
 };
 
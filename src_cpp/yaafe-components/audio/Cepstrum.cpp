@@ -28,6 +28,9 @@
 #include <iostream>
 #include <string.h>
 
+// use the FFT based DCT when more than CEPSTRUM_FFT_THRESHOLD*log2(N)
+// coefficients are computed from N values
+#define CEPSTRUM_FFT_THRESHOLD 25
 
 using namespace std;
 using namespace Eigen;
@@ -35,14 +38,59 @@ using namespace Eigen;
 namespace YAAFE
 {
 
-  Cepstrum::Cepstrum()
+  Cepstrum::Cepstrum() :
+    m_nbCoeffs(0), m_ignoreFirst(0), m_useFFT(false)
+#ifdef WITH_FFTW3
+    , m_fftSize(0), m_fftIn(NULL), m_fftOut(NULL)
+#endif
   {
   }
 
+#ifdef WITH_FFTW3
+  Cepstrum::Cepstrum(const Cepstrum& other) :
+    ComponentBase<Cepstrum>(other), m_nbCoeffs(other.m_nbCoeffs),
+    m_ignoreFirst(other.m_ignoreFirst), m_dctPlan(other.m_dctPlan),
+    m_useFFT(other.m_useFFT), m_twiddles(other.m_twiddles),
+    m_fftPlan(other.m_fftPlan), m_fftSize(0), m_fftIn(NULL), m_fftOut(NULL)
+  {
+    // the plan is shared, buffers are not
+    if (m_useFFT)
+      allocFFTBuffers(other.m_fftSize);
+  }
+#else
+  Cepstrum::Cepstrum(const Cepstrum& other) :
+    ComponentBase<Cepstrum>(other), m_nbCoeffs(other.m_nbCoeffs),
+    m_ignoreFirst(other.m_ignoreFirst), m_dctPlan(other.m_dctPlan),
+    m_useFFT(other.m_useFFT), m_twiddles(other.m_twiddles), m_fft(),
+    m_fftIn(other.m_fftIn.size()), m_fftOut(other.m_fftOut.size())
+  {
+    // FFT plans cannot be copied, the copy makes its own on first use
+  }
+#endif
+
   Cepstrum::~Cepstrum()
   {
+#ifdef WITH_FFTW3
+    if (m_fftIn)
+      fftw_free(m_fftIn);
+    if (m_fftOut)
+      fftw_free(m_fftOut);
+#endif
   }
 
+#ifdef WITH_FFTW3
+  void Cepstrum::allocFFTBuffers(int N)
+  {
+    if (m_fftIn)
+      fftw_free(m_fftIn);
+    if (m_fftOut)
+      fftw_free(m_fftOut);
+    m_fftSize = N;
+    m_fftIn = (double*) fftw_malloc(N*sizeof(double));
+    m_fftOut = (complex<double>*) fftw_malloc((N/2+1)*sizeof(fftw_complex));
+  }
+#endif
+
   ParameterDescriptorList Cepstrum::getParameterDescriptorList() const
   {
     ParameterDescriptorList pList;
@@ -75,12 +123,40 @@ namespace YAAFE
       cerr << "compute only " << m_nbCoeffs << " coefficients" << endl;
     }
 
-    m_dctPlan.resize(in.size,in.size);
-    for (int j=0;j<in.size;j++)
-      m_dctPlan(0,j) = 1.0 / sqrt((double)in.size);
-    for (int i=1;i<in.size;i++)
-      for (int j=0;j<in.size;j++)
-        m_dctPlan(i,j) = sqrt(2.0 / in.size) * cos(PI * (j + 0.5) * i / in.size);
+    // the FFT based DCT costs O(N.log(N)) per frame, whatever the number
+    // of coefficients
+    const int N = in.size;
+    m_useFFT = (m_nbCoeffs > CEPSTRUM_FFT_THRESHOLD * log2((double) N));
+    if (m_useFFT)
+    {
+      // DCT-II computed with a N points FFT of reordered input (Makhoul)
+      m_twiddles.resize(m_nbCoeffs);
+      for (int k=0;k<m_nbCoeffs;k++)
+      {
+        const int i = k + m_ignoreFirst;
+        const double scale = (i==0) ? 1.0 / sqrt((double)N) : sqrt(2.0 / N);
+        m_twiddles(k) = scale * exp(complex<double>(0,-PI * i / (2.0 * N)));
+      }
+#ifdef WITH_FFTW3
+      // plan once here, under the planner lock, and share it with copies
+      m_fftPlan.reset(FFTWPlan::r2c(N));
+      allocFFTBuffers(N);
+#else
+      m_fftIn.resize(N);
+      m_fftOut.resize(N);
+#endif
+    }
+    else
+    {
+      // keep only the rows of the needed coefficients
+      m_dctPlan.resize(m_nbCoeffs,N);
+      for (int k=0;k<m_nbCoeffs;k++)
+      {
+        const int i = k + m_ignoreFirst;
+        for (int j=0;j<N;j++)
+          m_dctPlan(k,j) = (i==0) ? 1.0 / sqrt((double)N) : sqrt(2.0 / N) * cos(PI * (j + 0.5) * i / N);
+      }
+    }
 
     outStreamInfo().add(StreamInfo(in, m_nbCoeffs));
     return true;
@@ -102,16 +178,62 @@ namespace YAAFE
     assert(outp.size()==1);
     OutputBuffer* out = outp[0].data;
 
+    const int N = in->info().size;
     safeLogOp<double> slop;
-    VectorXd outDct;
     while (!in->empty())
     {
-      Map<VectorXd> inData(in->readToken(),in->info().size);
-      outDct.noalias() = m_dctPlan * inData.unaryExpr(slop);
-      memcpy(out->writeToken(),outDct.data() + m_ignoreFirst, out->info().size*sizeof(double));
-      in->consumeToken();
+      // process all tokens of the block at once
+      const int nbTokens = in->blockAvailableTokens();
+      Map<MatrixXd> inData(in->readToken(),N,nbTokens);
+      m_logSpec = inData.unaryExpr(slop);
+      int t = 0;
+      while (t<nbTokens)
+      {
+        const int n = min(nbTokens-t,out->remainingSpace());
+        Map<MatrixXd> outData(out->writeTokens(n),m_nbCoeffs,n);
+        if (m_useFFT)
+        {
+          for (int j=0;j<n;j++)
+            fftDct(m_logSpec.col(t+j).data(),outData.col(j).data());
+        }
+        else
+          outData.noalias() = m_dctPlan * m_logSpec.middleCols(t,n);
+        t += n;
+      }
+      in->consumeTokens(nbTokens);
     }
     return true;
   }
 
+#ifdef WITH_FFTW3
+  void Cepstrum::fftDct(const double* inData, double* outData)
+  {
+    const int N = m_fftSize;
+    for (int n=0;2*n<N;n++)
+      m_fftIn[n] = inData[2*n];
+    for (int n=0;2*n+1<N;n++)
+      m_fftIn[N-1-n] = inData[2*n+1];
+    fftw_execute_dft_r2c(m_fftPlan->plan,m_fftIn,(fftw_complex*) m_fftOut);
+    for (int k=0;k<m_nbCoeffs;k++)
+    {
+      // real input: upper half of the spectrum is conjugate symmetric
+      const int i = k + m_ignoreFirst;
+      const complex<double> X = (2*i<=N) ? m_fftOut[i] : conj(m_fftOut[N-i]);
+      outData[k] = (m_twiddles(k) * X).real();
+    }
+  }
+#else
+  void Cepstrum::fftDct(const double* inData, double* outData)
+  {
+    const int N = m_fftIn.size();
+    for (int n=0;2*n<N;n++)
+      m_fftIn(n) = inData[2*n];
+    for (int n=0;2*n+1<N;n++)
+      m_fftIn(N-1-n) = inData[2*n+1];
+    m_fft.fwd(m_fftOut,m_fftIn);
+    for (int k=0;k<m_nbCoeffs;k++)
+      outData[k] = (m_twiddles(k) * m_fftOut(k+m_ignoreFirst)).real();
+  }
+#endif
+
 }
@@ -27,6 +27,12 @@
 
 #include "yaafe-core/Component.h"
 #include <Eigen/Dense>
+#ifdef WITH_FFTW3
+#include "yaafe-core/SharedPtr.h"
+#include "MathUtils.h"
+#else
+#include <unsupported/Eigen/FFT>
+#endif
 
 #define CEPSTRUM_ID "Cepstrum"
 
@@ -37,6 +43,7 @@ namespace YAAFE
   {
    public:
      Cepstrum();
+     Cepstrum(const Cepstrum& other);
      virtual ~Cepstrum();
 
      virtual const std::string getIdentifier() const { return CEPSTRUM_ID;};
@@ -46,10 +53,32 @@ namespace YAAFE
      virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
      virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
 
+     virtual Component* copy() const { return new Cepstrum(*this); }
+
    private:
      int m_nbCoeffs;
      int m_ignoreFirst;
+     // DCT-II rows of the kept coefficients
      Eigen::MatrixXd m_dctPlan;
+     Eigen::MatrixXd m_logSpec;
+     // FFT based DCT-II, used for large inputs
+     bool m_useFFT;
+     Eigen::VectorXcd m_twiddles;
+#ifdef WITH_FFTW3
+     SharedPtr<FFTWPlan> m_fftPlan;
+     int m_fftSize;
+     double* m_fftIn;
+     std::complex<double>* m_fftOut;
+     void allocFFTBuffers(int N);
+#else
+     Eigen::FFT<double> m_fft;
+     Eigen::VectorXd m_fftIn;
+     Eigen::VectorXcd m_fftOut;
+#endif
+
+     void fftDct(const double* inData, double* outData);
+
+     Cepstrum& operator=(const Cepstrum&);
   };
 
 }
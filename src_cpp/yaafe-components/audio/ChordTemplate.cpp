@@ -14,6 +14,7 @@ using namespace YAAFE;
 
 const ChordTemplate ChordTemplate::UNKNOWN("unknown",0,"");
 vector<ChordTemplate> ChordTemplate::s_chords;
+Mutex ChordTemplate::s_chordsMutex;
 
 ChordTemplate::ChordTemplate(char* n, int q, char* pattern) :
 	m_name(n), m_quality(q), m_notes() {
@@ -34,6 +35,7 @@ ChordTemplate::~ChordTemplate() {
 }
 
 const std::vector<ChordTemplate>& ChordTemplate::listChordTemplates() {
+	MutexLock lock(s_chordsMutex);
 	if (s_chords.size() == 0) {
 		s_chords.push_back(ChordTemplate("maj",0,"047"));
 		s_chords.push_back(ChordTemplate("min",1,"037"));
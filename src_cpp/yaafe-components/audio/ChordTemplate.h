@@ -10,6 +10,7 @@
 
 #include <string>
 #include <vector>
+#include "yaafe-core/Thread.h"
 
 namespace YAAFE {
 
@@ -33,6 +34,7 @@ private:
 	std::vector<int> m_notes;
 
 	static std::vector<ChordTemplate> s_chords;
+	static Mutex s_chordsMutex;
 };
 
 
@@ -114,13 +114,16 @@ void Chroma2ChordDict::Dict::fillPattern(const vector<int>& notes,const int nbHa
 }
 
 Chroma2ChordDict::Chroma2ChordDict() :
-		m_chordTypes(), m_nbHarmnonics(0), m_dict(NULL)
+		m_chordTypes(), m_nbHarmnonics(0), m_dict()
 {
 }
 
 Chroma2ChordDict::~Chroma2ChordDict() {
-	if (m_dict)
-		delete m_dict;
+}
+
+Component* Chroma2ChordDict::copy() const
+{
+	return new Chroma2ChordDict(*this);
 }
 
 ParameterDescriptorList Chroma2ChordDict::getParameterDescriptorList() const
@@ -150,11 +153,10 @@ StreamInfo Chroma2ChordDict::init(const ParameterMap& params, const StreamInfo&
 	m_chordTypes = types;
 	m_nbHarmnonics = nbHarmo;
 
-	m_dict = new Dict();
+	m_dict.reset(new Dict());
 	if (!m_dict->populate(m_chordTypes,m_nbHarmnonics))
 	{
-		delete m_dict;
-		m_dict = NULL;
+		m_dict.reset();
 		// return false
 	}
 	return StreamInfo(in, m_dict->size());
@@ -9,6 +9,7 @@
 #define CHROMA2CHORDS_H_
 
 #include "yaafe-core/ComponentHelpers.h"
+#include "yaafe-core/SharedPtr.h"
 
 #define CHROMA2CHORDS_ID "Chroma2ChordDict"
 
@@ -26,12 +27,14 @@ public:
     virtual YAAFE::StreamInfo init(const YAAFE::ParameterMap& params, const YAAFE::StreamInfo& in);
     virtual void processToken(double* inData, const int inSize, double* out, const int outSize);
 
+    virtual Component* copy() const;
+
 private:
     std::string m_chordTypes;
     int m_nbHarmnonics;
 
     class Dict;
-    Dict* m_dict;
+    SharedPtr<Dict> m_dict;
 };
 
 }
@@ -24,16 +24,15 @@
 
 #include "ComplexDomainFlux.h"
 
-#include <Eigen/Dense>
-#include <iostream>
+#include <cmath>
+#include <algorithm>
 
-using namespace Eigen;
 using namespace std;
 
 namespace YAAFE
 {
 
-  ComplexDomainFlux::ComplexDomainFlux()
+  ComplexDomainFlux::ComplexDomainFlux() : m_float(false)
   {
   }
 
@@ -41,48 +40,106 @@ namespace YAAFE
   {
   }
 
+  ParameterDescriptorList ComplexDomainFlux::getParameterDescriptorList() const
+  {
+    ParameterDescriptorList pList;
+    pList.push_back(kernelPrecisionParameter());
+    return pList;
+  }
+
   bool ComplexDomainFlux::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
   {
     assert(inp.size()==1);
     const StreamInfo& in = inp[0].data;
 
+    m_float = useFloatKernel(params);
+    const int size = 2*(in.size/2);
+    if (m_float) {
+      m_floatPred.resize(size);
+      m_floatRot.resize(size);
+    } else {
+      m_pred.resize(size);
+      m_rot.resize(size);
+    }
+    reset();
+
     outStreamInfo().add(StreamInfo(in,1));
     return true;
   }
 
-  template<typename Scalar>
-    struct rotatorOp {
-      complex<Scalar> operator()(const complex<Scalar>& x) const { return ((x.real()!=0) || (x.imag()!=0)) ? x / abs(x) : 1;}
-    };
+  template<typename T>
+  static void resetState(std::vector<T>& pred, std::vector<T>& rot)
+  {
+    // first frame is predicted from two frames of zeros, which rotators are 1
+    fill(pred.begin(),pred.end(),0);
+    fill(rot.begin(),rot.begin()+rot.size()/2,1);
+    fill(rot.begin()+rot.size()/2,rot.end(),0);
+  }
+
+  void ComplexDomainFlux::reset()
+  {
+    resetState(m_pred,m_rot);
+    resetState(m_floatPred,m_floatRot);
+  }
+
+  /**
+   * Returns the distance between a frame and its prediction, and predicts
+   * the next frame: same amplitudes, and phases rotated as between the
+   * previous frame and this one. Rotators are the bins normalized to unit
+   * length, so that no phase has to be computed.
+   */
+  template<typename T>
+  static T complexDomainFlux(const double* inData, const int N, T* pred, T* rot)
+  {
+    T* predIm = pred + N;
+    T* rotIm = rot + N;
+    T flux = 0;
+    for (int k=0;k<N;k++)
+    {
+      const T xr = inData[2*k];
+      const T xi = inData[2*k+1];
+      const T dr = xr - pred[k];
+      const T di = xi - predIm[k];
+      flux += sqrt(dr*dr + di*di);
+      // rotator of null bins is 1
+      const T n2 = xr*xr + xi*xi;
+      const T inv = (n2>0) ? 1 / sqrt(n2) : 0;
+      const T rr = (n2>0) ? xr*inv : 1;
+      const T ri = xi*inv;
+      // rotation from the previous frame
+      const T qr = rr*rot[k] + ri*rotIm[k];
+      const T qi = ri*rot[k] - rr*rotIm[k];
+      pred[k] = xr*qr - xi*qi;
+      predIm[k] = xr*qi + xi*qr;
+      rot[k] = rr;
+      rotIm[k] = ri;
+    }
+    return flux;
+  }
 
   bool ComplexDomainFlux::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
   {
     assert(inp.size()==1);
     InputBuffer* in = inp[0].data;
+    if (in->empty()) return false;
     assert(outp.size()==1);
     OutputBuffer* out = outp[0].data;
 
-    if ((out->tokenno()==0) && (in->tokenno()!=-2))
-      in->prependZeros(2);
-    if (!in->hasTokens(3)) return false;
-
-    const int N = in->info().size/2;
-    ArrayXcd inPredPredRotator(N);
-    ArrayXcd inPredRotator(N);
-    rotatorOp<double> op;
-    {
-      Map<ArrayXcd> inPredPredData((complex<double>*) in->token(0),N);
-      inPredPredRotator = inPredPredData.unaryExpr(op);
-    }
-    while (in->hasTokens(3))
+    const int size = in->info().size;
+    const int N = size/2;
+    while (!in->empty())
     {
-      Map<ArrayXcd> inPredData((complex<double>*) in->token(1),N);
-      Map<ArrayXcd> inData((complex<double>*) in->token(2), N);
-      inPredRotator = inPredData.unaryExpr(op);
-      double* output = out->writeToken();
-      *output++ = (inData - (inPredData * (inPredRotator * inPredPredRotator.conjugate()))).abs().sum();
-      in->consumeToken();
-      inPredPredRotator.swap(inPredRotator);
+      const int nbTokens = in->blockAvailableTokens();
+      const double* inData = in->readToken();
+      for (int t=0;t<nbTokens;t++,inData+=size)
+      {
+        double* output = out->writeToken();
+        if (m_float)
+          *output = complexDomainFlux(inData,N,&m_floatPred[0],&m_floatRot[0]);
+        else
+          *output = complexDomainFlux(inData,N,&m_pred[0],&m_rot[0]);
+      }
+      in->consumeTokens(nbTokens);
     }
 
     return true;
@@ -26,6 +26,7 @@
 #define COMPLEXDOMAINFLUX_H_
 
 #include "yaafe-core/Component.h"
+#include <vector>
 
 #define COMPLEX_DOMAIN_FLUX_ID "ComplexDomainFlux"
 
@@ -40,8 +41,22 @@ namespace YAAFE
 
      virtual const std::string getIdentifier() const { return COMPLEX_DOMAIN_FLUX_ID;};
 
+     virtual Component* copy() const { return new ComplexDomainFlux(*this); }
+
+     virtual ParameterDescriptorList getParameterDescriptorList() const;
+
      virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
+     virtual void reset();
      virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+
+   private:
+     bool m_float;
+     // predicted next frame and phase rotators of the last frame,
+     // real parts followed by imaginary parts
+     std::vector<double> m_pred;
+     std::vector<double> m_rot;
+     std::vector<float> m_floatPred;
+     std::vector<float> m_floatRot;
   };
 
 }
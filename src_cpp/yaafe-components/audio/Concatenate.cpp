@@ -60,31 +60,33 @@ bool Concatenate::process(YAAFE::Ports<YAAFE::InputBuffer*>& inp, YAAFE::Ports<Y
 #endif
 
 
-	// check if some data is available
-	for (int i=0;i<inp.size();i++)
-	{
-		if (inp[i].data->empty())
-			return false;
-	}
-
 	InputBuffer* inputs[m_portSize];
 	for (int i=0;i<m_portSize;i++)
 		inputs[i] = inp[m_portOrder[i]].data;
 
-	// concatenate streams
-	bool hasNextToken = true;
-	while (hasNextToken) {
-		double* outTok = out->writeToken();
+	// concatenate streams, one block of contiguous tokens at a time
+	const int outSize = out->info().size;
+	bool doneSomething = false;
+	while (true) {
+		int nbTokens = out->remainingSpace();
+		for (int i=0;i<m_portSize;i++)
+			nbTokens = min(nbTokens,inputs[i]->blockAvailableTokens());
+		if (nbTokens==0)
+			break;
+		double* outData = out->writeTokens(nbTokens);
 		for (int i=0;i<m_portSize;i++) {
 			InputBuffer* in = inputs[i];
-			memcpy(outTok,in->readToken(),in->info().size*sizeof(double));
-			in->consumeToken();
-			outTok += in->info().size;
-			if (in->empty()) hasNextToken = false;
+			const int inSize = in->info().size;
+			const double* inData = in->readToken();
+			for (int t=0;t<nbTokens;t++)
+				memcpy(outData+t*outSize,inData+t*inSize,inSize*sizeof(double));
+			in->consumeTokens(nbTokens);
+			outData += inSize;
 		}
+		doneSomething = true;
 	}
 
-	return true;
+	return doneSomething;
 }
 
 } // YAAFE
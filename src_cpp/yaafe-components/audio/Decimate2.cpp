@@ -2,6 +2,7 @@
 #include "Decimate2.h"
 
 #include "yaafe-core/Buffer.h"
+#include <string.h>
 
 #ifdef USE_SSE2_INTRINSICS
 #include <Eigen/Core>
@@ -17,6 +18,7 @@ using namespace std;
 namespace YAAFE {
 
 double* Decimate2::s_filter(NULL);
+Mutex Decimate2::s_filterMutex;
 
 void Decimate2::initFilter()
 {
@@ -400,9 +402,15 @@ void Decimate2::initFilter()
 		s_filter[i] = tmp[FILTER_SIZE-1-i]; // ensure s_filter is 16-bytes aligned
 }
 
-Decimate2::Decimate2() : m_state(NULL)
+Decimate2::Decimate2() : m_state(NULL), m_pos(0), m_parity(0)
 {}
 
+Decimate2::Decimate2(const Decimate2& other) :
+	ComponentBase<Decimate2>(other), m_state(NULL), m_pos(0), m_parity(0)
+{
+	*this = other;
+}
+
 Decimate2::~Decimate2() {
 	if (m_state) {
 #ifdef USE_SSE2_INTRINSICS
@@ -413,20 +421,43 @@ Decimate2::~Decimate2() {
 	}
 }
 
-
-bool Decimate2::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+Decimate2& Decimate2::operator=(const Decimate2& other)
 {
-	assert(inp.size()==1); // can only decimate mono signals
-	const StreamInfo& in = inp[0].data;
+	if (this==&other)
+		return *this;
+	ComponentBase<Decimate2>::operator=(other);
+	if (other.m_state) {
+		if (!m_state)
+			allocState();
+		memcpy(m_state,other.m_state,STATE_SIZE*sizeof(double));
+	}
+	m_pos = other.m_pos;
+	m_parity = other.m_parity;
+	return *this;
+}
 
+void Decimate2::allocState()
+{
 #ifdef USE_SSE2_INTRINSICS
 	m_state = (double*) Eigen::ei_aligned_malloc(STATE_SIZE*sizeof(double));
 #else
 	m_state = new double[STATE_SIZE];
 #endif
+}
+
+bool Decimate2::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+{
+	assert(inp.size()==1); // can only decimate mono signals
+	const StreamInfo& in = inp[0].data;
+
+	if (!m_state)
+		allocState();
 	m_pos = 0;
-	if (s_filter==NULL)
-		initFilter();
+	{
+		MutexLock lock(s_filterMutex);
+		if (s_filter==NULL)
+			initFilter();
+	}
 
 	StreamInfo out;
 	out.sampleRate = in.sampleRate / 2;
@@ -442,6 +473,55 @@ void Decimate2::reset() {
 	m_pos = FILTER_SIZE - 2 * DELAY-1;
 	for (int i=0;i<m_pos;i++)
 		m_state[i] = 0.0;
+	m_parity = 0;
+}
+
+int Decimate2::filterState(double* out)
+{
+	int i=0;
+	int nbOut = 0;
+
+#ifdef USE_SSE2_INTRINSICS
+	{
+		// start filtering using SSE2 instructions
+		int i_end=m_pos-FILTER_SIZE-2;
+		double tmp[2];
+		for (;i<(i_end);i+=4) {
+			__m128d f = _mm_load_pd(s_filter);
+			__m128d s = _mm_load_pd(m_state + i);
+			__m128d v1 = _mm_mul_pd(f,s);
+			__m128d v2 = _mm_setzero_pd();
+			for (int j=2;j<FILTER_SIZE;j+=2)
+			{
+				s = _mm_load_pd(m_state + i + j);
+				v2 = _mm_add_pd(v2,_mm_mul_pd(f,s));
+				f = _mm_load_pd(s_filter + j);
+				v1 = _mm_add_pd(v1,_mm_mul_pd(f,s));
+			}
+			s = _mm_load_pd(m_state + i + FILTER_SIZE);
+			v2 = _mm_add_pd(v2,_mm_mul_pd(f,s));
+			_mm_storeu_pd(tmp,v1);
+			out[nbOut++] = tmp[0] + tmp[1];
+			_mm_storeu_pd(tmp,v2);
+			out[nbOut++] = tmp[0] + tmp[1];
+		}
+	}
+#endif
+
+	int i_end=m_pos-FILTER_SIZE;
+	for (;i<i_end;i+=2) {
+		long double v = 0.0;
+		for (int j=0;j<FILTER_SIZE;++j)
+			v += m_state[i+j]*s_filter[j];
+		out[nbOut++] = v;
+	}
+
+	// save last samples for next filterings
+	int k = 0;
+	for (;i<m_pos;++k,++i)
+		m_state[k] = m_state[i];
+	m_pos = k;
+	return nbOut;
 }
 
 bool Decimate2::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
@@ -451,55 +531,13 @@ bool Decimate2::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
 	InputBuffer* in = inp[0].data;
 	OutputBuffer* out = outp[0].data;
 
+	double outData[STATE_SIZE/2];
 	while (!in->empty()) {
 		// read data
 		int read = in->read(m_state+m_pos,STATE_SIZE-m_pos);
 		in->consumeTokens(read);
 		m_pos += read;
-
-//		 filtering
-		int i=0;
-
-#ifdef USE_SSE2_INTRINSICS
-		{
-			// start filtering using SSE2 instructions
-			int i_end=m_pos-FILTER_SIZE-2;
-			double tmp[2];
-			for (;i<(i_end);i+=4) {
-				__m128d f = _mm_load_pd(s_filter);
-				__m128d s = _mm_load_pd(m_state + i);
-				__m128d v1 = _mm_mul_pd(f,s);
-				__m128d v2 = _mm_setzero_pd();
-				for (int j=2;j<FILTER_SIZE;j+=2)
-				{
-					s = _mm_load_pd(m_state + i + j);
-					v2 = _mm_add_pd(v2,_mm_mul_pd(f,s));
-					f = _mm_load_pd(s_filter + j);
-					v1 = _mm_add_pd(v1,_mm_mul_pd(f,s));
-				}
-				s = _mm_load_pd(m_state + i + FILTER_SIZE);
-				v2 = _mm_add_pd(v2,_mm_mul_pd(f,s));
-				_mm_storeu_pd(tmp,v1);
-				*out->writeToken() = tmp[0] + tmp[1];
-				_mm_storeu_pd(tmp,v2);
-				*out->writeToken() = tmp[0] + tmp[1];
-			}
-		}
-#endif
-
-		int i_end=m_pos-FILTER_SIZE;
-		for (;i<i_end;i+=2) {
-			long double v = 0.0;
-			for (int j=0;j<FILTER_SIZE;++j)
-				v += m_state[i+j]*s_filter[j];
-			*out->writeToken() = v;
-		}
-
-		// save last samples for next filterings
-		int k = 0;
-		for (;i<m_pos;++k,++i)
-			m_state[k] = m_state[i];
-		m_pos = k;
+		out->write(outData,filterState(outData));
 	}
 
 	return true;
@@ -513,4 +551,26 @@ void Decimate2::flush(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
 	process(inp,outp);
 }
 
+void Decimate2::decimate(const double* data, int nbSamples, std::vector<double>& out)
+{
+	double outData[STATE_SIZE/2];
+	m_parity = (m_parity + nbSamples) % 2;
+	while (nbSamples>0) {
+		int read = min(nbSamples,STATE_SIZE-m_pos);
+		memcpy(m_state+m_pos,data,read*sizeof(double));
+		data += read;
+		nbSamples -= read;
+		m_pos += read;
+		int nbOut = filterState(outData);
+		out.insert(out.end(),outData,outData+nbOut);
+	}
+}
+
+void Decimate2::decimateFlush(std::vector<double>& out)
+{
+	// same padding as flush()
+	vector<double> zeros(2*DELAY + 1 + (m_parity==0 ? 1 : 0), 0.0);
+	decimate(&zeros[0],zeros.size(),out);
+}
+
 } // YAAFE
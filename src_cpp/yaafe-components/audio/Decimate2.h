@@ -3,6 +3,8 @@
 #define DECIMATE2_H
 
 #include "yaafe-core/ComponentHelpers.h"
+#include "yaafe-core/Thread.h"
+#include <vector>
 
 #define DECIMATE2_ID "Decimate2"
 
@@ -13,8 +15,11 @@ class Decimate2: public YAAFE::ComponentBase<Decimate2>
 {
 public:
     Decimate2();
+    Decimate2(const Decimate2& other);
     virtual ~Decimate2();
 
+    Decimate2& operator=(const Decimate2& other);
+
     virtual const std::string getIdentifier() const { return DECIMATE2_ID;};
     virtual bool stateLess() const { return false; };
 
@@ -23,11 +28,30 @@ public:
 	virtual bool process(YAAFE::Ports<YAAFE::InputBuffer*>& in, YAAFE::Ports<YAAFE::OutputBuffer*>& out);
 	virtual void flush(YAAFE::Ports<YAAFE::InputBuffer*>& in, YAAFE::Ports<YAAFE::OutputBuffer*>& out);
 
+	virtual Component* copy() const { return new Decimate2(*this); }
+
+	/**
+	 * Decimate nbSamples samples, append decimated samples to out. Used by
+	 * components embedding a decimation stage, after init and reset.
+	 */
+	void decimate(const double* data, int nbSamples, std::vector<double>& out);
+	/**
+	 * Decimate remaining samples of the stream given to decimate().
+	 */
+	void decimateFlush(std::vector<double>& out);
+
 private:
 	double* m_state;
 	int m_pos;
+	int m_parity; // parity of the number of samples given to decimate()
+
+	// filter samples in state, keep last samples for next filterings.
+	// Returns the number of samples written to out.
+	int filterState(double* out);
+	void allocState();
 
 	static double* s_filter;
+	static Mutex s_filterMutex; // engines may be initialized concurrently
 	static void initFilter();
 };
 
@@ -25,7 +25,11 @@
 #include "Envelope.h"
 #include "MathUtils.h"
 #include <Eigen/Dense>
+#ifdef WITH_FFTW3
+#include <fftw3.h>
+#else
 #include <unsupported/Eigen/FFT>
+#endif
 #include <string.h>
 
 using namespace std;
@@ -38,21 +42,45 @@ namespace YAAFE
   {
    public:
      ComputingContext(double sampleRate, int blockSize,int decim);
-     virtual ~ComputingContext() {};
+     virtual ~ComputingContext();
 
      int m_blockSize;
-     FFT<double> m_fftForward;
-     FFT<double> m_fftBackward;
+#ifdef WITH_FFTW3
+     FFTWPlan* m_fwdPlan;
+     FFTWPlan* m_invPlan;
+     double* m_fftIn;
+#else
+     FFT<double> m_fft;
+     VectorXcd m_spectrum;
+     VectorXd m_hilbert;
+#endif
+     complex<double>* m_spectrumData;
+     double* m_hilbertData;
+     ArrayXd m_absHilbert;
 
      VectorXd m_filter;
      int m_decim;
      int m_filterDecSize;
      int m_envSize;
+     MatrixXd m_partialSums;
   };
 
   Envelope::ComputingContext::ComputingContext(double sampleRate, int blockSize,int decim) :
-    m_blockSize(blockSize), m_fftForward(), m_fftBackward(), m_decim(decim)
+    m_blockSize(blockSize), m_decim(decim)
   {
+#ifdef WITH_FFTW3
+    m_fwdPlan = FFTWPlan::r2c(blockSize);
+    m_invPlan = FFTWPlan::c2r(blockSize);
+    m_fftIn = (double*) fftw_malloc(blockSize*sizeof(double));
+    m_spectrumData = (complex<double>*) fftw_malloc((blockSize/2+1)*sizeof(fftw_complex));
+    m_hilbertData = (double*) fftw_malloc(blockSize*sizeof(double));
+#else
+    m_fft.SetFlag(FFT<double>::HalfSpectrum);
+    m_spectrum.resize(blockSize/2+1);
+    m_hilbert.resize(blockSize);
+    m_spectrumData = m_spectrum.data();
+    m_hilbertData = m_hilbert.data();
+#endif
     // compute filter window
     int wlen = (int) round(0.05 * sampleRate);
     VectorXd han(ehanning(2 * wlen));
@@ -63,6 +91,20 @@ namespace YAAFE
     if (m_filter.size() > wlen)
       m_filter.segment(wlen,m_filter.size()-wlen).setZero();
     m_filterDecSize = m_filter.size()/decim;
+
+    m_absHilbert.setZero(m_envSize*decim);
+    m_partialSums.resize(m_filterDecSize,m_envSize);
+  }
+
+  Envelope::ComputingContext::~ComputingContext()
+  {
+#ifdef WITH_FFTW3
+    delete m_fwdPlan;
+    delete m_invPlan;
+    fftw_free(m_fftIn);
+    fftw_free(m_spectrumData);
+    fftw_free(m_hilbertData);
+#endif
   }
 
   Envelope::Envelope() : m_context(0)
@@ -111,32 +153,48 @@ namespace YAAFE
     assert(out->info().size==m_context->m_envSize);
 
     const int N = in->info().size;
-    VectorXcd fftOut(N);
-    fftOut.setZero();
-    VectorXcd hilbert(N);
-    hilbert.setZero();
-    ArrayXd absHilbert(m_context->m_envSize*m_context->m_decim);
-    absHilbert.setZero();
+    const int decim = m_context->m_decim;
+    const int F = m_context->m_filterDecSize;
+    Map<VectorXcd> spec(m_context->m_spectrumData,N/2+1);
+    Map<VectorXd> hilbert(m_context->m_hilbertData,N);
+    ArrayXd& absHilbert = m_context->m_absHilbert;
+    MatrixXd& partialSums = m_context->m_partialSums;
+    Map<MatrixXd> filterBlocks(m_context->m_filter.data(),decim,F);
+    Map<MatrixXd> envBlocks(absHilbert.data(),decim,m_context->m_envSize);
     while (!in->empty())
     {
       Map<VectorXd> inData(in->readToken(),N);
-      m_context->m_fftForward.fwd(fftOut,inData);
-      fftOut.segment(1,N/2-1) *= 2.0;
-      fftOut.segment(N/2+1,N/2-1).setZero();
-      m_context->m_fftBackward.inv(hilbert,fftOut);
-      absHilbert.segment(0,N) = hilbert.array().abs();
-
-      // filter with decimation
-      const int decim = m_context->m_decim;
+      // hilbert transform with real transforms: multiply positive
+      // frequencies by -i, remove DC and Nyquist frequency
+#ifdef WITH_FFTW3
+      memcpy(m_context->m_fftIn,inData.data(),N*sizeof(double));
+      fftw_execute_dft_r2c(m_context->m_fwdPlan->plan,m_context->m_fftIn,(fftw_complex*)spec.data());
+#else
+      m_context->m_fft.fwd(spec.data(),inData.data(),N);
+#endif
+      spec(0) = 0.0;
+      for (int k=1;k<spec.size();k++)
+        spec(k) = complex<double>(spec(k).imag(),-spec(k).real());
+      if (N%2==0)
+        spec(N/2) = 0.0;
+#ifdef WITH_FFTW3
+      fftw_execute_dft_c2r(m_context->m_invPlan->plan,(fftw_complex*)spec.data(),hilbert.data());
+      hilbert /= N;
+#else
+      m_context->m_fft.inv(hilbert.data(),spec.data(),N);
+#endif
+      // analytic signal magnitude
+      absHilbert.segment(0,N) = (inData.array().square() + hilbert.array().square()).sqrt();
+
+      // filter with decimation: each output sample sums the products of
+      // the last F blocks of decim samples with the F filter blocks.
+      partialSums.noalias() = filterBlocks.transpose() * envBlocks;
       double* outPtr = out->writeToken();
       for (int i=0;i<out->info().size;i++)
       {
-        const double* h = absHilbert.data() + max(0,i-m_context->m_filterDecSize+1)*decim;
-        const double* hend = absHilbert.data() + (i+1)*decim;
-        const double* f = m_context->m_filter.data() + max(m_context->m_filterDecSize-1-i,0)*decim;
         double sum = 0;
-        for (;h!=hend;)
-          sum += *h++ * *f++;
+        for (int c=max(F-1-i,0);c<F;c++)
+          sum += partialSums(c,i-F+1+c);
         outPtr[i] = sum;
       }
 
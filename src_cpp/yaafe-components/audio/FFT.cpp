@@ -36,22 +36,77 @@ namespace YAAFE
 
   FFT::FFT() :
     m_window(), m_plan(), m_nfft(0)
-  {
 #ifdef WITH_FFTW3
-    m_plan = NULL;
-#else
+    , m_fftIn(NULL), m_fftOut(NULL)
+#ifdef WITH_FFTW3F
+    , m_floatIn(NULL), m_floatOut(NULL)
+#endif
+#endif
+  {
+#ifndef WITH_FFTW3
     m_plan.SetFlag(Eigen::FFT<double>::HalfSpectrum);
 #endif
   }
 
+#ifdef WITH_FFTW3
+  FFT::FFT(const FFT& other) :
+    StateLessOneInOneOutComponent<FFT>(other), m_window(other.m_window),
+    m_nfft(other.m_nfft), m_plan(other.m_plan), m_fftIn(NULL), m_fftOut(NULL)
+#ifdef WITH_FFTW3F
+    , m_floatPlan(other.m_floatPlan), m_floatWindow(other.m_floatWindow),
+    m_floatIn(NULL), m_floatOut(NULL)
+#endif
+  {
+    // plans are shared, buffers are not
+    allocFFTBuffers();
+  }
+#endif
+
   FFT::~FFT()
   {
 #ifdef WITH_FFTW3
-    if (m_plan)
-      fftw_destroy_plan(m_plan);
+    freeFFTBuffers();
+#endif
+  }
+
+#ifdef WITH_FFTW3
+  void FFT::allocFFTBuffers()
+  {
+    freeFFTBuffers();
+#ifdef WITH_FFTW3F
+    if (!m_floatPlan.isNull())
+    {
+      m_floatIn = (float*) fftwf_malloc(m_nfft*sizeof(float));
+      m_floatOut = (complex<float>*) fftwf_malloc((m_nfft/2+1)*sizeof(fftwf_complex));
+      return;
+    }
 #endif
+    if (!m_plan.isNull())
+    {
+      m_fftIn = (double*) fftw_malloc(m_nfft*sizeof(double));
+      m_fftOut = (complex<double>*) fftw_malloc((m_nfft/2+1)*sizeof(fftw_complex));
+    }
   }
 
+  void FFT::freeFFTBuffers()
+  {
+    if (m_fftIn)
+      fftw_free(m_fftIn);
+    if (m_fftOut)
+      fftw_free(m_fftOut);
+    m_fftIn = NULL;
+    m_fftOut = NULL;
+#ifdef WITH_FFTW3F
+    if (m_floatIn)
+      fftwf_free(m_floatIn);
+    if (m_floatOut)
+      fftwf_free(m_floatOut);
+    m_floatIn = NULL;
+    m_floatOut = NULL;
+#endif
+  }
+#endif
+
   ParameterDescriptorList FFT::getParameterDescriptorList() const
   {
     ParameterDescriptorList pList;
@@ -69,6 +124,10 @@ namespace YAAFE
     p.m_defaultValue = "Hanning";
     pList.push_back(p);
 
+#ifdef WITH_FFTW3F
+    pList.push_back(kernelPrecisionParameter());
+#endif
+
     return pList;
   }
 
@@ -91,12 +150,36 @@ namespace YAAFE
     }
     // init plan
     m_nfft = len;
+#ifdef WITH_FFTW3F
+    if (useFloatKernel(params))
+    {
+      m_floatWindow = m_window.cast<float>();
+      float* inFFT = (float*) fftwf_malloc(m_nfft*sizeof(float));
+      complex<float>* outFFT = (complex<float>*) fftwf_malloc((m_nfft/2+1)*sizeof(complex<float>));
+      fftwf_plan plan;
+      {
+        MutexLock lock(fftwPlannerMutex);
+        plan = fftwf_plan_dft_r2c_1d(m_nfft,inFFT,(fftwf_complex*)outFFT,FFTW_MEASURE);
+      }
+      m_floatPlan.reset(new FloatPlan(plan));
+      fftwf_free(inFFT);
+      fftwf_free(outFFT);
+      allocFFTBuffers();
+      return StreamInfo(in,len+2);
+    }
+#endif
 #ifdef WITH_FFTW3
     double* inFFT = (double*) fftw_malloc(m_nfft*sizeof(double));
     complex<double>* outFFT = (complex<double>*) fftw_malloc((m_nfft/2+1)*sizeof(complex<double>));
-    m_plan = fftw_plan_dft_r2c_1d(m_nfft,inFFT,(fftw_complex*)outFFT,FFTW_MEASURE);
+    fftw_plan plan;
+    {
+      MutexLock lock(fftwPlannerMutex);
+      plan = fftw_plan_dft_r2c_1d(m_nfft,inFFT,(fftw_complex*)outFFT,FFTW_MEASURE);
+    }
+    m_plan.reset(new Plan(plan));
     fftw_free(inFFT);
     fftw_free(outFFT);
+    allocFFTBuffers();
 #else
     VectorXd infft(m_nfft);
     VectorXcd outfft(m_nfft/2+1);
@@ -106,12 +189,51 @@ namespace YAAFE
     return StreamInfo(in,len+2);
   }
 
+#ifdef WITH_FFTW3F
+  void FFT::transformFloat(const double* inPtr, const int N)
+  {
+    Map<VectorXf> infft(m_floatIn,m_nfft);
+    Map<const VectorXd> inData(inPtr,N);
+    if (m_floatWindow.size()>0)
+      infft.segment(0,N) = m_floatWindow.array() * inData.array().cast<float>();
+    else
+      infft.segment(0,N) = inData.cast<float>();
+    if (N<m_nfft)
+      infft.segment(N,m_nfft-N).setZero();
+    fftwf_execute_dft_r2c(m_floatPlan->plan,m_floatIn,(fftwf_complex*)m_floatOut);
+  }
+
+  bool FFT::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  {
+    OutputBuffer* out = outp[0].data;
+    if (out->sampleType()!=FLOAT_SAMPLES)
+      return StateLessOneInOneOutComponent<FFT>::process(inp,outp);
+    // single precision spectrum written as is to the output stream
+    InputBuffer* in = inp[0].data;
+    if (in->empty()) return false;
+    const int N = in->info().size;
+    const int P = out->info().size;
+    while (!in->empty()) {
+      transformFloat(in->readToken(),N);
+      memcpy(out->writeToken<float>(),m_floatOut,P*sizeof(float));
+      in->consumeToken();
+    }
+    return true;
+  }
+#endif
+
   void FFT::processToken(double* inPtr, const int N, double* out, const int outSize)
   {
+#ifdef WITH_FFTW3F
+    if (!m_floatPlan.isNull())
+    {
+      transformFloat(inPtr,N);
+      Map<VectorXd>(out,outSize) = Map<VectorXf>((float*) m_floatOut,outSize).cast<double>();
+      return;
+    }
+#endif
 #ifdef WITH_FFTW3
-    double* inFFT = (double*) fftw_malloc(m_nfft*sizeof(double));
-    complex<double>* outFFT = (complex<double>*) fftw_malloc((m_nfft/2+1)*sizeof(complex<double>));
-    Map<VectorXd> infft(inFFT,m_nfft);
+    Map<VectorXd> infft(m_fftIn,m_nfft);
 #else
     VectorXd infft(m_nfft);
 #endif
@@ -123,10 +245,8 @@ namespace YAAFE
     if (N<m_nfft)
       infft.segment(N,m_nfft-N).setZero();
 #ifdef WITH_FFTW3
-    fftw_execute_dft_r2c(m_plan,inFFT,(fftw_complex*)outFFT);
-    memcpy(out,outFFT,outSize*sizeof(double));
-    fftw_free(inFFT);
-    fftw_free(outFFT);
+    fftw_execute_dft_r2c(m_plan->plan,m_fftIn,(fftw_complex*)m_fftOut);
+    memcpy(out,m_fftOut,outSize*sizeof(double));
 #else
     m_plan.fwd((std::complex<double>*) out,infft.data(),m_nfft);
 #endif
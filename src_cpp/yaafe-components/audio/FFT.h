@@ -26,9 +26,11 @@
 #define FFT_H_
 
 #include "yaafe-core/ComponentHelpers.h"
+#include "yaafe-core/SharedPtr.h"
 #include <Eigen/Dense>
 #ifdef WITH_FFTW3
 #include <fftw3.h>
+#include "MathUtils.h"
 #else
 #include <unsupported/Eigen/FFT>
 #endif
@@ -42,6 +44,9 @@ namespace YAAFE
   {
    public:
      FFT();
+#ifdef WITH_FFTW3
+     FFT(const FFT& other);
+#endif
      virtual ~FFT();
 
      const std::string getIdentifier() const { return FFT_ID; };
@@ -50,12 +55,48 @@ namespace YAAFE
 
      StreamInfo init(const ParameterMap& params, const StreamInfo& in);
      void processToken(double* inData, const int inSize, double* out, const int outSize);
+#ifdef WITH_FFTW3F
+     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+     virtual bool canWriteFloat(int port) const { return !m_floatPlan.isNull(); }
+#endif
+
+     virtual Component* copy() const { return new FFT(*this); }
 
    private:
      Eigen::VectorXd m_window;
      int m_nfft;
 #ifdef WITH_FFTW3
-     fftw_plan m_plan;
+     class Plan {
+      public:
+        Plan(fftw_plan p) : plan(p) {}
+        ~Plan() {
+          MutexLock lock(fftwPlannerMutex);
+          fftw_destroy_plan(plan);
+        }
+        fftw_plan plan;
+     };
+     SharedPtr<Plan> m_plan;
+     double* m_fftIn;
+     std::complex<double>* m_fftOut;
+#ifdef WITH_FFTW3F
+     class FloatPlan {
+      public:
+        FloatPlan(fftwf_plan p) : plan(p) {}
+        ~FloatPlan() {
+          MutexLock lock(fftwPlannerMutex);
+          fftwf_destroy_plan(plan);
+        }
+        fftwf_plan plan;
+     };
+     // set when the single precision kernel is used
+     SharedPtr<FloatPlan> m_floatPlan;
+     Eigen::VectorXf m_floatWindow;
+     float* m_floatIn;
+     std::complex<float>* m_floatOut;
+     void transformFloat(const double* inData, const int N);
+#endif
+     void allocFFTBuffers();
+     void freeFFTBuffers();
 #else
      Eigen::FFT<double> m_plan;
 #endif
@@ -30,8 +30,7 @@ using namespace std;
 namespace YAAFE
 {
 
-  HistogramIntegrator::HistogramIntegrator() :
-    m_nbFrames(0)
+  HistogramIntegrator::HistogramIntegrator()
   {
   }
 
@@ -77,22 +76,8 @@ namespace YAAFE
     return pList;
   }
 
-  bool HistogramIntegrator::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  bool HistogramIntegrator::initIntegrator(const ParameterMap& params, const StreamInfo& in, StreamInfo& out)
   {
-    assert(inp.size()==1);
-    const StreamInfo& in = inp[0].data;
-
-    m_nbFrames = getIntParam("NbFrames",params);
-    if (m_nbFrames<=0) {
-      cerr << "ERROR: Invalid NbFrames parameter !" << endl;
-      return false;
-    }
-    m_stepNbFrames = getIntParam("StepNbFrames",params);
-    if (m_stepNbFrames<=0) {
-      cerr << "ERROR: Invalid stepNbFrames parameter !" << endl;
-      return false;
-    }
-
     m_hinf = getDoubleParam("HInf",params);
     m_hsup = getDoubleParam("HSup",params);
     m_nbbins = getIntParam("HNbBins",params);
@@ -101,38 +86,48 @@ namespace YAAFE
 
     assert(!m_weigthed || ((in.size%2)==0));
 
-    StreamInfo out;
     out.size = m_nbbins;
-    out.sampleRate = in.sampleRate;
-    out.frameLength = in.frameLength + (m_nbFrames-1)*in.sampleStep;
-    out.sampleStep = m_stepNbFrames*in.sampleStep;
-    outStreamInfo().add(out);
-
+    m_counts.assign(m_nbbins,0.0);
     return true;
   }
 
-  bool HistogramIntegrator::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  inline int HistogramIntegrator::bin(double v) const
   {
-    assert(inp.size()==1);
-    InputBuffer* in = inp[0].data;
-    assert(outp.size()==1);
-    OutputBuffer* out = outp[0].data;
+    int b = (int)floor((v - m_hinf) / m_hstep);
+    return (b<m_nbbins) ? b : m_nbbins-1;
+  }
 
-    if ((out->tokenno()==0) && (in->tokenno()!=-m_nbFrames/2))
-    {
-      in->prependZeros(m_nbFrames/2);
-    }
-    if (!in->hasTokens(m_nbFrames)) return false;
+  void HistogramIntegrator::resetWindow()
+  {
+    m_counts.assign(m_nbbins,0.0);
+  }
 
-    double* inData = new double[in->info().size*m_nbFrames];
-    while (in->hasTokens(m_nbFrames))
-    {
-      in->read(inData,m_nbFrames);
-      computeHistogram(inData,m_nbFrames*in->info().size,out->writeToken());
-      in->consumeTokens(m_stepNbFrames);
-    }
-    delete [] inData;
-    return true;
+  void HistogramIntegrator::addFrame(const double* frame, int pos)
+  {
+    // weighted histograms are computed from the whole window, so that
+    // rounding errors do not accumulate
+    if (m_weigthed)
+      return;
+    for (int i=0;i<m_size;i++)
+      if (frame[i]>=m_hinf && frame[i]<m_hsup)
+        m_counts[bin(frame[i])] += 1;
+  }
+
+  void HistogramIntegrator::removeFrame(const double* frame, int pos)
+  {
+    if (m_weigthed)
+      return;
+    for (int i=0;i<m_size;i++)
+      if (frame[i]>=m_hinf && frame[i]<m_hsup)
+        m_counts[bin(frame[i])] -= 1;
+  }
+
+  void HistogramIntegrator::emit(const double* window, double* out)
+  {
+    if (m_weigthed)
+      computeHistogram(window,m_nbFrames*m_size,out);
+    else
+      memcpy(out,&m_counts[0],m_nbbins*sizeof(double));
   }
 
   void HistogramIntegrator::computeHistogram(const double* inData, int inSize, double* outData)
@@ -142,21 +137,11 @@ namespace YAAFE
 
     const double* inPtr = inData;
     const double* inPtrEnd = inData + inSize;
-    for (;inPtr!=inPtrEnd;inPtr++)
+    for (;inPtr!=inPtrEnd;inPtr+=2)
     {
       if (*inPtr>=m_hinf && *inPtr<m_hsup)
-      {
-        outData[(int)floor((inPtr[0] - m_hinf) / m_hstep)] += (m_weigthed ? inPtr[1] : 1);
-      }
-      if (m_weigthed)
-        inPtr++;
+        outData[bin(inPtr[0])] += inPtr[1];
     }
   }
 
-  void HistogramIntegrator::flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out)
-  {
-    in[0].data->appendZeros((m_nbFrames-1)/2);
-    process(in,out);
-  }
-
 }
@@ -25,14 +25,15 @@
 #ifndef HISTOGRAMINTEGRATOR_H_
 #define HISTOGRAMINTEGRATOR_H_
 
-#include "yaafe-core/Component.h"
+#include "yaafe-core/ComponentHelpers.h"
+#include <vector>
 
 #define HISTOGRAMINTEGRATOR_ID "HistogramIntegrator"
 
 namespace YAAFE
 {
 
-  class HistogramIntegrator: public YAAFE::ComponentBase<HistogramIntegrator>
+  class HistogramIntegrator: public YAAFE::WindowedIntegrator<HistogramIntegrator>
   {
    public:
      HistogramIntegrator();
@@ -42,20 +43,24 @@ namespace YAAFE
 
      virtual ParameterDescriptorList getParameterDescriptorList() const;
 
-     virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
-     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
-     virtual void flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+     void resetWindow();
+     void addFrame(const double* frame, int pos);
+     void removeFrame(const double* frame, int pos);
+     void emit(const double* window, double* out);
 
-   private:
-     int m_nbFrames;
-     int m_stepNbFrames;
+   protected:
+     virtual bool initIntegrator(const ParameterMap& params, const StreamInfo& in, StreamInfo& out);
 
+   private:
      double m_hinf;
      double m_hsup;
      double m_hstep;
      int m_nbbins;
      bool m_weigthed;
+     // counts of the current window, for unweighted histograms
+     std::vector<double> m_counts;
 
+     inline int bin(double v) const;
      void computeHistogram(const double* inData, int inSize, double* outData);
 
   };
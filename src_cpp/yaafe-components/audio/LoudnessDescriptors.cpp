@@ -0,0 +1,161 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LoudnessDescriptors.h"
+#include "LoudnessSharpness.h"
+#include <iostream>
+
+using namespace std;
+using namespace Eigen;
+
+namespace YAAFE
+{
+
+  const char* LoudnessDescriptors::s_descriptorNames[] = { "Total", "Sharpness", "Spread", "Specific" };
+
+  LoudnessDescriptors::LoudnessDescriptors() : m_powMode(SpecificLoudness::EXACT_POW)
+  {
+  }
+
+  LoudnessDescriptors::~LoudnessDescriptors()
+  {
+  }
+
+  ParameterDescriptorList LoudnessDescriptors::getParameterDescriptorList() const
+  {
+    ParameterDescriptorList pList;
+    ParameterDescriptor p;
+
+    p.m_identifier = "LDescriptors";
+    p.m_description = "Comma separated list of descriptors to output, within Total, Sharpness, Spread and Specific (band loudness, as Loudness). With several descriptors, each one is output on its own port named after it.";
+    p.m_defaultValue = "Total,Sharpness,Spread";
+    pList.push_back(p);
+
+    p.m_identifier = "LPowTolerance";
+    p.m_description = "Relative error allowed on band loudness. 0 computes the exact power, a tolerance of at least 1e-12 allows a vectorized power, at least 1e-5 a faster single precision power.";
+    p.m_defaultValue = "0";
+    pList.push_back(p);
+
+    return pList;
+  }
+
+  bool LoudnessDescriptors::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  {
+    assert(inp.size()==1);
+    const StreamInfo& in = inp[0].data;
+
+    m_descriptors.clear();
+    string descr = getStringParam("LDescriptors",params);
+    while (descr.size()>0)
+    {
+      size_t idx = descr.find(',');
+      if (idx==string::npos)
+        idx = descr.size();
+      string d = descr.substr(0,idx);
+      int i = TOTAL;
+      while (i<=SPECIFIC && d!=s_descriptorNames[i])
+        i++;
+      if (i>SPECIFIC) {
+        cerr << "ERROR: unknown loudness descriptor " << d << endl;
+        return false;
+      }
+      m_descriptors.push_back((Descriptor) i);
+      if (idx==descr.size())
+        break;
+      descr = descr.substr(idx+1);
+    }
+    if (m_descriptors.size()==0) {
+      cerr << "ERROR: no loudness descriptor requested" << endl;
+      return false;
+    }
+
+    SpecificLoudness::barkBandLimits(in,m_bkBdLimits);
+    if (!SpecificLoudness::initPowMode(getDoubleParam("LPowTolerance",params),m_powMode))
+      return false;
+    LoudnessSharpness::sharpnessCoeffs(m_coeffs);
+
+    for (size_t i=0;i<m_descriptors.size();i++)
+    {
+      StreamInfo info(in,(m_descriptors[i]==SPECIFIC) ? NB_BARK_BANDS : 1);
+      if (m_descriptors.size()==1)
+        outStreamInfo().add(info);
+      else
+        outStreamInfo().add(s_descriptorNames[m_descriptors[i]],info);
+    }
+    return true;
+  }
+
+  bool LoudnessDescriptors::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  {
+    assert(inp.size()==1);
+    InputBuffer* in = inp[0].data;
+    if (in->empty()) return false;
+    assert(outp.size()==m_descriptors.size());
+
+    const int N = in->info().size;
+    const int nbDescr = m_descriptors.size();
+    while (!in->empty())
+    {
+      const int nbTokens = in->blockAvailableTokens();
+      Map<MatrixXd> inData(in->readToken(),N,nbTokens);
+      if (m_sums.cols()<nbTokens)
+        m_sums.resize(NB_BARK_BANDS,nbTokens);
+      SpecificLoudness::bandSums(inData,m_bkBdLimits,m_sums);
+      SpecificLoudness::bandLoudness(m_sums,nbTokens,m_powMode,m_outliers);
+      for (int d=0;d<nbDescr;d++)
+        if (m_descriptors[d]==SPECIFIC)
+          outp[d].data->write(m_sums.data(),nbTokens);
+      for (int t=0;t<nbTokens;t++)
+      {
+        // same operations as Loudness > Sum and Loudness > Normalize
+        const double total = m_sums.col(t).sum();
+        m_sums.col(t) /= total;
+        for (int d=0;d<nbDescr;d++)
+        {
+          if (m_descriptors[d]==SPECIFIC)
+            continue; // written for the whole block
+          double* outData = outp[d].data->writeToken();
+          switch (m_descriptors[d]) {
+            case TOTAL:
+              *outData = total;
+              break;
+            case SHARPNESS:
+              *outData = m_coeffs * m_sums.col(t).matrix();
+              break;
+            case SPREAD:
+              *outData = 1 - m_sums.col(t).maxCoeff();
+              *outData *= *outData;
+              break;
+            default:
+              break;
+          }
+        }
+      }
+      in->consumeTokens(nbTokens);
+    }
+
+    return true;
+  }
+
+}
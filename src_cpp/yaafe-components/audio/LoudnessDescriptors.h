@@ -0,0 +1,66 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOUDNESSDESCRIPTORS_H_
+#define LOUDNESSDESCRIPTORS_H_
+
+#include "yaafe-core/Component.h"
+#include "SpecificLoudness.h"
+#include <Eigen/Dense>
+#include <vector>
+
+#define LOUDNESS_DESCRIPTORS_ID "LoudnessDescriptors"
+
+namespace YAAFE
+{
+
+  class LoudnessDescriptors: public YAAFE::ComponentBase<LoudnessDescriptors>
+  {
+   public:
+     LoudnessDescriptors();
+     virtual ~LoudnessDescriptors();
+
+     virtual const std::string getIdentifier() const { return LOUDNESS_DESCRIPTORS_ID;};
+     virtual const std::string getDescription() const { return "Specific loudness, total loudness, perceptual sharpness and perceptual spread computed in a single pass over the power spectrum."; }
+
+     virtual ParameterDescriptorList getParameterDescriptorList() const;
+
+     virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
+     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+
+   private:
+     enum Descriptor { TOTAL, SHARPNESS, SPREAD, SPECIFIC };
+     static const char* s_descriptorNames[];
+
+     int m_bkBdLimits[NB_BARK_BANDS+1];
+     SpecificLoudness::PowMode m_powMode;
+     std::vector<Descriptor> m_descriptors;
+     Eigen::RowVectorXd m_coeffs;
+     Eigen::ArrayXXd m_sums;
+     SpecificLoudness::Outliers m_outliers;
+  };
+
+}
+
+#endif /* LOUDNESSDESCRIPTORS_H_ */
@@ -39,6 +39,18 @@ namespace YAAFE
   {
   }
 
+  void LoudnessSharpness::sharpnessCoeffs(RowVectorXd& coeffs)
+  {
+    coeffs.resize(NB_BARK_BANDS);
+    for (int i = 0; i < NB_BARK_BANDS; i++)
+    {
+      if (i < 14)
+        coeffs(i) = 0.11 * (i + 1);
+      else
+        coeffs(i) = 0.11 * (i + 1) * 0.066 * exp(0.171 * (i + 1));
+    }
+  }
+
   bool LoudnessSharpness::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
   {
     assert(inp.size()==1);
@@ -52,14 +64,7 @@ namespace YAAFE
       return false;
     }
 
-    m_coeffs.resize(NB_BARK_BANDS);
-    for (int i = 0; i < NB_BARK_BANDS; i++)
-    {
-      if (i < 14)
-        m_coeffs(i) = 0.11 * (i + 1);
-      else
-        m_coeffs(i) = 0.11 * (i + 1) * 0.066 * exp(0.171 * (i + 1));
-    }
+    sharpnessCoeffs(m_coeffs);
 
     outStreamInfo().add(StreamInfo(in,1));
     return true;
@@ -44,6 +44,11 @@ namespace YAAFE
      virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
      virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
 
+     /**
+      * Compute the NB_BARK_BANDS sharpness weights.
+      */
+     static void sharpnessCoeffs(Eigen::RowVectorXd& coeffs);
+
    private:
      Eigen::RowVectorXd m_coeffs;
   };
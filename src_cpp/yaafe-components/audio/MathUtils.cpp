@@ -35,6 +35,44 @@ using namespace Eigen;
 namespace YAAFE
 {
 
+#ifdef WITH_FFTW3
+  Mutex fftwPlannerMutex;
+
+  FFTWPlan* FFTWPlan::r2c(int n)
+  {
+    double* in = (double*) fftw_malloc(n*sizeof(double));
+    fftw_complex* out = (fftw_complex*) fftw_malloc((n/2+1)*sizeof(fftw_complex));
+    fftw_plan p;
+    {
+      MutexLock lock(fftwPlannerMutex);
+      p = fftw_plan_dft_r2c_1d(n,in,out,FFTW_MEASURE);
+    }
+    fftw_free(in);
+    fftw_free(out);
+    return new FFTWPlan(p);
+  }
+
+  FFTWPlan* FFTWPlan::c2r(int n)
+  {
+    fftw_complex* in = (fftw_complex*) fftw_malloc((n/2+1)*sizeof(fftw_complex));
+    double* out = (double*) fftw_malloc(n*sizeof(double));
+    fftw_plan p;
+    {
+      MutexLock lock(fftwPlannerMutex);
+      p = fftw_plan_dft_c2r_1d(n,in,out,FFTW_MEASURE);
+    }
+    fftw_free(in);
+    fftw_free(out);
+    return new FFTWPlan(p);
+  }
+
+  FFTWPlan::~FFTWPlan()
+  {
+    MutexLock lock(fftwPlannerMutex);
+    fftw_destroy_plan(plan);
+  }
+#endif
+
   int nextpow2(int v) 
   {
     int p2 = 1;
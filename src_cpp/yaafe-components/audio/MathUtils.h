@@ -26,6 +26,10 @@
 #define MATHUTILS_H_
 
 #include <Eigen/Dense>
+#ifdef WITH_FFTW3
+#include "yaafe-core/Thread.h"
+#include <fftw3.h>
+#endif
 
 #define PI 3.14159265358979323846
 #define EPS 2.220446049250313e-16
@@ -49,6 +53,36 @@ namespace YAAFE {
    */
   void ac2lpc(const double* ac, double* lpc, int nbCoeffs);
 
+#ifdef WITH_FFTW3
+  /**
+   * FFTW planner is not thread safe: FFTW plans must be created and
+   * destroyed with this mutex locked.
+   */
+  extern Mutex fftwPlannerMutex;
+
+  /**
+   * FFTW plan of a real transform of size n, created and destroyed with
+   * fftwPlannerMutex locked. Plans are made on arrays allocated with
+   * fftw_malloc, and must be executed with fftw_execute_dft_r2c or
+   * fftw_execute_dft_c2r on such arrays. The c2r transform is not
+   * normalized, and overwrites its input.
+   */
+  class FFTWPlan
+  {
+   public:
+     static FFTWPlan* r2c(int n);
+     static FFTWPlan* c2r(int n);
+     ~FFTWPlan();
+
+     fftw_plan plan;
+
+   private:
+     explicit FFTWPlan(fftw_plan p) : plan(p) {}
+     FFTWPlan(const FFTWPlan&);
+     FFTWPlan& operator=(const FFTWPlan&);
+  };
+#endif
+
 
 #ifdef WITH_LAPACK
   /**
@@ -0,0 +1,280 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MultiOctaveCQT.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+namespace YAAFE
+{
+
+  static std::string numberString(double v)
+  {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.17g", v);
+    return buf;
+  }
+
+  MultiOctaveCQT::MultiOctaveCQT() :
+    m_nbBins(0), m_fftLen(0), m_stepSize(0), m_sampleRate(0), m_nbDecim(0)
+  {
+  }
+
+  MultiOctaveCQT::~MultiOctaveCQT()
+  {
+  }
+
+  ParameterDescriptorList MultiOctaveCQT::getParameterDescriptorList() const
+  {
+    ParameterDescriptorList pList;
+    ParameterDescriptor p;
+
+    p.m_identifier = "CQTMinFreq";
+    p.m_description = "Minimal frequency of the lowest octave, in Hertz.";
+    p.m_defaultValue = "73.42";
+    pList.push_back(p);
+
+    p.m_identifier = "CQTBinsPerOctave";
+    p.m_description = "Number of bins per octave to consider";
+    p.m_defaultValue = "36";
+    pList.push_back(p);
+
+    p.m_identifier = "CQTAlign";
+    p.m_description = "Alignment of cqt kernels on analysis frame. 'l' to the left, 'c' to the center, 'r' to the right";
+    p.m_defaultValue = "c";
+    pList.push_back(p);
+
+    p.m_identifier = "CQTNbOctaves";
+    p.m_description = "Number of octaves to consider for analysis";
+    p.m_defaultValue = "3";
+    pList.push_back(p);
+
+    p.m_identifier = "stepSize";
+    p.m_description = "Step between consecutive frames, in number of samples at outSampleRate";
+    p.m_defaultValue = "512";
+    pList.push_back(p);
+
+    p.m_identifier = "outSampleRate";
+    p.m_description = "Output sample rate, 0 means input sample rate. Used when input signal has already been decimated.";
+    p.m_defaultValue = "0";
+    pList.push_back(p);
+
+#ifdef WITH_FFTW3F
+    pList.push_back(kernelPrecisionParameter());
+#endif
+
+    return pList;
+  }
+
+  bool MultiOctaveCQT::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  {
+    assert(inp.size()==1);
+    const StreamInfo& in = inp[0].data;
+    if (in.size>1) {
+      cerr << "ERROR: input of MultiOctaveCQT should be of size 1" << endl;
+      return false;
+    }
+
+    m_sampleRate = getDoubleParam("outSampleRate",params);
+    if (m_sampleRate<=0)
+      m_sampleRate = in.sampleRate;
+    m_stepSize = getIntParam("stepSize",params);
+    int nbOct = getIntParam("CQTNbOctaves",params);
+    int bins = getIntParam("CQTBinsPerOctave",params);
+    if (nbOct<1 || bins<1) {
+      cerr << "ERROR: invalid CQTNbOctaves or CQTBinsPerOctave parameter for MultiOctaveCQT" << endl;
+      return false;
+    }
+
+    // decimate until first octave to analyse
+    double minFreq = getDoubleParam("CQTMinFreq",params) * pow(2.0, nbOct - 1);
+    double sampleRate = in.sampleRate;
+    m_nbDecim = 0;
+    while (0.95 * sampleRate / 8 > minFreq) {
+      sampleRate = sampleRate / 2;
+      m_nbDecim++;
+    }
+    double Q = 2 / (pow(2.0, 1.0 / bins) - 1);
+    m_fftLen = (int) pow(2.0, ceil(log2(Q * (sampleRate / minFreq))));
+
+    // decimation stages, the lowest octave is decimated nbDecim+nbOct-1 times
+    StreamInfo signalInfo = in;
+    m_decimators.clear();
+    m_decimators.resize(m_nbDecim + nbOct - 1);
+    for (size_t d=0;d<m_decimators.size();d++) {
+      m_decimators[d].init(ParameterMap(), Ports<StreamInfo>(signalInfo));
+      signalInfo = m_decimators[d].getOutStreamInfo()[0].data;
+    }
+    m_decimated.resize(m_decimators.size());
+    m_octaves.resize(nbOct);
+    for (int o=0;o<nbOct;o++)
+      m_octaves[o].sampleRate = in.sampleRate / pow(2.0, m_nbDecim + o);
+
+    // all octaves share the same FFT plan and the same CQT kernel
+    StreamInfo framesInfo;
+    framesInfo.frameLength = (int) floor(signalInfo.frameLength*m_fftLen*m_sampleRate/signalInfo.sampleRate + 0.5);
+    framesInfo.sampleRate = m_sampleRate;
+    framesInfo.sampleStep = m_stepSize;
+    framesInfo.size = m_fftLen;
+    ParameterMap fftParams;
+    fftParams["FFTLength"] = numberString(m_fftLen);
+    fftParams["FFTWindow"] = "None";
+#ifdef WITH_FFTW3F
+    fftParams[KERNEL_PRECISION_PARAM] = getStringParam(KERNEL_PRECISION_PARAM,params);
+#endif
+    StreamInfo spectrumInfo = m_fft.init(fftParams, framesInfo);
+    m_spectrum.resize(spectrumInfo.size);
+
+    ParameterMap cqtParams;
+    cqtParams["CQTBinsPerOctave"] = numberString(bins);
+    cqtParams["CQTAlign"] = getStringParam("CQTAlign",params);
+    cqtParams["CQTMinFreq"] = numberString(minFreq / sampleRate);
+    cqtParams["CQTMaxFreq"] = numberString(2 * minFreq / sampleRate - 1e-14);
+    StreamInfo out = m_cqt.init(cqtParams, spectrumInfo);
+    if (out.size<1)
+      return false;
+    m_nbBins = out.size;
+
+    out.size = m_nbBins * nbOct;
+    outStreamInfo().add(out);
+    return true;
+  }
+
+  void MultiOctaveCQT::reset()
+  {
+    for (size_t d=0;d<m_decimators.size();d++)
+      m_decimators[d].reset();
+    for (size_t o=0;o<m_octaves.size();o++) {
+      Octave& oct = m_octaves[o];
+      oct.signal.assign(m_fftLen/2, 0.0);
+      oct.start = -m_fftLen/2;
+      oct.nbFrames = 0;
+      oct.cqt.clear();
+    }
+  }
+
+  void MultiOctaveCQT::analyse(int level, const double* data, int nbSamples)
+  {
+    while (nbSamples>0) {
+      if (level>=m_nbDecim) {
+        Octave& oct = m_octaves[level-m_nbDecim];
+        oct.signal.insert(oct.signal.end(), data, data+nbSamples);
+        analyseFrames(oct);
+      }
+      if (level==(int)m_decimators.size())
+        return;
+      vector<double>& decimated = m_decimated[level];
+      decimated.clear();
+      m_decimators[level].decimate(data, nbSamples, decimated);
+      nbSamples = decimated.size();
+      data = nbSamples ? &decimated[0] : NULL;
+      level++;
+    }
+  }
+
+  void MultiOctaveCQT::analyseFrames(Octave& oct)
+  {
+    while (true) {
+      int frameStart = (int) floor(oct.nbFrames * m_stepSize * oct.sampleRate / m_sampleRate + 0.5) - m_fftLen/2;
+      int offset = frameStart - oct.start;
+      if (offset + m_fftLen > (int) oct.signal.size()) {
+        // drop samples before next frame
+        int drop = min(offset, (int) oct.signal.size());
+        oct.signal.erase(oct.signal.begin(), oct.signal.begin()+drop);
+        oct.start += drop;
+        return;
+      }
+      m_fft.processToken(&oct.signal[offset], m_fftLen, &m_spectrum[0], m_spectrum.size());
+      size_t pos = oct.cqt.size();
+      oct.cqt.resize(pos + m_nbBins);
+      m_cqt.processToken(&m_spectrum[0], m_spectrum.size(), &oct.cqt[pos], m_nbBins);
+      oct.nbFrames++;
+    }
+  }
+
+  void MultiOctaveCQT::write(OutputBuffer* out)
+  {
+    size_t nbTokens = m_octaves[0].cqt.size();
+    for (size_t o=1;o<m_octaves.size();o++)
+      nbTokens = min(nbTokens, m_octaves[o].cqt.size());
+    nbTokens /= m_nbBins;
+    if (nbTokens==0)
+      return;
+    for (size_t t=0;t<nbTokens;t++) {
+      double* outData = out->writeToken();
+      for (int o=m_octaves.size()-1;o>=0;o--) {
+        memcpy(outData, &m_octaves[o].cqt[t*m_nbBins], m_nbBins*sizeof(double));
+        outData += m_nbBins;
+      }
+    }
+    for (size_t o=0;o<m_octaves.size();o++) {
+      vector<double>& cqt = m_octaves[o].cqt;
+      cqt.erase(cqt.begin(), cqt.begin() + nbTokens*m_nbBins);
+    }
+  }
+
+  bool MultiOctaveCQT::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  {
+    assert(inp.size()==1);
+    InputBuffer* in = inp[0].data;
+    if (in->empty())
+      return false;
+    assert(outp.size()==1);
+    OutputBuffer* out = outp[0].data;
+
+    while (!in->empty()) {
+      int nbSamples = in->blockAvailableTokens();
+      analyse(0, in->readToken(), nbSamples);
+      in->consumeTokens(nbSamples);
+    }
+    write(out);
+    return true;
+  }
+
+  void MultiOctaveCQT::flush(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  {
+    process(inp,outp);
+    // flush decimations, from the highest sample rate to the lowest
+    for (size_t d=0;d<m_decimators.size();d++) {
+      vector<double>& decimated = m_decimated[d];
+      decimated.clear();
+      m_decimators[d].decimateFlush(decimated);
+      if (!decimated.empty())
+        analyse(d+1, &decimated[0], decimated.size());
+    }
+    // analyse last frames of each octave
+    for (size_t o=0;o<m_octaves.size();o++) {
+      Octave& oct = m_octaves[o];
+      oct.signal.insert(oct.signal.end(), (m_fftLen-1)/2, 0.0);
+      analyseFrames(oct);
+    }
+    write(outp[0].data);
+  }
+
+}
@@ -0,0 +1,95 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MULTIOCTAVECQT_H_
+#define MULTIOCTAVECQT_H_
+
+#include "yaafe-core/Component.h"
+#include "CQT.h"
+#include "Decimate2.h"
+#include "FFT.h"
+#include <vector>
+
+#define MULTIOCTAVECQT_ID "MultiOctaveCQT"
+
+namespace YAAFE
+{
+
+  /**
+   * Constant-Q transform of an audio signal over several octaves. The signal
+   * is decimated by 2 for each octave, and each octave is analysed with the
+   * same normalized CQT kernel. Frames of all octaves are aligned on the
+   * input signal. Output bins go from the lowest octave to the highest one.
+   *
+   * The signal is first decimated until the highest octave is reached. When
+   * this is done by Decimate2 nodes (which can be shared between features),
+   * outSampleRate must be set to the sample rate before decimation.
+   */
+  class MultiOctaveCQT: public YAAFE::ComponentBase<MultiOctaveCQT>
+  {
+   public:
+     MultiOctaveCQT();
+     virtual ~MultiOctaveCQT();
+
+     virtual const std::string getIdentifier() const { return MULTIOCTAVECQT_ID;};
+     virtual const std::string getDescription() const { return "Constant-Q transform over several octaves, using successive decimations of the signal."; }
+
+     virtual ParameterDescriptorList getParameterDescriptorList() const;
+
+     virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
+     virtual void reset();
+     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+     virtual void flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+
+     virtual Component* copy() const { return new MultiOctaveCQT(*this); }
+
+   private:
+     struct Octave {
+       double sampleRate;
+       std::vector<double> signal; // octave signal, from sample start
+       int start;
+       int nbFrames; // number of analysed frames
+       std::vector<double> cqt; // analysed frames not written yet
+     };
+
+     int m_nbBins;
+     int m_fftLen;
+     int m_stepSize;
+     double m_sampleRate;
+     int m_nbDecim; // number of decimations before the highest octave
+     FFT m_fft;
+     CQT m_cqt;
+     std::vector<Decimate2> m_decimators;
+     std::vector<Octave> m_octaves; // from highest to lowest octave
+     std::vector<std::vector<double> > m_decimated;
+     std::vector<double> m_spectrum;
+
+     void analyse(int level, const double* data, int nbSamples);
+     void analyseFrames(Octave& oct);
+     void write(OutputBuffer* out);
+  };
+
+}
+
+#endif /* MULTIOCTAVECQT_H_ */
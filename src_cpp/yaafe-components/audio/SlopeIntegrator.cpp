@@ -23,15 +23,15 @@
  */
 
 #include "SlopeIntegrator.h"
+#include <cmath>
 
-using namespace Eigen;
 using namespace std;
 
 namespace YAAFE
 {
 
   SlopeIntegrator::SlopeIntegrator() :
-    m_nbFrames(0)
+    m_nbEmitted(0)
   {
   }
 
@@ -57,79 +57,96 @@ namespace YAAFE
     return pList;
   }
 
-  bool SlopeIntegrator::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  bool SlopeIntegrator::initIntegrator(const ParameterMap& params, const StreamInfo& in, StreamInfo& out)
   {
-    assert(inp.size()==1);
-    const StreamInfo& in = inp[0].data;
-
-    m_nbFrames = getIntParam("NbFrames",params);
-    if (m_nbFrames<=0) {
-      cerr << "ERROR: Invalid NbFrames parameter !" << endl;
-      return false;
-    }
-    m_stepNbFrames = getIntParam("StepNbFrames",params);
-    if (m_stepNbFrames<=0) {
-      cerr << "ERROR: Invalid stepNbFrames parameter !" << endl;
-      return false;
-    }
-
-    m_slopeCoeffs = VectorXd::LinSpaced(m_nbFrames,0,m_nbFrames-1);
-    m_slopeCoeffs.array() -= m_slopeCoeffs.mean();
-    m_slopeNorm = m_slopeCoeffs.squaredNorm();
-
-    StreamInfo out;
     out.size = in.size;
-    out.sampleRate = in.sampleRate;
-    out.frameLength =  in.frameLength + (m_nbFrames - 1) * in.sampleStep;
-    out.sampleStep = m_stepNbFrames * in.sampleStep;
-    outStreamInfo().add(out);
-
+    resetWindow();
     return true;
   }
 
-  bool SlopeIntegrator::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  void SlopeIntegrator::resetWindow()
   {
-    assert(inp.size()==1);
-    InputBuffer* in = inp[0].data;
-    assert(outp.size()==1);
-    OutputBuffer* out = outp[0].data;
+    m_n.assign(m_size,0.0);
+    m_sx.assign(m_size,0.0);
+    m_sxx.assign(m_size,0.0);
+    m_sv.assign(m_size,0.0);
+    m_sxv.assign(m_size,0.0);
+    m_nbEmitted = 0;
+  }
 
-    if ((out->tokenno()==0) && (in->tokenno()!=-m_nbFrames/2))
-      in->prependZeros(m_nbFrames/2);
-    if (!in->hasTokens(m_nbFrames)) return false;
+  void SlopeIntegrator::addFrame(const double* frame, int pos)
+  {
+    for (int i=0;i<m_size;i++)
+    {
+      const double v = frame[i];
+      if (!std::isnan(v)) {
+        m_n[i] += 1;
+        m_sx[i] += pos;
+        m_sxx[i] += pos*pos;
+        m_sv[i] += v;
+        m_sxv[i] += pos*v;
+      }
+    }
+  }
 
-    while (in->hasTokens(m_nbFrames))
+  void SlopeIntegrator::removeFrame(const double* frame, int pos)
+  {
+    for (int i=0;i<m_size;i++)
     {
-      double* outPtr = out->writeToken();
-      for (int i = 0; i < in->info().size; i++)
-      {
-        int nbvalue = 0;
-        double sumdata = 0;
-        double sumslope = 0;
-        double sumcoeffs = 0;
-        double sumcoeffssqr = 0;
-        for (int j=0;j<m_nbFrames;j++) {
-          const double v = *(in->token(j)+i);
-          if (!std::isnan(v)) {
-            nbvalue++;
-            sumdata += v;
-            double coeff = j - (double)(m_nbFrames-1.0)/2.0;
-            sumslope += v*coeff;
-            sumcoeffs += coeff;
-            sumcoeffssqr += coeff*coeff;
-          }
-        }
-        outPtr[i] = (sumslope - sumcoeffs * sumdata) / (sumcoeffssqr - sumcoeffs*sumcoeffs/nbvalue);
+      const double v = frame[i];
+      if (!std::isnan(v)) {
+        m_n[i] -= 1;
+        m_sx[i] -= pos;
+        m_sxx[i] -= pos*pos;
+        m_sv[i] -= v;
+        m_sxv[i] -= pos*v;
       }
-      in->consumeTokens(m_stepNbFrames);
     }
-    return true;
   }
 
-  void SlopeIntegrator::flush(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  void SlopeIntegrator::advanceWindow(int shift)
   {
-    inp[0].data->appendZeros((m_nbFrames-1)/2);
-    process(inp,outp);
+    for (int i=0;i<m_size;i++)
+    {
+      m_sxx[i] += shift*(shift*m_n[i] - 2*m_sx[i]);
+      m_sx[i] -= shift*m_n[i];
+      m_sxv[i] -= shift*m_sv[i];
+    }
+  }
+
+  void SlopeIntegrator::recomputeSums(const double* window)
+  {
+    for (int i=0;i<m_size;i++)
+    {
+      m_sv[i] = 0;
+      m_sxv[i] = 0;
+    }
+    for (int j=0;j<m_nbFrames;j++,window+=m_size)
+      for (int i=0;i<m_size;i++)
+        if (!std::isnan(window[i])) {
+          m_sv[i] += window[i];
+          m_sxv[i] += j*window[i];
+        }
+  }
+
+  void SlopeIntegrator::emit(const double* window, double* out)
+  {
+    // value sums are updated incrementally, recompute them from time to
+    // time so that rounding errors do not accumulate
+    if (++m_nbEmitted==m_nbFrames) {
+      recomputeSums(window);
+      m_nbEmitted = 0;
+    }
+    // slope coefficients are positions centered on the window middle
+    const double c = (m_nbFrames-1.0)/2.0;
+    for (int i=0;i<m_size;i++)
+    {
+      const double n = m_n[i];
+      const double sumcoeffs = m_sx[i] - c*n;
+      const double sumcoeffssqr = m_sxx[i] - 2*c*m_sx[i] + c*c*n;
+      const double sumslope = m_sxv[i] - c*m_sv[i];
+      out[i] = (sumslope - sumcoeffs * m_sv[i]) / (sumcoeffssqr - sumcoeffs*sumcoeffs/n);
+    }
   }
 
 }
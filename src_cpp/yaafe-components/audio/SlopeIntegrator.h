@@ -25,15 +25,15 @@
 #ifndef SLOPEINTEGRATOR_H_
 #define SLOPEINTEGRATOR_H_
 
-#include "yaafe-core/Component.h"
-#include <Eigen/Dense>
+#include "yaafe-core/ComponentHelpers.h"
+#include <vector>
 
 #define SLOPEINTEGRATOR_ID "SlopeIntegrator"
 
 namespace YAAFE
 {
 
-  class SlopeIntegrator: public YAAFE::ComponentBase<SlopeIntegrator>
+  class SlopeIntegrator: public YAAFE::WindowedIntegrator<SlopeIntegrator>
   {
    public:
      SlopeIntegrator();
@@ -41,18 +41,27 @@ namespace YAAFE
 
      virtual const std::string getIdentifier() const { return SLOPEINTEGRATOR_ID;};
 
-     virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
-     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
-     virtual void flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+     void resetWindow();
+     void addFrame(const double* frame, int pos);
+     void removeFrame(const double* frame, int pos);
+     void advanceWindow(int shift);
+     void emit(const double* window, double* out);
 
    protected:
      virtual ParameterDescriptorList getParameterDescriptorList() const;
+     virtual bool initIntegrator(const ParameterMap& params, const StreamInfo& in, StreamInfo& out);
 
    private:
-     int m_nbFrames;
-     int m_stepNbFrames;
-     Eigen::VectorXd m_slopeCoeffs;
-     double m_slopeNorm;
+     // sums over the non-NaN values of each dimension, x being the frame
+     // position in the window and v the value
+     std::vector<double> m_n;
+     std::vector<double> m_sx;
+     std::vector<double> m_sxx;
+     std::vector<double> m_sv;
+     std::vector<double> m_sxv;
+     int m_nbEmitted;
+
+     void recomputeSums(const double* window);
   };
 
 }
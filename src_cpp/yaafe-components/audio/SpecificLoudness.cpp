@@ -24,6 +24,8 @@
 
 #include "SpecificLoudness.h"
 #include <iostream>
+#include <vector>
+#include <float.h>
 #include <Eigen/Dense>
 
 using namespace std;
@@ -32,7 +34,8 @@ using namespace Eigen;
 namespace YAAFE
 {
 
-  SpecificLoudness::SpecificLoudness() : m_blockSize(0), m_bkBdLimits(0)
+  SpecificLoudness::SpecificLoudness() :
+    m_blockSize(0), m_fftSize(0), m_bkBdLimits(0), m_powMode(EXACT_POW)
   {
   }
 
@@ -42,38 +45,107 @@ namespace YAAFE
       delete [] m_bkBdLimits;
   }
 
-  bool SpecificLoudness::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  ParameterDescriptorList SpecificLoudness::getParameterDescriptorList() const
   {
-    assert(inp.size()==1);
-    const StreamInfo& in = inp[0].data;
+    ParameterDescriptorList pList;
+    ParameterDescriptor p;
 
-    // assume in->info().size is fft size
-    // assume in->info().frameLength is frame size
-    m_blockSize = in.frameLength;
-    m_fftSize = in.size;
-    m_bkBdLimits = new int[NB_BARK_BANDS+1];
+    p.m_identifier = "LPowTolerance";
+    p.m_description = "Relative error allowed on band loudness. 0 computes the exact power, a tolerance of at least 1e-12 allows a vectorized power, at least 1e-5 a faster single precision power.";
+    p.m_defaultValue = "0";
+    pList.push_back(p);
+
+    return pList;
+  }
 
-    double tmp[m_fftSize];
-    for (int i = 0; i < m_fftSize; i++)
+  void SpecificLoudness::barkBandLimits(const StreamInfo& in, int* limits)
+  {
+    // assume in.size is fft size
+    // assume in.frameLength is frame size
+    const int fftSize = in.size;
+    double tmp[fftSize];
+    for (int i = 0; i < fftSize; i++)
     {
-      tmp[i] = i * in.sampleRate / (double) m_blockSize;
+      tmp[i] = i * in.sampleRate / (double) in.frameLength;
       tmp[i] = 13 * atan(tmp[i] / 1315.8) + 3.5 * atan(pow(
             (tmp[i] / 7518), 2));
     }
 
-    m_bkBdLimits[0] = 0;
-    double currentBandEnd = tmp[m_fftSize-1] / NB_BARK_BANDS;
+    limits[0] = 0;
+    double currentBandEnd = tmp[fftSize-1] / NB_BARK_BANDS;
     int currentBarkBand = 1;
-    for (int i = 0; i < m_fftSize; i++)
+    for (int i = 0; i < fftSize; i++)
     {
       while (tmp[i] > currentBandEnd)
       {
-        m_bkBdLimits[currentBarkBand++] = i;
-        currentBandEnd = currentBarkBand * tmp[m_fftSize-1] / NB_BARK_BANDS;
+        limits[currentBarkBand++] = i;
+        currentBandEnd = currentBarkBand * tmp[fftSize-1] / NB_BARK_BANDS;
       }
     }
     assert(currentBarkBand == NB_BARK_BANDS);
-    m_bkBdLimits[NB_BARK_BANDS] = m_fftSize-1; // ignore last coeff
+    limits[NB_BARK_BANDS] = fftSize-1; // ignore last coeff
+  }
+
+  bool SpecificLoudness::initPowMode(double tolerance, PowMode& mode)
+  {
+    if (tolerance<0) {
+      cerr << "ERROR: invalid LPowTolerance parameter " << tolerance << endl;
+      return false;
+    }
+    if (tolerance >= LOUDNESS_FLOAT_POW_TOLERANCE)
+      mode = FLOAT_POW;
+    else if (tolerance >= LOUDNESS_FAST_POW_TOLERANCE)
+      mode = FAST_POW;
+    else
+      mode = EXACT_POW;
+    return true;
+  }
+
+  void SpecificLoudness::bandSums(const Map<MatrixXd>& spectrum,
+          const int* limits, ArrayXXd& sums)
+  {
+    // bands are disjoint, so each bin is read once
+    for (int t=0;t<spectrum.cols();t++)
+      for (int i=0;i<NB_BARK_BANDS;i++)
+        sums(i,t) = spectrum.col(t).segment(limits[i],limits[i+1]-limits[i]).sum();
+  }
+
+  void SpecificLoudness::bandLoudness(ArrayXXd& sums, int nbTokens, PowMode mode,
+          Outliers& outliers)
+  {
+    // exp and log are vectorized by Eigen, pow is not
+    if (mode==FAST_POW) {
+      sums.leftCols(nbTokens) = (sums.leftCols(nbTokens).log() * LOUDNESS_EXPONENT).exp();
+    } else if (mode==FLOAT_POW) {
+      // sums outside the normal float range would lose all precision,
+      // they are computed in double
+      outliers.clear();
+      const double* data = sums.data();
+      for (int k=0;k<NB_BARK_BANDS*nbTokens;k++)
+        if (data[k]!=0 && !(data[k]>=FLT_MIN && data[k]<=FLT_MAX))
+          outliers.push_back(std::make_pair(k,data[k]));
+      sums.leftCols(nbTokens) = (sums.leftCols(nbTokens).cast<float>().log()
+          * (float) LOUDNESS_EXPONENT).exp().cast<double>();
+      for (size_t k=0;k<outliers.size();k++)
+        sums.data()[outliers[k].first] = pow(outliers[k].second,LOUDNESS_EXPONENT);
+    } else {
+      for (int t=0;t<nbTokens;t++)
+        for (int i=0;i<NB_BARK_BANDS;i++)
+          sums(i,t) = pow(sums(i,t),LOUDNESS_EXPONENT);
+    }
+  }
+
+  bool SpecificLoudness::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  {
+    assert(inp.size()==1);
+    const StreamInfo& in = inp[0].data;
+
+    m_blockSize = in.frameLength;
+    m_fftSize = in.size;
+    m_bkBdLimits = new int[NB_BARK_BANDS+1];
+    barkBandLimits(in,m_bkBdLimits);
+    if (!initPowMode(getDoubleParam("LPowTolerance",params),m_powMode))
+      return false;
 
     outStreamInfo().add(StreamInfo(in,NB_BARK_BANDS));
     return true;
@@ -88,14 +160,16 @@ namespace YAAFE
     OutputBuffer* out = outp[0].data;
 
     const int N = in->info().size;
-    const int M = out->info().size;
     while (!in->empty())
     {
-      Map<VectorXd> inData(in->readToken(),N);
-      double* outData = out->writeToken();
-      for (int i=0;i<NB_BARK_BANDS;i++)
-        outData[i] = pow(inData.segment(m_bkBdLimits[i],m_bkBdLimits[i+1]-m_bkBdLimits[i]).sum(),0.23);
-      in->consumeToken();
+      const int nbTokens = in->blockAvailableTokens();
+      Map<MatrixXd> inData(in->readToken(),N,nbTokens);
+      if (m_sums.cols()<nbTokens)
+        m_sums.resize(NB_BARK_BANDS,nbTokens);
+      bandSums(inData,m_bkBdLimits,m_sums);
+      bandLoudness(m_sums,nbTokens,m_powMode,m_outliers);
+      out->write(m_sums.data(),nbTokens);
+      in->consumeTokens(nbTokens);
     }
 
     return true;
@@ -26,9 +26,15 @@
 #define LOUDNESS_H_
 
 #include "yaafe-core/Component.h"
+#include <Eigen/Dense>
+#include <vector>
 
 #define LOUDNESS_ID "Loudness"
 #define NB_BARK_BANDS 24
+#define LOUDNESS_EXPONENT 0.23
+// smallest tolerances the vectorized exp/log powers can guarantee
+#define LOUDNESS_FAST_POW_TOLERANCE 1e-12
+#define LOUDNESS_FLOAT_POW_TOLERANCE 1e-5
 
 namespace YAAFE
 {
@@ -36,18 +42,49 @@ namespace YAAFE
   class SpecificLoudness: public YAAFE::ComponentBase<SpecificLoudness>
   {
    public:
+     enum PowMode { EXACT_POW, FAST_POW, FLOAT_POW };
+     typedef std::vector<std::pair<int,double> > Outliers;
+
      SpecificLoudness();
      virtual ~SpecificLoudness();
 
      virtual const std::string getIdentifier() const { return LOUDNESS_ID;};
 
+     virtual ParameterDescriptorList getParameterDescriptorList() const;
+
      virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
      virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
 
+     /**
+      * Compute the NB_BARK_BANDS+1 bark band limits of a power spectrum.
+      */
+     static void barkBandLimits(const StreamInfo& in, int* limits);
+     /**
+      * Choose the power evaluation allowed by the LPowTolerance parameter.
+      * Returns false if the tolerance is invalid.
+      */
+     static bool initPowMode(double tolerance, PowMode& mode);
+     /**
+      * Sum power spectrum into bark bands, for each column of spectrum.
+      * sums must have at least as many columns as spectrum.
+      */
+     static void bandSums(const Eigen::Map<Eigen::MatrixXd>& spectrum,
+             const int* limits, Eigen::ArrayXXd& sums);
+     /**
+      * Apply loudness exponent to the first nbTokens columns of band sums,
+      * with the given power evaluation. outliers is a work buffer for the
+      * FLOAT_POW evaluation, kept by the caller between calls.
+      */
+     static void bandLoudness(Eigen::ArrayXXd& sums, int nbTokens, PowMode mode,
+             Outliers& outliers);
+
    private:
      int m_blockSize;
      int m_fftSize;
      int* m_bkBdLimits;
+     PowMode m_powMode;
+     Eigen::ArrayXXd m_sums;
+     Outliers m_outliers;
   };
 
 }
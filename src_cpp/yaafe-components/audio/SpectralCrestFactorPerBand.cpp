@@ -26,8 +26,6 @@
 #include "MathUtils.h"
 #include <math.h>
 
-#define OVERLAP 0.05
-
 using namespace std;
 
 namespace YAAFE {
@@ -45,40 +43,8 @@ namespace YAAFE {
     const StreamInfo& in = inp[0].data;
     m_inSize = in.size;
 
-    double fs = in.sampleRate;
-    int blockSize = (in.size-1)*2; // assume input is spectrum
-
-    double hiedge = floor(fs/2);
-    double loedge = hiedge * pow(2,round(log2(250.0/hiedge)));
-
-    int k = 0;
-    while (true)
-    {
-      k++;
-      double f_lo_nom = loedge * pow(2,(double)(k-1)/4.0);
-      double f_hi_nom = loedge * pow(2,(double)k/4.0);
-      double f_lo = f_lo_nom * (1 - OVERLAP);
-      double f_hi = f_hi_nom * (1 + OVERLAP);
-      int i_lo = (int) round(f_lo / (fs/blockSize));
-      int i_hi = (int) round(f_hi / (fs/blockSize));
-
-      if (f_lo_nom >= hiedge) break;
-      if (f_hi > fs/2) break;
-
-      int grpsize = 1;
-      if (f_lo_nom >= 1000)
-      {
-        grpsize = (int) round(pow(2, floor(log2(f_lo_nom/500.0))));
-        i_hi = (int) round((double)(i_hi-i_lo+1)/grpsize)*grpsize + i_lo-1;
-      }
-
-      bandinfo bi;
-      bi.start = i_lo;
-      bi.end = i_hi+1;
-      bi.group = grpsize;
-      m_band.push_back(bi);
-    }
-
+    m_band.clear();
+    SpectralFlatnessPerBand::quarterOctaveBands(in,m_band);
     outStreamInfo().add(StreamInfo(in,m_band.size()));
     return true;
   }
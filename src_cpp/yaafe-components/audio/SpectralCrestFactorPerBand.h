@@ -26,6 +26,7 @@
 #define SPECTRALCRESTFACTORPERBAND_H_
 
 #include "yaafe-core/Component.h"
+#include "SpectralFlatnessPerBand.h"
 #include <vector>
 
 #define SPECTRALCRESTFACTORPERBAND_ID "SpectralCrestFactorPerBand"
@@ -45,13 +46,7 @@ namespace YAAFE {
 
    private:
      int m_inSize;
-     struct bandinfo_ {
-       int start;
-       int end;
-       int group;
-       int length() { return end-start; }
-     };
-     typedef struct bandinfo_ bandinfo;
+     typedef SpectralFlatnessPerBand::bandinfo bandinfo;
      std::vector<bandinfo> m_band; // start,end,group for each band
   };
 
@@ -0,0 +1,350 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpectralDescriptors.h"
+#include "MathUtils.h"
+#include <math.h>
+#include <iostream>
+
+using namespace std;
+using namespace Eigen;
+
+namespace YAAFE
+{
+
+  // port names, in Descriptor order
+  static const char* s_descriptorNames[] = { "ShapeStatistics", "Flatness",
+    "Rolloff", "Slope", "Decrease", "SpectralFlatnessPerBand",
+    "SpectralCrestFactorPerBand", "Variation" };
+
+  SpectralDescriptors::SpectralDescriptors() :
+    m_float(false), m_rolloffCoeff(0.0), m_sumFreqs(0.0), m_slopeNorm(0.0), m_prevNorm(0.0)
+  {
+    for (int d=0;d<NB_DESCRIPTORS;d++)
+      m_use[d] = false;
+  }
+
+  SpectralDescriptors::~SpectralDescriptors()
+  {
+  }
+
+  ParameterDescriptorList SpectralDescriptors::getParameterDescriptorList() const
+  {
+    ParameterDescriptorList pList;
+    ParameterDescriptor p;
+
+    p.m_identifier = "SDescriptors";
+    p.m_description = "Comma separated list of descriptors to output, each on the output port of the same name, within ShapeStatistics, Flatness, Rolloff, Slope, Decrease, SpectralFlatnessPerBand, SpectralCrestFactorPerBand and Variation.";
+    p.m_defaultValue = "ShapeStatistics,Flatness,Rolloff,Slope,Decrease,SpectralFlatnessPerBand,SpectralCrestFactorPerBand,Variation";
+    pList.push_back(p);
+
+    pList.push_back(kernelPrecisionParameter());
+
+    return pList;
+  }
+
+  bool SpectralDescriptors::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  {
+    assert(inp.size()==1);
+    const StreamInfo& in = inp[0].data;
+
+    m_descriptors.clear();
+    for (int d=0;d<NB_DESCRIPTORS;d++)
+      m_use[d] = false;
+    m_float = useFloatKernel(params);
+    string descr = getStringParam("SDescriptors",params);
+    while (descr.size()>0)
+    {
+      size_t idx = descr.find(',');
+      if (idx==string::npos)
+        idx = descr.size();
+      string name = descr.substr(0,idx);
+      int d = 0;
+      while (d<NB_DESCRIPTORS && name!=s_descriptorNames[d])
+        d++;
+      if (d==NB_DESCRIPTORS) {
+        cerr << "ERROR: unknown spectral descriptor " << name << endl;
+        return false;
+      }
+      if (m_use[d]) {
+        cerr << "ERROR: spectral descriptor " << name << " requested twice" << endl;
+        return false;
+      }
+      m_use[d] = true;
+      m_descriptors.push_back((Descriptor) d);
+      if (idx==descr.size())
+        break;
+      descr = descr.substr(idx+1);
+    }
+    if (m_descriptors.size()==0) {
+      cerr << "ERROR: no spectral descriptor requested" << endl;
+      return false;
+    }
+
+    const int N = in.size;
+    // same constants as Rolloff, Slope and the per band components
+    m_rolloffCoeff = in.sampleRate / (2 * (N-1));
+    m_freqs = VectorXd::LinSpaced(N,0,N-1) * (in.sampleRate) / in.frameLength;
+    m_sumFreqs = m_freqs.sum();
+    m_slopeNorm = N * m_freqs.array().square().sum() - pow2(m_freqs.sum());
+    m_index = VectorXd::LinSpaced(N,0,N-1);
+    m_invIndex = m_index.cwiseInverse();
+    m_invIndex[0] = 0;
+    m_band.clear();
+    if (m_use[FLATNESS_PER_BAND] || m_use[CREST_PER_BAND])
+      SpectralFlatnessPerBand::quarterOctaveBands(in,m_band);
+    m_bandData.resize(N);
+    m_prev = VectorXd::Zero(N);
+    m_prevNorm = 0.0;
+
+    for (size_t i=0;i<m_descriptors.size();i++)
+    {
+      int size = 1;
+      switch (m_descriptors[i]) {
+        case SHAPE:
+          size = 4;
+          break;
+        case FLATNESS_PER_BAND:
+        case CREST_PER_BAND:
+          size = m_band.size();
+          break;
+        default:
+          break;
+      }
+      outStreamInfo().add(s_descriptorNames[m_descriptors[i]],StreamInfo(in,size));
+    }
+    return true;
+  }
+
+  void SpectralDescriptors::reset()
+  {
+    // Variation compares the first frame to a frame of zeros
+    m_prev.setZero();
+    m_prevNorm = 0.0;
+  }
+
+  template<class T>
+  void SpectralDescriptors::processTokens(const T* inData, int nbTokens, int N,
+      Ports<OutputBuffer*>& outp, OutputBuffer* crestOut)
+  {
+    const int nbDescr = m_descriptors.size();
+    const double* freqs = m_freqs.data();
+    const double* index = m_index.data();
+    const double* invIndex = m_invIndex.data();
+    for (int t=0;t<nbTokens;t++,inData+=N)
+    {
+      // accumulate all sums in a single pass
+      const double first = inData[0];
+      double sumFromSecond = 0;
+      double sumDec = 0;
+      double dotFreqs = 0;
+      double sumAbs = 0;
+      double moments[4] = { 0.0,0.0,0.0,0.0 };
+      for (int i=1;i<N;i++)
+      {
+        const double x = inData[i];
+        sumFromSecond += x;
+        sumDec += (x-first) * invIndex[i];
+        dotFreqs += x * freqs[i];
+        double v = abs(x);
+        sumAbs += v;
+        v *= index[i];
+        moments[0] += v;
+        v *= index[i];
+        moments[1] += v;
+        v *= index[i];
+        moments[2] += v;
+        v *= index[i];
+        moments[3] += v;
+      }
+      const double sum = first + sumFromSecond;
+      sumAbs += abs(first);
+
+      for (int d=0;d<nbDescr;d++)
+      {
+        if (outp[d].data==crestOut)
+          continue; // written with per band flatness
+        double* output = outp[d].data->writeToken();
+        switch (m_descriptors[d]) {
+          case SHAPE:
+          {
+            double dataSum = (sumAbs==0) ? EPS : sumAbs;
+            for (int m=0;m<4;m++)
+              moments[m] /= dataSum;
+            output[0] = moments[0];
+            output[1] = sqrt(moments[1] - pow2(moments[0]));
+            if (output[1] == 0)
+              output[1] = EPS;
+            output[2] = (2 * pow3(moments[0]) - 3 * moments[0]
+                * moments[1] + moments[2]) / pow3(output[1]);
+            output[3] = (-3 * pow4(moments[0]) + 6 * moments[0]
+                * moments[1] - 4 * moments[0] * moments[2] + moments[3])
+              / pow4(output[1]) - 3;
+            break;
+          }
+          case FLATNESS:
+          {
+            double sumlog = 0;
+            for (int i=0;i<N;i++)
+              sumlog += log((double) inData[i]);
+            output[0] = exp(sumlog / N) * N / sum;
+            break;
+          }
+          case ROLLOFF:
+          {
+            double ec = sum;
+            double thres = 0.99 * ec;
+            int kc = N - 1;
+            while (ec > thres && kc >= 0)
+            {
+              ec -= inData[kc];
+              --kc;
+            }
+            output[0] = (kc+1) * m_rolloffCoeff;
+            break;
+          }
+          case SLOPE:
+            output[0] = (N * dotFreqs - m_sumFreqs * sum) / (sum * m_slopeNorm);
+            break;
+          case DECREASE:
+            output[0] = sumDec / sumFromSecond;
+            break;
+          case FLATNESS_PER_BAND:
+            processBands(inData, output, crestOut ? crestOut->writeToken() : NULL);
+            break;
+          case CREST_PER_BAND:
+            processBands(inData, NULL, output);
+            break;
+          case VARIATION:
+          {
+            Map<const Matrix<T,Dynamic,1> > cur(inData,N);
+            const double curNorm = cur.template cast<double>().norm();
+            if (m_prevNorm*curNorm != 0)
+              output[0] = 1 - m_prev.dot(cur.template cast<double>()) / (m_prevNorm*curNorm);
+            else
+              output[0] = 0.0;
+            m_prev = cur.template cast<double>();
+            m_prevNorm = curNorm;
+            break;
+          }
+          default:
+            break;
+        }
+      }
+    }
+  }
+
+  bool SpectralDescriptors::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  {
+    assert(inp.size()==1);
+    InputBuffer* in = inp[0].data;
+    if (in->empty()) return false;
+    assert(outp.size()==m_descriptors.size());
+
+    const int N = in->info().size;
+    const int nbDescr = m_descriptors.size();
+    // per band flatness and crest factor are computed together
+    OutputBuffer* crestOut = NULL;
+    if (m_use[FLATNESS_PER_BAND] && m_use[CREST_PER_BAND])
+      for (int d=0;d<nbDescr;d++)
+        if (m_descriptors[d]==CREST_PER_BAND)
+          crestOut = outp[d].data;
+    // single precision spectra are summed in double precision
+    const bool floatIn = (in->sampleType()==FLOAT_SAMPLES);
+    while (!in->empty())
+    {
+      const int nbTokens = in->blockAvailableTokens();
+      if (floatIn)
+        processTokens(in->readToken<float>(),nbTokens,N,outp,crestOut);
+      else
+        processTokens(in->readToken(),nbTokens,N,outp,crestOut);
+      in->consumeTokens(nbTokens);
+    }
+
+    return true;
+  }
+
+  // values of a band summed by group of bins
+  template<class T>
+  const double* SpectralDescriptors::groupBand(const T* inData, const bandinfo& bi)
+  {
+    double* grouped = &m_bandData[0];
+    const int datalen = bi.length() / bi.group;
+    const T* ptr = &inData[bi.start];
+    for (int d=0;d<datalen;d++) {
+      double s = 0;
+      for (int g=0;g<bi.group;g++)
+        s += *ptr++;
+      grouped[d] = s;
+    }
+    return grouped;
+  }
+
+  const double* SpectralDescriptors::bandData(const double* inData, const bandinfo& bi)
+  {
+    return (bi.group>1) ? groupBand(inData,bi) : &inData[bi.start];
+  }
+
+  const double* SpectralDescriptors::bandData(const float* inData, const bandinfo& bi)
+  {
+    return groupBand(inData,bi);
+  }
+
+  template<class T>
+  void SpectralDescriptors::processBands(const T* inData, double* flatness, double* crest)
+  {
+    for (int k=0;k<(int)m_band.size();++k)
+    {
+      const bandinfo& bi = m_band[k];
+      const double* data = bandData(inData,bi);
+      const int datalen = bi.length() / bi.group;
+      if (flatness)
+      {
+        double am = 0;
+        double geomean = 0;
+        for (int i=0;i<datalen;i++)
+        {
+          const double t = data[i] + EPS;
+          am += t;
+          geomean += log(t);
+        }
+        geomean = exp(geomean/datalen);
+        flatness[k] = (am!=0) ? geomean * datalen / am : geomean / EPS;
+      }
+      if (crest)
+      {
+        double am = 0;
+        double maxdata = data[0];
+        for (int i=0;i<datalen;i++)
+        {
+          am += data[i];
+          if (data[i]>maxdata)
+            maxdata = data[i];
+        }
+        crest[k] = (am!=0) ? maxdata * datalen / am : maxdata / EPS;
+      }
+    }
+  }
+
+}
@@ -0,0 +1,97 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPECTRALDESCRIPTORS_H_
+#define SPECTRALDESCRIPTORS_H_
+
+#include "yaafe-core/Component.h"
+#include "SpectralFlatnessPerBand.h"
+#include <Eigen/Dense>
+#include <vector>
+
+#define SPECTRAL_DESCRIPTORS_ID "SpectralDescriptors"
+
+namespace YAAFE
+{
+
+  /**
+   * Computes the outputs of the ShapeStatistics, Flatness, Rolloff, Slope,
+   * Decrease, SpectralFlatnessPerBand, SpectralCrestFactorPerBand and
+   * Variation components in a single pass over each spectrum frame. Each
+   * requested descriptor has its own output port, named after the
+   * component it replaces. The engine substitutes this component to
+   * several of these components sharing the same input.
+   */
+  class SpectralDescriptors: public YAAFE::ComponentBase<SpectralDescriptors>
+  {
+   public:
+     SpectralDescriptors();
+     virtual ~SpectralDescriptors();
+
+     virtual const std::string getIdentifier() const { return SPECTRAL_DESCRIPTORS_ID;};
+     virtual const std::string getDescription() const { return "Spectral shape statistics, flatness, rolloff, slope, decrease, flatness and crest factor per band, and variation computed in a single pass over the spectrum."; }
+
+     virtual Component* copy() const { return new SpectralDescriptors(*this); }
+
+     virtual ParameterDescriptorList getParameterDescriptorList() const;
+
+     virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
+     virtual void reset();
+     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+
+     virtual bool canReadFloat(int port) const { return m_float; }
+
+   private:
+     enum Descriptor { SHAPE, FLATNESS, ROLLOFF, SLOPE, DECREASE,
+       FLATNESS_PER_BAND, CREST_PER_BAND, VARIATION, NB_DESCRIPTORS };
+     typedef SpectralFlatnessPerBand::bandinfo bandinfo;
+
+     template<class T>
+       void processTokens(const T* inData, int nbTokens, int N,
+           Ports<OutputBuffer*>& outp, OutputBuffer* crestOut);
+     template<class T>
+       void processBands(const T* inData, double* flatness, double* crest);
+     const double* bandData(const double* inData, const bandinfo& bi);
+     const double* bandData(const float* inData, const bandinfo& bi);
+     template<class T>
+       const double* groupBand(const T* inData, const bandinfo& bi);
+
+     std::vector<Descriptor> m_descriptors;
+     bool m_use[NB_DESCRIPTORS];
+     bool m_float;
+     double m_rolloffCoeff;
+     Eigen::VectorXd m_index;
+     Eigen::VectorXd m_invIndex;
+     Eigen::VectorXd m_freqs;
+     double m_sumFreqs;
+     double m_slopeNorm;
+     std::vector<bandinfo> m_band;
+     std::vector<double> m_bandData;
+     Eigen::VectorXd m_prev;
+     double m_prevNorm;
+  };
+
+}
+
+#endif /* SPECTRALDESCRIPTORS_H_ */
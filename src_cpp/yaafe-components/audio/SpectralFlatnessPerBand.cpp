@@ -41,12 +41,8 @@ namespace YAAFE
   {
   }
 
-  bool SpectralFlatnessPerBand::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  void SpectralFlatnessPerBand::quarterOctaveBands(const StreamInfo& in, std::vector<bandinfo>& bands)
   {
-    assert(inp.size()==1);
-    const StreamInfo& in = inp[0].data;
-    m_inSize = in.size;
-
     double fs = in.sampleRate;
     int blockSize = (in.size-1)*2; // assume input is spectrum
 
@@ -78,9 +74,18 @@ namespace YAAFE
       bi.start = i_lo;
       bi.end = i_hi+1;
       bi.group = grpsize;
-      m_band.push_back(bi);
+      bands.push_back(bi);
     }
+  }
+
+  bool SpectralFlatnessPerBand::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+  {
+    assert(inp.size()==1);
+    const StreamInfo& in = inp[0].data;
+    m_inSize = in.size;
 
+    m_band.clear();
+    quarterOctaveBands(in,m_band);
     outStreamInfo().add(StreamInfo(in,m_band.size()));
     return true;
   }
@@ -45,15 +45,23 @@ namespace YAAFE
      virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
      virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
 
-   private:
-     int m_inSize;
      struct bandinfo_ {
        int start;
        int end;
        int group;
-       int length() { return end-start; }
+       int length() const { return end-start; }
      };
      typedef struct bandinfo_ bandinfo;
+
+     /**
+      * Compute the log-spaced bands of 1/4 octave of the given spectrum
+      * stream, as proposed in MPEG7 standard. Also used by
+      * SpectralCrestFactorPerBand and SpectralDescriptors.
+      */
+     static void quarterOctaveBands(const StreamInfo& in, std::vector<bandinfo>& bands);
+
+   private:
+     int m_inSize;
      std::vector<bandinfo> m_band; // start,end,group for each band
   };
 
@@ -31,7 +31,7 @@ using namespace Eigen;
 namespace YAAFE
 {
 
-  Sqr::Sqr()
+  Sqr::Sqr() : m_float(false)
   {
   }
 
@@ -39,15 +39,37 @@ namespace YAAFE
   {
   }
 
+  ParameterDescriptorList Sqr::getParameterDescriptorList() const
+  {
+    ParameterDescriptorList pList;
+    pList.push_back(kernelPrecisionParameter());
+    return pList;
+  }
+
   bool Sqr::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
   {
     assert(inp.size()==1);
     const StreamInfo& in = inp[0].data;
+    m_float = useFloatKernel(params);
 
     outStreamInfo().add(in);
     return true;
   }
 
+  // squares computed in the precision of the input
+  template<class I, class O>
+  static void sqrTokens(InputBuffer* in, OutputBuffer* out)
+  {
+    const int N = in->info().size;
+    while (!in->empty())
+    {
+      Map<Array<I,Dynamic,1> > inData(in->readToken<I>(),N);
+      Map<Array<O,Dynamic,1> > outData(out->writeToken<O>(),N);
+      outData = inData.square().template cast<O>();
+      in->consumeToken();
+    }
+  }
+
   bool Sqr::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
   {
     assert(inp.size()==1);
@@ -60,14 +82,16 @@ namespace YAAFE
     //	output = input.square();
     //    out->append(in->available());
     //    in->forward(in->available());
-    const int N = in->info().size;
-    while (!in->empty())
-    {
-      Map<ArrayXd> inData(in->readToken(),N);
-      Map<ArrayXd> outData(out->writeToken(),N);
-      outData = inData.square();
-      in->consumeToken();
-    }
+    const bool floatIn = (in->sampleType()==FLOAT_SAMPLES);
+    const bool floatOut = (out->sampleType()==FLOAT_SAMPLES);
+    if (floatIn && floatOut)
+      sqrTokens<float,float>(in,out);
+    else if (floatIn)
+      sqrTokens<float,double>(in,out);
+    else if (floatOut)
+      sqrTokens<double,float>(in,out);
+    else
+      sqrTokens<double,double>(in,out);
     return true;
   }
 
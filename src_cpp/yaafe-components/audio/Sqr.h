@@ -40,9 +40,16 @@ namespace YAAFE
 
      const std::string getIdentifier() const { return SQR_ID; };
 
+     virtual ParameterDescriptorList getParameterDescriptorList() const;
+
      virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
      virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
 
+     virtual bool canReadFloat(int port) const { return m_float; }
+     virtual bool canWriteFloat(int port) const { return m_float; }
+
+   private:
+     bool m_float;
   };
 
 }
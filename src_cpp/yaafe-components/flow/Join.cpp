@@ -64,6 +64,7 @@ namespace YAAFE {
     assert(outp.size()==1);
     OutputBuffer* out = outp[0].data;
 
+    const int outSize = out->info().size;
     int insize[inp.size()];
     for (int i=0;i<inp.size();++i)
       insize[i] = inp[i].data->info().size;
@@ -71,19 +72,27 @@ namespace YAAFE {
     bool doneSomething = false;
     while (true)
     {
-      // check if all input buffers have tokens
+      // number of tokens available in contiguous memory in all input
+      // buffers and in output buffer
+      int nbTokens = out->remainingSpace();
       for (int i=0;i<inp.size();i++)
-        if (inp[i].data->empty())
-          return doneSomething;
+        nbTokens = min(nbTokens,inp[i].data->blockAvailableTokens());
+      if (nbTokens==0)
+        return doneSomething;
 
-      // copy all input tokens into output token
-      double* outData = out->writeToken();
+      // copy input tokens blocks into output tokens block
+      double* outData = out->writeTokens(nbTokens);
       for (int i=0;i<inp.size();i++)
       {
         InputBuffer* in = inp[i].data;
-        memcpy(outData,in->readToken(),insize[i] * sizeof(double));
+        const double* inData = in->readToken();
+        if (insize[i]==outSize)
+          memcpy(outData,inData,nbTokens*outSize*sizeof(double));
+        else
+          for (int t=0;t<nbTokens;t++)
+            memcpy(outData+t*outSize,inData+t*insize[i],insize[i]*sizeof(double));
         outData += insize[i];
-        in->consumeToken();
+        in->consumeTokens(nbTokens);
       }
 
       doneSomething = true;
@@ -50,6 +50,7 @@
 #include "yaafe-components/audio/SpecificLoudness.h"
 #include "yaafe-components/audio/LoudnessSharpness.h"
 #include "yaafe-components/audio/LoudnessSpread.h"
+#include "yaafe-components/audio/LoudnessDescriptors.h"
 #include "yaafe-components/audio/MedianFilter.h"
 #include "yaafe-components/audio/MelFilterBank.h"
 #include "yaafe-components/audio/Normalize.h"
@@ -60,6 +61,7 @@
 #include "yaafe-components/audio/Slope.h"
 #include "yaafe-components/audio/SlopeIntegrator.h"
 #include "yaafe-components/audio/SpectralCrestFactorPerBand.h"
+#include "yaafe-components/audio/SpectralDescriptors.h"
 #include "yaafe-components/audio/SpectralFlatnessPerBand.h"
 #include "yaafe-components/audio/Sqr.h"
 #include "yaafe-components/audio/StatisticalIntegrator.h"
@@ -78,6 +80,7 @@
 #include "yaafe-components/audio/DvornikovDifferentiator.h"
 #include "yaafe-components/audio/HistogramSummary.h"
 #include "yaafe-components/audio/LogCompression.h"
+#include "yaafe-components/audio/MultiOctaveCQT.h"
 #include "yaafe-components/audio/NormalizeMaxAll.h"
 
 #include "yaafe-components/flow/Join.h"
@@ -112,6 +115,7 @@ void registerYaafeComponents(void* componentFactory)
   factory->registerPrototype(new SpecificLoudness());
   factory->registerPrototype(new LoudnessSharpness());
   factory->registerPrototype(new LoudnessSpread());
+  factory->registerPrototype(new LoudnessDescriptors());
   factory->registerPrototype(new MedianFilter());
   factory->registerPrototype(new MelFilterBank());
   factory->registerPrototype(new Normalize());
@@ -124,6 +128,7 @@ void registerYaafeComponents(void* componentFactory)
   factory->registerPrototype(new Sqr());
   factory->registerPrototype(new SpectralCrestFactorPerBand());
   factory->registerPrototype(new SpectralFlatnessPerBand());
+  factory->registerPrototype(new SpectralDescriptors());
   factory->registerPrototype(new StatisticalIntegrator());
   factory->registerPrototype(new Sum());
   factory->registerPrototype(new Variation());
@@ -141,5 +146,6 @@ void registerYaafeComponents(void* componentFactory)
   factory->registerPrototype(new DvornikovDifferentiator());
   factory->registerPrototype(new HistogramSummary());
   factory->registerPrototype(new LogCompression());
+  factory->registerPrototype(new MultiOctaveCQT());
   factory->registerPrototype(new NormalizeMaxAll());
 }
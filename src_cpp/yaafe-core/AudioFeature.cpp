@@ -0,0 +1,239 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AudioFeature.h"
+#include "ComponentFactory.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace std;
+
+namespace YAAFE
+{
+
+  static bool compareParameterIdentifiers(const ParameterDescriptor& a,
+      const ParameterDescriptor& b)
+  {
+    return a.m_identifier < b.m_identifier;
+  }
+
+  AudioFeature::Overrides& AudioFeature::Overrides::set(const std::string& name,
+      const std::string& value)
+  {
+    m_values[name] = value;
+    return *this;
+  }
+
+  AudioFeature::Overrides& AudioFeature::Overrides::mask(const std::string& name)
+  {
+    m_masked.insert(name);
+    return *this;
+  }
+
+  AudioFeature::AudioFeature() : m_available(true)
+  {
+  }
+
+  ParameterMap AudioFeature::filterParams(const ParameterMap& params) const
+  {
+    // when a parameter is exposed several times, the last one wins
+    ParameterMap res;
+    for (ParameterDescriptorList::const_iterator it=m_params.begin();
+        it!=m_params.end(); it++)
+    {
+      ParameterMap::const_iterator pIt = params.find(it->m_identifier);
+      res[it->m_identifier] = (pIt!=params.end()) ? pIt->second : it->m_defaultValue;
+    }
+    return res;
+  }
+
+  void AudioFeature::getDataFlow(const ParameterMap& params, double sampleRate,
+      DataFlow& df) const
+  {
+    for (ParameterMap::const_iterator pIt=params.begin(); pIt!=params.end(); pIt++)
+    {
+      bool found = false;
+      for (ParameterDescriptorList::const_iterator it=m_params.begin();
+          it!=m_params.end(); it++)
+      {
+        if (it->m_identifier==pIt->first) {
+          found = true;
+          break;
+        }
+      }
+      if (!found)
+        cerr << "WARNING: unknown parameter " << pIt->first << " for feature "
+            << getIdentifier() << " !" << endl;
+    }
+    ParameterMap filtered = filterParams(params);
+    buildDataFlow(filtered, sampleRate, df);
+    for (vector<string>::const_iterator it=m_libs.begin(); it!=m_libs.end(); it++)
+      df.useComponentLibrary(*it);
+  }
+
+  void AudioFeature::useComponentLibrary(const std::string& lib)
+  {
+    if (ComponentFactory::instance()->loadLibrary(lib)!=0)
+      m_available = false;
+    m_libs.push_back(lib);
+  }
+
+  void AudioFeature::inheritFeature(const std::string& id, const Overrides& overrides)
+  {
+    const AudioFeature* feature = NULL;
+    const vector<AudioFeature*>& features = allFeatures();
+    for (vector<AudioFeature*>::const_iterator it=features.begin();
+        it!=features.end(); it++)
+    {
+      if ((*it)->getIdentifier()==id)
+        feature = *it;
+    }
+    if (!feature) {
+      m_available = false;
+      return;
+    }
+    inheritParameters(feature->getParameters(), overrides);
+  }
+
+  void AudioFeature::inheritComponent(const std::string& id, const Overrides& overrides)
+  {
+    if (!ComponentFactory::instance()->exists(id)) {
+      m_available = false;
+      return;
+    }
+    const Component* c = ComponentFactory::instance()->getPrototype(id);
+    inheritParameters(c->getParameterDescriptorList(), overrides);
+  }
+
+  void AudioFeature::inheritParameters(const ParameterDescriptorList& params,
+      const Overrides& overrides)
+  {
+    for (ParameterDescriptorList::const_iterator it=params.begin();
+        it!=params.end(); it++)
+    {
+      if (overrides.m_masked.find(it->m_identifier)!=overrides.m_masked.end())
+        continue;
+      ParameterDescriptor p = *it;
+      ParameterMap::const_iterator vIt = overrides.m_values.find(p.m_identifier);
+      if (vIt!=overrides.m_values.end())
+        p.m_defaultValue = vIt->second;
+      m_params.push_back(p);
+    }
+  }
+
+  void AudioFeature::addParameter(const std::string& id,
+      const std::string& defaultValue, const std::string& description)
+  {
+    ParameterDescriptor p;
+    p.m_identifier = id;
+    p.m_defaultValue = defaultValue;
+    p.m_description = description;
+    m_params.push_back(p);
+  }
+
+  void AudioFeature::dataflowSafeAppend(DataFlow& df, const std::string& component,
+      const ParameterMap& params)
+  {
+    ParameterMap filtered;
+    const Component* c = ComponentFactory::instance()->getPrototype(component);
+    if (c) {
+      ParameterDescriptorList pList = c->getParameterDescriptorList();
+      for (ParameterDescriptorList::const_iterator it=pList.begin();
+          it!=pList.end(); it++)
+      {
+        ParameterMap::const_iterator pIt = params.find(it->m_identifier);
+        filtered[it->m_identifier] = (pIt!=params.end()) ? pIt->second : it->m_defaultValue;
+      }
+    }
+    DataFlow::NodeList fNodes = df.finalNodes();
+    DataFlow::Node* n = df.createNode(NodeDesc(component,filtered));
+    if (fNodes.size()>1)
+    {
+      cerr << "WARNING: dataflow has " << fNodes.size()
+          << " final nodes when appending component " << component << " !" << endl;
+      return;
+    }
+    if (fNodes.size()==1)
+      df.link(fNodes[0],"",n,"");
+  }
+
+  std::string AudioFeature::formatNumber(double v)
+  {
+    char buf[32];
+    for (int precision=15; precision<=17; precision++) {
+      snprintf(buf, sizeof(buf), "%.*g", precision, v);
+      if (strtod(buf,NULL)==v)
+        break;
+    }
+    return buf;
+  }
+
+  std::vector<std::string> AudioFeature::availableFeatures()
+  {
+    vector<string> av;
+    for (vector<AudioFeature*>::iterator it=allFeatures().begin();
+        it!=allFeatures().end(); it++)
+      av.push_back((*it)->getIdentifier());
+    return av;
+  }
+
+  const AudioFeature* AudioFeature::get(const std::string& id)
+  {
+    for (vector<AudioFeature*>::iterator it=allFeatures().begin();
+        it!=allFeatures().end(); it++) {
+      if ((*it)->getIdentifier()==id)
+        return *it;
+    }
+    cerr << "ERROR: unknown feature " << id << endl;
+    return NULL;
+  }
+
+  void AudioFeature::registerFeature(AudioFeature* feature)
+  {
+    feature->declareParameters();
+    stable_sort(feature->m_params.begin(), feature->m_params.end(),
+        compareParameterIdentifiers);
+    if (!feature->available()) {
+      delete feature;
+      return;
+    }
+    allFeatures().push_back(feature);
+  }
+
+  std::vector<AudioFeature*>& AudioFeature::allFeatures()
+  {
+    static vector<AudioFeature*> allFeatures;
+    static bool initialized = false;
+    if (!initialized) {
+      // set first, core features look up the ones they inherit from
+      initialized = true;
+      registerYaafeFeatures();
+    }
+    return allFeatures;
+  }
+
+}
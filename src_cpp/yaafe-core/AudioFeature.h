@@ -0,0 +1,150 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOFEATURE_H_
+#define AUDIOFEATURE_H_
+
+#include "DataFlow.h"
+#include "utils.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace YAAFE
+{
+
+  /**
+   * An AudioFeature expands a feature definition (feature name and
+   * parameters) into the dataflow computing it. This is the C++ counterpart
+   * of the yaafelib AudioFeature classes, so that feature plans can be
+   * compiled without Python.
+   *
+   * Exposed parameters are declared in declareParameters(), in the same
+   * way as the PARAMS attribute of python features: parameters can be
+   * inherited from another feature or from a component, or defined
+   * explicitly.
+   */
+  class AudioFeature
+  {
+   public:
+     /**
+      * Default values overriding or masking inherited parameters.
+      */
+     class Overrides
+     {
+      public:
+        Overrides& set(const std::string& name, const std::string& value);
+        Overrides& mask(const std::string& name);
+      private:
+        friend class AudioFeature;
+        ParameterMap m_values;
+        std::set<std::string> m_masked;
+     };
+
+     virtual ~AudioFeature() {}
+
+     virtual const std::string getIdentifier() const = 0;
+     virtual const std::string getDescription() const { return ""; }
+
+     /**
+      * A transform feature applies on another feature (Cepstrum,
+      * StatisticalIntegrator, ...) instead of the audio signal.
+      */
+     virtual bool isTransform() const { return false; }
+
+     /**
+      * Returns false if a required component is not available.
+      */
+     bool available() const { return m_available; }
+
+     /**
+      * Exposed parameters, sorted by name.
+      */
+     const ParameterDescriptorList& getParameters() const { return m_params; }
+
+     /**
+      * Returns exposed parameters only, with default value for those
+      * missing in given params.
+      */
+     ParameterMap filterParams(const ParameterMap& params) const;
+
+     /**
+      * Build the dataflow computing the feature at the given sample rate
+      * into df, which must be empty.
+      */
+     void getDataFlow(const ParameterMap& params, double sampleRate, DataFlow& df) const;
+
+     static std::vector<std::string> availableFeatures();
+     static const AudioFeature* get(const std::string& id);
+
+     /**
+      * Register a feature. Features it inherits parameters from must be
+      * registered first. Unavailable features are discarded.
+      */
+     static void registerFeature(AudioFeature* feature);
+
+   protected:
+     AudioFeature();
+
+     virtual void declareParameters() = 0;
+     virtual void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const = 0;
+
+     void useComponentLibrary(const std::string& lib);
+     void inheritFeature(const std::string& id, const Overrides& overrides = Overrides());
+     void inheritComponent(const std::string& id, const Overrides& overrides = Overrides());
+     void addParameter(const std::string& id, const std::string& defaultValue,
+         const std::string& description);
+
+     /**
+      * Append a component step to a dataflow having at most one final node.
+      * Parameters are filtered according to the component parameters.
+      */
+     static void dataflowSafeAppend(DataFlow& df, const std::string& component,
+         const ParameterMap& params);
+
+     /**
+      * Shortest representation of v which reads back as v.
+      */
+     static std::string formatNumber(double v);
+
+   private:
+     void inheritParameters(const ParameterDescriptorList& params,
+         const Overrides& overrides);
+
+     static std::vector<AudioFeature*>& allFeatures();
+
+     bool m_available;
+     ParameterDescriptorList m_params;
+     std::vector<std::string> m_libs;
+  };
+
+  /**
+   * Register the yaafe core features (defined in AudioFeatures.cpp)
+   */
+  void registerYaafeFeatures();
+
+}
+
+#endif /* AUDIOFEATURE_H_ */
@@ -0,0 +1,815 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AudioFeature.h"
+
+#include <iostream>
+#include <sstream>
+#include <math.h>
+#include <stdlib.h>
+
+using namespace std;
+
+/**
+ * Yaafe core features. Each feature mirrors the python feature of the
+ * same name in yaafefeatures.py, and both must build the same dataflows.
+ */
+
+namespace YAAFE
+{
+
+// feature classes have internal linkage, as several share the name of a
+// component class
+namespace
+{
+
+  static std::string intString(int v)
+  {
+    ostringstream oss;
+    oss << v;
+    return oss.str();
+  }
+
+  static int intParam(const ParameterMap& params, const std::string& id)
+  {
+    ParameterMap::const_iterator it = params.find(id);
+    return (it!=params.end()) ? atoi(it->second.c_str()) : 0;
+  }
+
+  static double doubleParam(const ParameterMap& params, const std::string& id)
+  {
+    ParameterMap::const_iterator it = params.find(id);
+    return (it!=params.end()) ? atof(it->second.c_str()) : 0.0;
+  }
+
+  /**
+   * Build dataflow of feature id with given parameters.
+   */
+  static void featureDataFlow(const std::string& id, const ParameterMap& params,
+      double sampleRate, DataFlow& df)
+  {
+    const AudioFeature* feature = AudioFeature::get(id);
+    if (feature)
+      feature->getDataFlow(params, sampleRate, df);
+  }
+
+  /**
+   * Build dataflow of feature id with the given parameters it exposes.
+   */
+  static void filteredFeatureDataFlow(const std::string& id,
+      const ParameterMap& params, double sampleRate, DataFlow& df)
+  {
+    const AudioFeature* feature = AudioFeature::get(id);
+    if (feature)
+      feature->getDataFlow(feature->filterParams(params), sampleRate, df);
+  }
+
+  class Frames : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "Frames"; }
+     const std::string getDescription() const { return "Segment input signal into frames."; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritComponent("FrameTokenizer");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       df.createNode(NodeDesc("FrameTokenizer",params));
+     }
+  };
+
+  /**
+   * Frames followed by a single component
+   */
+  class FramesFeature : public AudioFeature
+  {
+   public:
+     FramesFeature(const std::string& id, const std::string& component,
+         const std::string& description) :
+       m_id(id), m_component(component), m_description(description) {}
+     const std::string getIdentifier() const { return m_id; }
+     const std::string getDescription() const { return m_description; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("Frames");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("Frames", params, sampleRate, df);
+       dataflowSafeAppend(df, m_component, ParameterMap());
+     }
+   private:
+     std::string m_id;
+     std::string m_component;
+     std::string m_description;
+  };
+
+  class MagnitudeSpectrum : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "MagnitudeSpectrum"; }
+     const std::string getDescription() const {
+       return "Compute frame's magnitude spectrum, using an analysis window (Hanning or Hamming), or not.";
+     }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("Frames");
+       inheritComponent("FFT", Overrides().set("FFTLength","0"));
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("Frames", params, sampleRate, df);
+       if (params["FFTLength"]=="0")
+         params["FFTLength"] = params["blockSize"];
+       dataflowSafeAppend(df, "FFT", params);
+       dataflowSafeAppend(df, "Abs", ParameterMap());
+     }
+  };
+
+  /**
+   * Magnitude spectrum followed by a component, with an optional Sqr step
+   */
+  class SpectrumFeature : public AudioFeature
+  {
+   public:
+     SpectrumFeature(const std::string& id, const std::string& component,
+         bool sqr, bool filter, const std::string& description) :
+       m_id(id), m_component(component), m_sqr(sqr), m_filter(filter),
+       m_description(description) {}
+     const std::string getIdentifier() const { return m_id; }
+     const std::string getDescription() const { return m_description; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("MagnitudeSpectrum");
+       if (m_sqr)
+         inheritComponent("Sqr");
+       inheritComponent(m_component);
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       if (m_filter)
+         filteredFeatureDataFlow("MagnitudeSpectrum", params, sampleRate, df);
+       else
+         featureDataFlow("MagnitudeSpectrum", params, sampleRate, df);
+       if (m_sqr)
+         dataflowSafeAppend(df, "Sqr", ParameterMap());
+       dataflowSafeAppend(df, m_component, params);
+     }
+   private:
+     std::string m_id;
+     std::string m_component;
+     bool m_sqr;
+     bool m_filter;
+     std::string m_description;
+  };
+
+  class AutoCorrelation : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "AutoCorrelation"; }
+     const std::string getDescription() const { return "Compute autocorrelation coefficients on each frames."; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("Frames");
+       inheritComponent("AutoCorrelation");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("Frames", params, sampleRate, df);
+       dataflowSafeAppend(df, "AutoCorrelation", params);
+     }
+  };
+
+  class LPC : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "LPC"; }
+     const std::string getDescription() const {
+       return "Compute the Linear Predictor Coefficients (LPC) of a signal frame.";
+     }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("AutoCorrelation", Overrides().mask("ACNbCoeffs"));
+       inheritComponent("AC2LPC");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       ParameterMap acParams = AudioFeature::get("AutoCorrelation")->filterParams(params);
+       acParams["ACNbCoeffs"] = intString(intParam(params,"LPCNbCoeffs") + 1);
+       featureDataFlow("AutoCorrelation", acParams, sampleRate, df);
+       dataflowSafeAppend(df, "AC2LPC", params);
+     }
+  };
+
+  class LSF : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "LSF"; }
+     const std::string getDescription() const {
+       return "Compute the Line Spectral Frequency (LSF) coefficients of a signal frame.";
+     }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("LPC", Overrides().mask("LPCNbCoeffs"));
+       inheritComponent("LPC2LSF");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       int nbCoeffs = intParam(params,"LSFNbCoeffs");
+       int displacement = intParam(params,"LSFDisplacement");
+       ParameterMap lpcParams = AudioFeature::get("LPC")->filterParams(params);
+       lpcParams["LPCNbCoeffs"] = intString(nbCoeffs + 1 - (displacement>1 ? displacement : 1));
+       featureDataFlow("LPC", lpcParams, sampleRate, df);
+       dataflowSafeAppend(df, "LPC2LSF", params);
+     }
+  };
+
+  /**
+   * Transform feature made of a single component
+   */
+  class TransformFeature : public AudioFeature
+  {
+   public:
+     TransformFeature(const std::string& id, bool safeAppend,
+         const std::string& description) :
+       m_id(id), m_safeAppend(safeAppend), m_description(description) {}
+     const std::string getIdentifier() const { return m_id; }
+     const std::string getDescription() const { return m_description; }
+     bool isTransform() const { return true; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritComponent(m_id);
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       if (m_safeAppend)
+         dataflowSafeAppend(df, m_id, params);
+       else
+         df.createNode(NodeDesc(m_id,params));
+     }
+   private:
+     std::string m_id;
+     bool m_safeAppend;
+     std::string m_description;
+  };
+
+  class ComplexDomainOnsetDetection : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "ComplexDomainOnsetDetection"; }
+     const std::string getDescription() const {
+       return "Compute onset detection using a complex domain spectral flux method.";
+     }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("Frames");
+       inheritComponent("FFT");
+       inheritComponent("ComplexDomainFlux");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("Frames", params, sampleRate, df);
+       dataflowSafeAppend(df, "FFT", params);
+       dataflowSafeAppend(df, "ComplexDomainFlux", params);
+     }
+  };
+
+  class MelSpectrum : public AudioFeature
+  {
+   public:
+     MelSpectrum(const std::string& id, bool cepstrum,
+         const std::string& description) :
+       m_id(id), m_cepstrum(cepstrum), m_description(description) {}
+     const std::string getIdentifier() const { return m_id; }
+     const std::string getDescription() const { return m_description; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("MagnitudeSpectrum", Overrides().mask("FFTLength"));
+       inheritComponent("MelFilterBank");
+       if (m_cepstrum)
+         inheritComponent("Cepstrum");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("MagnitudeSpectrum", params, sampleRate, df);
+       dataflowSafeAppend(df, "MelFilterBank", params);
+       if (m_cepstrum)
+         dataflowSafeAppend(df, "Cepstrum", params);
+     }
+   private:
+     std::string m_id;
+     bool m_cepstrum;
+     std::string m_description;
+  };
+
+  class Envelope : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "Envelope"; }
+     const std::string getDescription() const {
+       return "Extract amplitude envelope using hilbert transform, low-pass filtering and decimation.";
+     }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("Frames", Overrides().set("blockSize","32768").set("stepSize","16384"));
+       inheritComponent("Envelope");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("Frames", params, sampleRate, df);
+       dataflowSafeAppend(df, "Envelope", params);
+     }
+  };
+
+  class EnvelopeFeature : public AudioFeature
+  {
+   public:
+     EnvelopeFeature(const std::string& id, const std::string& component,
+         const Overrides& overrides, const std::string& description) :
+       m_id(id), m_component(component), m_overrides(overrides),
+       m_description(description) {}
+     const std::string getIdentifier() const { return m_id; }
+     const std::string getDescription() const { return m_description; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("Envelope");
+       inheritComponent(m_component, m_overrides);
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("Envelope", params, sampleRate, df);
+       dataflowSafeAppend(df, m_component, params);
+     }
+   private:
+     std::string m_id;
+     std::string m_component;
+     Overrides m_overrides;
+     std::string m_description;
+  };
+
+  class Loudness : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "Loudness"; }
+     const std::string getDescription() const {
+       return "The loudness coefficients are the energy in each Bark band, normalized by the overall sum.";
+     }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("MagnitudeSpectrum");
+       inheritComponent("Sqr");
+       inheritComponent("Loudness");
+       addParameter("LMode", "Relative",
+           "\"Specific\" computes loudness without normalization, "
+           "\"Relative\" normalize each band so that they sum to 1, "
+           "\"Total\" just returns the sum of Loudness in all bands.");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("MagnitudeSpectrum", params, sampleRate, df);
+       dataflowSafeAppend(df, "Sqr", ParameterMap());
+       if (params["LMode"]=="Total") {
+         // same as Loudness > Sum, in a single pass
+         ParameterMap lParams = params;
+         lParams["LDescriptors"] = "Total";
+         dataflowSafeAppend(df, "LoudnessDescriptors", lParams);
+         return;
+       }
+       dataflowSafeAppend(df, "Loudness", params);
+       if (params["LMode"]=="Relative") {
+         ParameterMap nParams;
+         nParams["NNorm"] = "Sum";
+         dataflowSafeAppend(df, "Normalize", nParams);
+       }
+     }
+  };
+
+  /**
+   * Descriptor of relative loudness, computed by LoudnessDescriptors.
+   * Engine fuses the descriptors of a same spectrum into one step.
+   */
+  class LoudnessFeature : public AudioFeature
+  {
+   public:
+     LoudnessFeature(const std::string& id, const std::string& descriptor,
+         const std::string& description) :
+       m_id(id), m_descriptor(descriptor), m_description(description) {}
+     const std::string getIdentifier() const { return m_id; }
+     const std::string getDescription() const { return m_description; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("MagnitudeSpectrum");
+       inheritComponent("Sqr");
+       inheritComponent("LoudnessDescriptors", Overrides().mask("LDescriptors"));
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("MagnitudeSpectrum", params, sampleRate, df);
+       dataflowSafeAppend(df, "Sqr", ParameterMap());
+       ParameterMap lParams = params;
+       lParams["LDescriptors"] = m_descriptor;
+       dataflowSafeAppend(df, "LoudnessDescriptors", lParams);
+     }
+   private:
+     std::string m_id;
+     std::string m_descriptor;
+     std::string m_description;
+  };
+
+  class OBSIR : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "OBSIR"; }
+     const std::string getDescription() const { return "Compute log of OBSI ratio between consecutive octave."; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("OBSI");
+       inheritComponent("Difference");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("OBSI", params, sampleRate, df);
+       dataflowSafeAppend(df, "Difference", params);
+     }
+  };
+
+  class OnsetDetectionFunction : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "OnsetDetectionFunction"; }
+     const std::string getDescription() const {
+       return "Compute onset detection function (spectral energy flux).";
+     }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("MagnitudeSpectrum");
+       inheritComponent("NormalizeMaxAll", Overrides().set("NMANbFrames","5000"));
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("MagnitudeSpectrum", params, sampleRate, df);
+       dataflowSafeAppend(df, "NormalizeMaxAll", params);
+       ParameterMap p;
+       p["FSVThreshold"] = "0.001";
+       dataflowSafeAppend(df, "FilterSmallValues", p);
+       p.clear();
+       p["HHFOrder"] = "0.175s";
+       dataflowSafeAppend(df, "HalfHannFilter", p);
+       dataflowSafeAppend(df, "LogCompression", ParameterMap());
+       p.clear();
+       p["DDOrder"] = "0.08s";
+       dataflowSafeAppend(df, "DvornikovDifferentiator", p);
+       p.clear();
+       p["FSVThreshold"] = "1";
+       dataflowSafeAppend(df, "FilterSmallValues", p);
+       dataflowSafeAppend(df, "Sum", ParameterMap());
+       dataflowSafeAppend(df, "NormalizeMaxAll", params);
+     }
+  };
+
+  class BeatHistogramSummary : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "BeatHistogramSummary"; }
+     const std::string getDescription() const {
+       return "Compute the beat histogram, using OnsetDetectionFunction as onset detection function.";
+     }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("OnsetDetectionFunction");
+       inheritComponent("AutoCorrelationPeaksIntegrator", Overrides()
+           .mask("NbFrames").mask("StepNbFrames").set("ACPNbPeaks","3")
+           .mask("ACPNorm").mask("ACPInterPeakMinDist"));
+       inheritComponent("HistogramIntegrator", Overrides()
+           .mask("NbFrames").mask("StepNbFrames").mask("HInf").mask("HSup")
+           .set("HNbBins","80").mask("HWeighted"));
+       inheritComponent("HistogramSummary", Overrides().mask("HSup").mask("HInf"));
+       addParameter("BHSBeatFrameSize", "128",
+           "Number of frames over which autocorrelation peaks is computed");
+       addParameter("BHSBeatFrameStep", "64",
+           "Number of frames to skip between two consecutive autocorrelation peaks computation");
+       addParameter("BHSHistogramFrameSize", "40",
+           "Number of beat frames over which histogram is computed");
+       addParameter("BHSHistogramFrameStep", "40",
+           "Number of beat frames to skip between two consecutive histogram computation");
+       addParameter("HInf", "40", "Minimal BPM to take into consideration");
+       addParameter("HSup", "200", "Maximal BPM to tage into consideration");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       filteredFeatureDataFlow("OnsetDetectionFunction", params, sampleRate, df);
+       ParameterMap acpParams;
+       acpParams["NbFrames"] = params["BHSBeatFrameSize"];
+       acpParams["StepNbFrames"] = params["BHSBeatFrameStep"];
+       acpParams["ACPNbPeaks"] = params["ACPNbPeaks"];
+       acpParams["ACPNorm"] = "BPM";
+       acpParams["ACPInterPeakMinDist"] = "5";
+       dataflowSafeAppend(df, "AutoCorrelationPeaksIntegrator", acpParams);
+       ParameterMap hParams;
+       hParams["NbFrames"] = params["BHSHistogramFrameSize"];
+       hParams["StepNbFrames"] = params["BHSHistogramFrameStep"];
+       hParams["HInf"] = params["HInf"];
+       hParams["HSup"] = params["HSup"];
+       hParams["HNbBins"] = params["HNbBins"];
+       hParams["HWeighted"] = "1";
+       dataflowSafeAppend(df, "HistogramIntegrator", hParams);
+       dataflowSafeAppend(df, "HistogramSummary", params);
+     }
+  };
+
+  class CQT : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "CQT"; }
+     const std::string getDescription() const { return "Compute the Constant-Q transform."; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("Frames", Overrides().mask("blockSize"));
+       inheritComponent("CQT", Overrides().set("CQTMinFreq","73.42")
+           .set("CQTBinsPerOctave","36").mask("CQTMaxFreq"));
+       addParameter("CQTNbOctaves", "3", "Number of octaves to consider for analysis");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       int nbOct = intParam(params,"CQTNbOctaves");
+       double originalFs = sampleRate;
+       double minFreq = doubleParam(params,"CQTMinFreq") * pow(2.0, nbOct - 1);
+       const double bandwidth = 0.95;
+       DataFlow::Node* signalNode = NULL;
+       // decimate until first octave to analyse, these decimations can be
+       // shared with other features
+       while (bandwidth * sampleRate / 8 > minFreq) {
+         DataFlow::Node* s = df.createNode(NodeDesc("Decimate2",ParameterMap()));
+         if (signalNode)
+           df.link(signalNode, "", s, "");
+         signalNode = s;
+         sampleRate = sampleRate / 2;
+       }
+       // decimations and analysis of each octave
+       char buf[32];
+       ParameterMap cqtParams;
+       cqtParams["CQTMinFreq"] = params["CQTMinFreq"];
+       cqtParams["CQTBinsPerOctave"] = params["CQTBinsPerOctave"];
+       cqtParams["CQTAlign"] = params["CQTAlign"];
+       cqtParams["CQTNbOctaves"] = params["CQTNbOctaves"];
+       cqtParams["stepSize"] = params["stepSize"];
+       snprintf(buf, sizeof(buf), "%f", originalFs);
+       cqtParams["outSampleRate"] = buf;
+       DataFlow::Node* cqt = df.createNode(NodeDesc("MultiOctaveCQT",cqtParams));
+       if (signalNode)
+         df.link(signalNode, "", cqt, "");
+     }
+  };
+
+  class CQT2 : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "CQT2"; }
+     const std::string getDescription() const {
+       return "Compute the Constant-Q transform according to Blankertz's implementation.";
+     }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("Frames", Overrides().mask("blockSize"));
+       inheritComponent("CQT");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       double minFreq = doubleParam(params,"CQTMinFreq");
+       int bins = intParam(params,"CQTBinsPerOctave");
+       double Q = 2.0 / (pow(2.0, 1.0 / bins) - 1);
+       double fftLen = Q * sampleRate / minFreq;
+       fftLen = pow(2.0, ceil(log2(fftLen)));
+       ParameterMap fParams = AudioFeature::get("Frames")->filterParams(params);
+       fParams["blockSize"] = intString((int) fftLen);
+       featureDataFlow("Frames", fParams, sampleRate, df);
+       ParameterMap fftParams;
+       fftParams["FFTLength"] = intString((int) fftLen);
+       fftParams["FFTWindow"] = "None";
+       dataflowSafeAppend(df, "FFT", fftParams);
+       dataflowSafeAppend(df, "CQT", params);
+     }
+  };
+
+  class SpectralIrregularity : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "SpectralIrregularity"; }
+     const std::string getDescription() const { return "Compute difference between consecutive CQT bins."; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("CQT");
+       inheritComponent("Difference", Overrides().mask("DiffNbCoeffs"));
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       featureDataFlow("CQT", params, sampleRate, df);
+       ParameterMap dParams;
+       dParams["DiffNbCoeffs"] = "0";
+       dataflowSafeAppend(df, "Difference", dParams);
+     }
+  };
+
+  /**
+   * Adjust CQTBinsPerOctave to a multiple of 12
+   */
+  static int chromaBinsPerOctave(const std::string& feature, int b)
+  {
+    if (b % 12 != 0) {
+      cerr << "WARNING: in " << feature << ", CQTBinsPerOctave must be multiple of 12" << endl;
+      b = b - b % 12;
+      if (b==0)
+        b = 12;
+      cerr << "use CQTBinsPerOctave=" << b << endl;
+    }
+    return b;
+  }
+
+  class Chroma2 : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "Chroma2"; }
+     const std::string getDescription() const { return "Chroma2 compute short-term pitch profile."; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritFeature("CQT", Overrides().set("CQTMinFreq","27.5")
+           .set("CQTNbOctaves","7").set("CQTBinsPerOctave","48"));
+       inheritComponent("Chroma2", Overrides().mask("CQTMinFreq")
+           .mask("CQTMaxFreq").mask("CQTBinsPerOctave"));
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       double tuning = doubleParam(params,"CZTuning");
+       double fmin = doubleParam(params,"CQTMinFreq");
+       if (tuning > 0) {
+         // adjust min freq to a divisor of tuning
+         int b = chromaBinsPerOctave("Chroma2", intParam(params,"CQTBinsPerOctave"));
+         double dev = b * log2(tuning / fmin);
+         fmin *= pow(2.0, fmod(dev, 1.0) / b);
+       }
+       params["CQTMinFreq"] = formatNumber(fmin);
+       filteredFeatureDataFlow("CQT", params, sampleRate, df);
+       params.erase("stepSize");
+       dataflowSafeAppend(df, "Chroma2", params);
+     }
+  };
+
+  class Chroma : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "Chroma"; }
+     const std::string getDescription() const { return "Chroma compute short-term chromagram."; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       addParameter("ChromaSmoothing", "0.75s", "Chroma smoothing duration");
+       inheritFeature("CQT", Overrides().set("CQTMinFreq","73.42")
+           .set("CQTNbOctaves","3").set("CQTBinsPerOctave","36"));
+       inheritComponent("ChromaTune", Overrides().mask("CQTMinFreq")
+           .mask("CQTBinsPerOctave").set("CTInitDuration","15"));
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       int b = intParam(params,"CQTBinsPerOctave");
+       if (b % 12 != 0)
+         params["CQTBinsPerOctave"] = intString(chromaBinsPerOctave("Chroma", b));
+       filteredFeatureDataFlow("CQT", params, sampleRate, df);
+       dataflowSafeAppend(df, "ChromaTune", params);
+       ParameterMap mfParams;
+       mfParams["MFOrder"] = params["ChromaSmoothing"];
+       dataflowSafeAppend(df, "MedianFilter", mfParams);
+       dataflowSafeAppend(df, "ChromaReduce", ParameterMap());
+     }
+  };
+
+  class Chords : public AudioFeature
+  {
+   public:
+     const std::string getIdentifier() const { return "Chords"; }
+     const std::string getDescription() const { return "Chords recognize chords from chromagrams."; }
+   protected:
+     void declareParameters() {
+       useComponentLibrary("yaafe-components");
+       inheritComponent("FrameTokenizer", Overrides().mask("blockSize"));
+       addParameter("ChordsUse7", "0",
+           "If 1 then use 7th chords to enrich chord dictionnary, else use only major an minor chords");
+       addParameter("ChordsSmoothing", "1.5s", "Chords smoothing duration");
+     }
+     void buildDataFlow(ParameterMap& params, double sampleRate, DataFlow& df) const {
+       string chType = (params["ChordsUse7"]=="1") ? "maj,min,7" : "maj,min";
+       ParameterMap chromaParams;
+       chromaParams["CQTMinFreq"] = "73.42";
+       chromaParams["CQTNbOctaves"] = "3";
+       chromaParams["CQTBinsPerOctave"] = "36";
+       chromaParams["stepSize"] = params["stepSize"];
+       featureDataFlow("Chroma", chromaParams, sampleRate, df);
+       ParameterMap p;
+       p["ChordTypes"] = chType;
+       p["ChordNbHarmonics"] = "1";
+       dataflowSafeAppend(df, "Chroma2ChordDict", p);
+       p.clear();
+       p["MFOrder"] = params["ChordsSmoothing"];
+       dataflowSafeAppend(df, "MedianFilter", p);
+       p.clear();
+       p["ChordTypes"] = chType;
+       dataflowSafeAppend(df, "ChordDictDecoder", p);
+     }
+  };
+
+} // namespace
+
+  void registerYaafeFeatures()
+  {
+    AudioFeature::registerFeature(new Frames());
+    AudioFeature::registerFeature(new FramesFeature("ZCR", "ZCR",
+        "Compute zero-crossing rate in frames."));
+    AudioFeature::registerFeature(new FramesFeature("TemporalShapeStatistics", "ShapeStatistics",
+        "Compute shape statistics of signal frames."));
+    AudioFeature::registerFeature(new FramesFeature("Energy", "RMS",
+        "Compute energy as root mean square of an audio Frame."));
+    AudioFeature::registerFeature(new MagnitudeSpectrum());
+    AudioFeature::registerFeature(new SpectrumFeature("SpectralVariation", "Variation", false, false,
+        "SpectralVariation is the normalized correlation of spectrum between consecutive frames."));
+    AudioFeature::registerFeature(new SpectrumFeature("SpectralSlope", "Slope", false, false,
+        "SpectralSlope is computed by linear regression of the spectral amplitude."));
+    AudioFeature::registerFeature(new SpectrumFeature("SpectralRolloff", "Rolloff", true, false,
+        "Spectral roll-off is the frequency so that 99% of the energy is contained below."));
+    AudioFeature::registerFeature(new SpectrumFeature("SpectralShapeStatistics", "ShapeStatistics", false, false,
+        "Compute shape statistics of MagnitudeSpectrum."));
+    AudioFeature::registerFeature(new SpectrumFeature("SpectralFlux", "Flux", false, true,
+        "Compute flux of spectrum between consecutives frames."));
+    AudioFeature::registerFeature(new SpectrumFeature("SpectralFlatness", "Flatness", false, false,
+        "Compute global spectral flatness using the ratio between geometric and arithmetic mean."));
+    AudioFeature::registerFeature(new SpectrumFeature("SpectralDecrease", "Decrease", false, false,
+        "Compute spectral decrease."));
+    AudioFeature::registerFeature(new SpectrumFeature("SpectralFlatnessPerBand", "SpectralFlatnessPerBand", true, false,
+        "Compute spectral flatness per log-spaced band of 1/4 octave, as proposed in MPEG7 standard."));
+    AudioFeature::registerFeature(new SpectrumFeature("SpectralCrestFactorPerBand", "SpectralCrestFactorPerBand", true, false,
+        "Compute spectral crest factor per log-spaced band of 1/4 octave."));
+    AudioFeature::registerFeature(new AutoCorrelation());
+    AudioFeature::registerFeature(new LPC());
+    AudioFeature::registerFeature(new LSF());
+    AudioFeature::registerFeature(new TransformFeature("AutoCorrelationPeaksIntegrator", true,
+        "Feature transform that compute peaks of the autocorrelation function, outputs peaks and amplitude."));
+    AudioFeature::registerFeature(new ComplexDomainOnsetDetection());
+    AudioFeature::registerFeature(new TransformFeature("Cepstrum", true,
+        "Feature transform that compute cepstrum coefficients of input feature frames."));
+    AudioFeature::registerFeature(new MelSpectrum("MelSpectrum", false,
+        "Compute the Mel-frequencies spectrum."));
+    AudioFeature::registerFeature(new MelSpectrum("MFCC", true,
+        "Compute the Mel-frequencies cepstrum coefficients."));
+    AudioFeature::registerFeature(new TransformFeature("Derivate", false,
+        "Compute temporal derivative of input feature."));
+    AudioFeature::registerFeature(new Envelope());
+    AudioFeature::registerFeature(new EnvelopeFeature("EnvelopeShapeStatistics", "ShapeStatistics",
+        AudioFeature::Overrides(),
+        "Centroid, spread, skewness and kurtosis of each frame's amplitude envelope."));
+    AudioFeature::registerFeature(new EnvelopeFeature("AmplitudeModulation", "AmplitudeModulation",
+        AudioFeature::Overrides().mask("EnDecim"),
+        "Tremelo and Grain description."));
+    AudioFeature::registerFeature(new TransformFeature("StatisticalIntegrator", false,
+        "Feature transform that compute the temporal mean and variance of input feature over the given number of frames."));
+    AudioFeature::registerFeature(new TransformFeature("HistogramIntegrator", false,
+        "Feature transform that compute histogram of input values"));
+    AudioFeature::registerFeature(new TransformFeature("SlopeIntegrator", false,
+        "Feature transform that compute the slope of input feature over the given number of frames."));
+    AudioFeature::registerFeature(new Loudness());
+    AudioFeature::registerFeature(new LoudnessFeature("PerceptualSharpness", "Sharpness",
+        "Compute the sharpness of Loudness coefficients."));
+    AudioFeature::registerFeature(new LoudnessFeature("PerceptualSpread", "Spread",
+        "Compute the spread of Loudness coefficients."));
+    AudioFeature::registerFeature(new SpectrumFeature("OBSI", "OBSI", true, true,
+        "Compute Octave band signal intensity using a trigular octave filter bank."));
+    AudioFeature::registerFeature(new OBSIR());
+    AudioFeature::registerFeature(new OnsetDetectionFunction());
+    AudioFeature::registerFeature(new BeatHistogramSummary());
+    AudioFeature::registerFeature(new CQT());
+    AudioFeature::registerFeature(new CQT2());
+    AudioFeature::registerFeature(new SpectralIrregularity());
+    AudioFeature::registerFeature(new Chroma2());
+    AudioFeature::registerFeature(new Chroma());
+    AudioFeature::registerFeature(new Chords());
+  }
+
+}
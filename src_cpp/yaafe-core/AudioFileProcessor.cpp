@@ -24,8 +24,10 @@
 
 #include "AudioFileProcessor.h"
 #include "ComponentFactory.h"
+#include "Thread.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -44,10 +46,130 @@ namespace YAAFE {
     }
   }
 
-  AudioFileProcessor::AudioFileProcessor() : m_format(NULL) {
+  /**
+   * Reader initialized in a background thread.
+   */
+  class AudioFileProcessor::Prefetch : public Thread
+  {
+   public:
+     Prefetch(const std::string& f, Component* r, const ParameterMap& p,
+         const EngineConfig& c) :
+       filename(f), reader(r), params(p), config(c), ok(false) {}
+     virtual ~Prefetch() {
+       join();
+       if (reader) delete reader;
+     }
+
+     std::string filename;
+     Component* reader;
+     ParameterMap params;
+     EngineConfig config;
+     bool ok;
+
+   protected:
+     virtual void run() {
+       // the reader runs with the settings of the engine it is read for
+       EngineConfig::Scope scope(config);
+       Ports<StreamInfo> inports;
+       ok = reader->init(params,inports);
+     }
+  };
+
+  /**
+   * Audio decoded once and shared by several engine inputs. Decoded blocks
+   * are dispatched to all inputs without copy.
+   */
+  class AudioFileProcessor::SharedDecode
+  {
+   public:
+     SharedDecode(Component* r) :
+       reader(r), decoded(r->getOutStreamInfo()[0].data), eof(false) {
+       out.add(&decoded);
+     }
+     ~SharedDecode() {
+       delete reader;
+     }
+
+     /**
+      * Decode next block and dispatch it to inputs. Returns false at
+      * end of file.
+      */
+     bool decode() {
+       if (eof)
+         return false;
+       if (!reader->process(noInput,out))
+         eof = true;
+       decoded.flush();
+       return !eof;
+     }
+
+     Component* reader;
+     OutputBuffer decoded;
+     Ports<InputBuffer*> noInput;
+     Ports<OutputBuffer*> out;
+     bool eof;
+  };
+
+  /**
+   * Engine input fed by a SharedDecode, resampling the decoded audio to
+   * the input sample rate.
+   */
+  class AudioFileProcessor::AudioInput : public Component
+  {
+   public:
+     AudioInput(SharedDecode* d, Component* r) :
+       m_decode(d), m_resampler(r), m_in(d->decoded.info()) {
+       m_decode->decoded.bindInputBuffer(&m_in);
+       m_inPorts.add(&m_in);
+     }
+     virtual ~AudioInput() {
+       m_decode->decoded.unbindInputBuffer(&m_in);
+       delete m_resampler;
+     }
+
+     virtual const std::string getIdentifier() const { return "AudioInput"; }
+     virtual Component* clone() const { return NULL; }
+
+     virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in) {
+       int fsin = (int) in[0].data.sampleRate;
+       ParameterMap::const_iterator it = params.find("SampleRate");
+       int fsout = (it==params.end()) ? fsin : atoi(it->second.c_str());
+       it = params.find("Resample");
+       if (fsin!=fsout && (it==params.end() || it->second!="yes")) {
+         cerr << "ERROR: resampling is disabled and file has sample rate " << fsin << " Hz. Expecting " << fsout << " Hz !" << endl;
+         return false;
+       }
+       if (!m_resampler->init(params,in))
+         return false;
+       outStreamInfo() = m_resampler->getOutStreamInfo();
+       return true;
+     }
+     virtual void reset() {
+       m_resampler->reset();
+     }
+     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out) {
+       if (m_in.empty())
+         m_decode->decode();
+       return m_resampler->process(m_inPorts,out);
+     }
+     virtual void flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out) {
+       while (m_decode->decode())
+         ;
+       m_resampler->flush(m_inPorts,out);
+     }
+
+   private:
+     SharedDecode* m_decode;
+     Component* m_resampler;
+     InputBuffer m_in;
+     Ports<InputBuffer*> m_inPorts;
+  };
+
+  AudioFileProcessor::AudioFileProcessor() : m_format(NULL), m_readAhead(0), m_prefetch(NULL) {
   }
 
   AudioFileProcessor::~AudioFileProcessor() {
+    cancelPrefetch();
     if (m_format)
       delete m_format;
   }
@@ -66,70 +188,119 @@ namespace YAAFE {
     return true;
   }
 
-  int AudioFileProcessor::processFile(Engine& engine, const std::string& filename)
+  void AudioFileProcessor::setReadAhead(int nbBlocks)
   {
-    {
-      // check engine inputs
-      vector<string> inputs = engine.getInputs();
-      if (inputs.size()!=1) {
-        cerr << "ERROR: dataflow must have exactly 1 root node" << endl;
-        return -1;
+    m_readAhead = nbBlocks;
+    if (m_readAhead<=0)
+      cancelPrefetch();
+  }
+
+  void AudioFileProcessor::setResampleQuality(const std::string& quality)
+  {
+    m_resampleQuality = quality;
+  }
+
+  int AudioFileProcessor::selectReader(const std::string& filename, std::string& readerComponent)
+  {
+    ComponentFactory* factory = ComponentFactory::instance();
+    std::string lowerFilename = filename;
+    transform(lowerFilename.begin(),lowerFilename.end(),lowerFilename.begin(),::tolower);
+    if (hasEnding(lowerFilename,"mp3")) {
+      if (!factory->exists("MP3FileReader")) {
+        cerr << "ERROR: cannot read mp3 file ! please compile yaafe with mpg123 support" << endl;
+        return -4;
       }
-      if (inputs[0]!="audio") {
-        cerr << "ERROR: root node is not 'audio' node !" << endl;
-        return -2;
+      readerComponent = "MP3FileReader";
+    } else {
+      if (!factory->exists("AudioFileReader")) {
+        cerr << "ERROR: please compile yaafe with libsndfile support" << endl;
+        return -3;
       }
+      readerComponent = "AudioFileReader";
     }
+    return 0;
+  }
 
-    int exitCode = 0;
-    ComponentFactory* factory = ComponentFactory::instance();
-    Component* reader = NULL;
-    std::vector<pair<string,Component*> > writers;
+  ParameterMap AudioFileProcessor::readerParameters(Engine& engine, const std::string& filename)
+  {
+    vector<string> inputs = engine.getInputs();
+    ParameterMap params = engine.getInputParams(inputs[0]);
+    if (inputs.size()>1) {
+      // decode at the file sample rate, each input resamples
+      params["SampleRate"] = "0";
+      params["Resample"] = "no";
+    }
+    params["File"] = filename;
+    if (m_readAhead>0) {
+      ostringstream oss;
+      oss << m_readAhead;
+      params["ReadAheadBlocks"] = oss.str();
+    }
+    if (!m_resampleQuality.empty())
+      params["ResampleQuality"] = m_resampleQuality;
+    return params;
+  }
 
-    cerr << "process file " << filename << endl;
-    clock_t end;
-    clock_t start = clock();
+  void AudioFileProcessor::prefetch(Engine& engine, const std::string& filename)
+  {
+    std::string readerComponent;
+    if (selectReader(filename,readerComponent)!=0)
+      return;
+    Component* reader = ComponentFactory::instance()->createComponent(readerComponent);
+    m_prefetch = new Prefetch(filename,reader,readerParameters(engine,filename),
+        engine.config());
+    if (!m_prefetch->start()) {
+      // no threads, file will be opened when processed
+      delete m_prefetch;
+      m_prefetch = NULL;
+    }
+  }
 
-    // reset engine state
-    engine.reset();
+  void AudioFileProcessor::cancelPrefetch()
+  {
+    if (m_prefetch) {
+      delete m_prefetch;
+      m_prefetch = NULL;
+    }
+  }
 
-    // determine audio file format and select appropriate reader
-    std::string readerComponent = "";
-    {
-      std::string lowerFilename = filename;
-      transform(lowerFilename.begin(),lowerFilename.end(),lowerFilename.begin(),::tolower);
-      if (hasEnding(lowerFilename,"mp3")) {
-        if (!factory->exists("MP3FileReader")) {
-          cerr << "ERROR: cannot read mp3 file ! please compile yaafe with mpg123 support" << endl;
-          return -4;
-        }
-        readerComponent = "MP3FileReader";
-      } else {
-        if (!factory->exists("AudioFileReader")) {
-          cerr << "ERROR: please compile yaafe with libsndfile support" << endl;
-          return -3;
+  int AudioFileProcessor::processFile(Engine& engine, const std::string& filename,
+      const std::string& nextFilename)
+  {
+    // readers and writers get the engine configuration
+    EngineConfig::Scope scope(engine.config());
+    // check engine inputs, all inputs are fed by a single reader
+    vector<string> inputs = engine.getInputs();
+    if (inputs.empty()) {
+      cerr << "ERROR: dataflow has no input node" << endl;
+      return -1;
+    }
+    for (int i=1;i<inputs.size();i++) {
+      static const char* decodeParams[] = { "TimeStart", "TimeLimit", "RemoveMean", "ScaleMax" };
+      ParameterMap p0 = engine.getInputParams(inputs[0]);
+      ParameterMap p = engine.getInputParams(inputs[i]);
+      for (int k=0;k<4;k++) {
+        if (p0[decodeParams[k]]!=p[decodeParams[k]]) {
+          cerr << "ERROR: inputs " << inputs[0] << " and " << inputs[i] << " have different "
+            << decodeParams[k] << " parameters !" << endl;
+          return -2;
         }
-        readerComponent = "AudioFileReader";
       }
     }
 
-    // initialize reader
-    ParameterMap readerParams = engine.getInputParams("audio");
-    readerParams["File"] = filename;
-    reader = factory->createComponent(readerComponent);
-    Ports<StreamInfo> inports;
-    if (!reader->init(readerParams,inports)) {
-      cerr << "ERROR: cannot initialize reader " << readerComponent << " for file " << filename << endl;
-      exitCode = -6; goto exit;
-    }
+    int exitCode = 0;
+    ComponentFactory* factory = ComponentFactory::instance();
+    Component* reader = NULL;
+    SharedDecode* decode = NULL;
+    std::vector<AudioInput*> audioInputs;
+    std::vector<pair<string,Component*> > writers;
 
-    // bind audio input
-    if (!engine.bindInput("audio",reader)) {
-      cerr << "ERROR: cannot bind audio reader" << endl;
-      exitCode = -7; goto exit;
-    }
+    cerr << "process file " << filename << endl;
+    clock_t end;
+    clock_t start = clock();
 
-    // configure outputs
+    // create writers first, outputs already up to date are not bound
+    // and then not computed
     if (m_format)
     {
       vector<string> outputs = engine.getOutputs();
@@ -143,9 +314,92 @@ namespace YAAFE {
           cerr << "ERROR: cannot initialize writer for output " << outName << endl;
           exitCode = -8; goto exit;
         }
-        engine.bindOutput(outName,writer);
+        if (!writer->needsInput()) {
+          delete writer;
+          continue;
+        }
         writers.push_back(make_pair(outName,writer));
       }
+      if (writers.empty()) {
+        cerr << "all outputs are up to date, skip file " << filename << endl;
+        cancelPrefetch();
+        if (m_readAhead>0 && !nextFilename.empty())
+          prefetch(engine,nextFilename);
+        goto exit;
+      }
+      // compute bound outputs only
+      engine.selectOutputs(vector<string>());
+    }
+
+    // reset engine state
+    engine.reset();
+
+    // bind outputs
+    for (int i=0;i<writers.size();i++)
+      engine.bindOutput(writers[i].first,writers[i].second);
+
+    if (m_prefetch && m_prefetch->filename==filename) {
+      // reader has been initialized while processing previous file
+      m_prefetch->join();
+      reader = m_prefetch->reader;
+      m_prefetch->reader = NULL;
+      bool ok = m_prefetch->ok;
+      cancelPrefetch();
+      if (!ok) {
+        cerr << "ERROR: cannot initialize reader for file " << filename << endl;
+        exitCode = -6; goto exit;
+      }
+    } else {
+      cancelPrefetch();
+
+      // determine audio file format and select appropriate reader
+      std::string readerComponent = "";
+      exitCode = selectReader(filename,readerComponent);
+      if (exitCode!=0)
+        goto exit;
+
+      // initialize reader
+      ParameterMap readerParams = readerParameters(engine,filename);
+      reader = factory->createComponent(readerComponent);
+      Ports<StreamInfo> inports;
+      if (!reader->init(readerParams,inports)) {
+        cerr << "ERROR: cannot initialize reader " << readerComponent << " for file " << filename << endl;
+        exitCode = -6; goto exit;
+      }
+    }
+
+    // open next file while this one is processed
+    if (m_readAhead>0 && !nextFilename.empty())
+      prefetch(engine,nextFilename);
+
+    // bind audio inputs
+    if (inputs.size()==1) {
+      if (!engine.bindInput(inputs[0],reader)) {
+        cerr << "ERROR: cannot bind audio reader" << endl;
+        exitCode = -7; goto exit;
+      }
+    } else {
+      // audio is decoded once and resampled once per input
+      if (!factory->exists("AudioResampler")) {
+        cerr << "ERROR: cannot find AudioResampler component" << endl;
+        exitCode = -7; goto exit;
+      }
+      decode = new SharedDecode(reader);
+      reader = NULL;
+      for (int i=0;i<inputs.size();i++) {
+        if (!engine.isActive(inputs[i]))
+          continue; // no bound or selected output needs this input
+        AudioInput* input = new AudioInput(decode,factory->createComponent("AudioResampler"));
+        audioInputs.push_back(input);
+        ParameterMap params = engine.getInputParams(inputs[i]);
+        if (!m_resampleQuality.empty())
+          params["ResampleQuality"] = m_resampleQuality;
+        if (!input->init(params,decode->reader->getOutStreamInfo())
+            || !engine.bindInput(inputs[i],input)) {
+          cerr << "ERROR: cannot bind audio input " << inputs[i] << endl;
+          exitCode = -7; goto exit;
+        }
+      }
     }
 
     // process audio
@@ -161,7 +415,11 @@ namespace YAAFE {
 
 exit:
       // detach and release reader
-      engine.detachInput("audio");
+      for (int i=0;i<inputs.size();i++)
+        engine.detachInput(inputs[i]);
+      for (int i=0;i<audioInputs.size();i++)
+        delete audioInputs[i];
+      if (decode) delete decode;
       if (reader) delete reader;
       // detach and release writers
       vector<string> outputs  = engine.getOutputs();
@@ -170,6 +428,8 @@ exit:
         delete it->second;
       }
       writers.clear();
+      if (m_format)
+        engine.selectAllOutputs();
       return exitCode;
   }
 
@@ -37,9 +37,37 @@ namespace YAAFE {
      virtual ~AudioFileProcessor();
 
      bool setOutputFormat(const std::string& format, const std::string& outdir, const ParameterMap& params);
-     int processFile(Engine& engine, const std::string& filename);
+
+     /**
+      * Decode audio nbBlocks blocks in advance in a background thread,
+      * 0 (default) to decode when needed. When enabled, the file given as
+      * nextFilename to processFile is also opened and decoding starts
+      * while the current file is processed.
+      */
+     void setReadAhead(int nbBlocks);
+
+     /**
+      * Set resampling quality ("high", "medium" or "fast") of audio readers,
+      * overriding the ResampleQuality parameter of the dataflow input.
+      */
+     void setResampleQuality(const std::string& quality);
+
+     int processFile(Engine& engine, const std::string& filename,
+         const std::string& nextFilename = "");
    private:
+     class Prefetch;
+     class SharedDecode;
+     class AudioInput;
+
      OutputFormat* m_format;
+     int m_readAhead;
+     std::string m_resampleQuality;
+     Prefetch* m_prefetch;
+
+     int selectReader(const std::string& filename, std::string& readerComponent);
+     ParameterMap readerParameters(Engine& engine, const std::string& filename);
+     void prefetch(Engine& engine, const std::string& filename);
+     void cancelPrefetch();
   };
 
 }
@@ -23,6 +23,7 @@
  */
 
 #include "Buffer.h"
+#include "EngineConfig.h"
 #include "utils.h"
 #include <assert.h>
 #include <vector>
@@ -30,6 +31,9 @@
 #include <string.h>
 
 #define PREFERRED_DATABLOCK_SIZE 8192
+// leaves room in a 256 KiB L2 cache for the input and output blocks of a
+// step and for its state
+#define DATABLOCK_BYTES 32768
 
 using namespace std;
 
@@ -75,20 +79,42 @@ namespace YAAFE {
   int DataBlock::s_preferedBlockSize(PREFERRED_DATABLOCK_SIZE);
 
   int DataBlock::preferedBlockSize() {
-    return s_preferedBlockSize;
+    return EngineConfig::current().preferedBlockSize();
   }
 
   void DataBlock::setPreferedBlockSize(int size) {
     s_preferedBlockSize = size;
   }
 
+  int DataBlock::s_blockBytes(DATABLOCK_BYTES);
+
+  int DataBlock::blockBytes() {
+    return EngineConfig::current().blockBytes();
+  }
+
+  void DataBlock::setBlockBytes(int bytes) {
+    s_blockBytes = bytes;
+  }
+
+  int DataBlock::defaultTokens(int size, SampleType type) {
+    const int blockSize = min(preferedBlockSize(), blockBytes() / sampleBytes(type));
+    return (size>blockSize ? 1 : blockSize / size);
+  }
+
   DataBlock* DataBlock::create(int size) {
+    return create(size, defaultTokens(size));
+  }
+
+  DataBlock* DataBlock::create(int size, int maxtokens, SampleType type) {
     DataBlock* db = new DataBlock();
     db->size = size;
     db->tokens = 0;
     db->numref = 1;
-    db->maxtokens = (size>s_preferedBlockSize ? 1 : s_preferedBlockSize / size);
-    db->data = new double[db->size*db->maxtokens];
+    db->maxtokens = maxtokens;
+    db->type = type;
+    // float blocks use half of the doubles, rounded up
+    const int values = db->size*db->maxtokens;
+    db->data = new double[type==FLOAT_SAMPLES ? (values+1)/2 : values];
     return db;
   }
 
@@ -107,7 +133,7 @@ namespace YAAFE {
 
 
   InputBuffer::InputBuffer(const StreamInfo& info) :
-    _info(info), _data(), _pos(0), _tokenno(0), _queue()
+    _info(info), _type(DOUBLE_SAMPLES), _data(), _tokenno(0), _pos(0), _end(0), _queue()
   {}
 
   InputBuffer::~InputBuffer()
@@ -135,13 +161,11 @@ namespace YAAFE {
   int InputBuffer::availableTokens() {
     if (_data==NULL)
       blockConsume();
-    int av = (_data ? _data->tokens - _pos : 0);
-    for (list<DataBlock*>::const_iterator it=_queue.begin(); it!=_queue.end(); it++)
-      av += (*it)->tokens;
-    return av;
+    return _end - tokenno();
   }
 
   int InputBuffer::read(double* buf,int toks) {
+    assert(_type==DOUBLE_SAMPLES);
     if (_data==NULL) {
       blockConsume();
       if (_data==NULL)
@@ -169,6 +193,7 @@ namespace YAAFE {
     _data = NULL;
     _pos = 0;
     _tokenno = 0;
+    _end = 0;
   }
 
   void InputBuffer::consumeTokens(int toks) {
@@ -211,11 +236,9 @@ namespace YAAFE {
       if (_data!=NULL) {
         _queue.push_front(_data);
       }
-      _data = DataBlock::create(_info.size);
+      _data = DataBlock::create(_info.size, DataBlock::defaultTokens(_info.size,_type), _type);
       int toWrite = min(toks-written,_data->maxtokens);
-      double* d=_data->data;
-      for (int i=0;i<(toWrite * _info.size);i++)
-        d[i] = 0.0;
+      memset(_data->data,0,toWrite * _info.size * sampleBytes(_type));
       _data->tokens=toWrite;
       written+=toWrite;
     }
@@ -225,15 +248,14 @@ namespace YAAFE {
   void InputBuffer::appendZeros(int toks) {
     int written = 0;
     while (written<toks) {
-      DataBlock* db = DataBlock::create(_info.size);
+      DataBlock* db = DataBlock::create(_info.size, DataBlock::defaultTokens(_info.size,_type), _type);
       int toWrite = min(toks-written,db->maxtokens);
-      double* d=db->data;
-      for (int i=0;i<(toWrite * _info.size);i++)
-        d[i] = 0.0;
+      memset(db->data,0,toWrite * _info.size * sampleBytes(_type));
       db->tokens=toWrite;
       written+=toWrite;
       _queue.push_back(db);
     }
+    _end += toks;
   }
 
 
@@ -258,9 +280,10 @@ namespace YAAFE {
   }
 
   OutputBuffer::OutputBuffer(const StreamInfo& info) :
-    _info(info), _queue(), _tokenno(0)
+    _info(info), _type(DOUBLE_SAMPLES), _queue(), _tokenno(0), _allocated(1),
+    _blockTokens(DataBlock::defaultTokens(info.size))
   {
-    _data = DataBlock::create(_info.size);
+    _data = DataBlock::create(_info.size, _blockTokens);
   }
 
   OutputBuffer::~OutputBuffer()
@@ -273,10 +296,34 @@ namespace YAAFE {
   void OutputBuffer::nextBlock() {
     //	cerr << "OutputBuffer::nextBlock()" << endl;
     _queue.push_back(_data);
-    _data = DataBlock::create(_info.size);
+    _data = DataBlock::create(_info.size, _blockTokens, _type);
+    _allocated++;
+  }
+
+  void OutputBuffer::setBlockTokens(int tokens) {
+    _blockTokens = (tokens>0 ? tokens : 1);
+    if (_data->tokens==0 && _data->maxtokens!=_blockTokens) {
+      DataBlock::release(_data);
+      _data = DataBlock::create(_info.size, _blockTokens, _type);
+      _allocated++;
+    }
+  }
+
+  void OutputBuffer::setSampleType(SampleType type) {
+    assert(_data->tokens==0 && _queue.empty());
+    for (list<InputBuffer*>::iterator it=_readers.begin();
+        it!=_readers.end(); it++)
+      (*it)->_type = type;
+    if (type==_type)
+      return;
+    _type = type;
+    DataBlock::release(_data);
+    _data = DataBlock::create(_info.size, _blockTokens, _type);
+    _allocated++;
   }
 
   int OutputBuffer::write(double* buf,int toks) {
+    assert(_type==DOUBLE_SAMPLES);
     int written = 0;
     while (written<toks) {
       int toWrite = min(_data->maxtokens-_data->tokens,toks-written);
@@ -292,6 +339,11 @@ namespace YAAFE {
 
   void OutputBuffer::bindInputBuffer(InputBuffer* r) {
     _readers.push_back(r);
+    r->_type = _type;
+  }
+
+  void OutputBuffer::unbindInputBuffer(InputBuffer* r) {
+    _readers.remove(r);
   }
 
   void OutputBuffer::dispatch() {
@@ -305,6 +357,7 @@ namespace YAAFE {
       for (list<DataBlock*>::iterator dbit=_queue.begin();dbit!=_queue.end();dbit++) {
         DataBlock::acquire(*dbit);
         q.push_back(*dbit);
+        (*it)->_end += (*dbit)->tokens;
       }
       if ((*it)->_data==NULL)
       {
@@ -61,6 +61,27 @@ namespace YAAFE
 
   std::ostream& operator<<(std::ostream& os, const StreamInfo& si);
 
+  /**
+   * Type of the values of a data stream. Streams hold doubles, except
+   * streams between components that can exchange single precision values
+   * (see Component::canReadFloat).
+   */
+  enum SampleType { DOUBLE_SAMPLES, FLOAT_SAMPLES };
+
+  /**
+   * Size in bytes of a value of the given type
+   */
+  inline int sampleBytes(SampleType type) {
+    return (type==FLOAT_SAMPLES) ? (int) sizeof(float) : (int) sizeof(double);
+  }
+
+  /**
+   * SampleTypeOf<T>::value is the sample type of values of type T
+   */
+  template<class T> struct SampleTypeOf;
+  template<> struct SampleTypeOf<double> { static const SampleType value = DOUBLE_SAMPLES; };
+  template<> struct SampleTypeOf<float> { static const SampleType value = FLOAT_SAMPLES; };
+
   /**
    * DataBlock manage a memory block used to store numerical data streams.
    * It's usually created by an OutputBuffer and filled with data. Then can
@@ -71,11 +92,12 @@ namespace YAAFE
    public:
      ~DataBlock();
 
-     int size; // dimension of a token (each dimension is a double)
+     int size; // dimension of a token (number of values)
      int tokens; // number of tokens in the data block
      int maxtokens; // maximum number of tokens in the allocated memory block
      int numref; // number of reference to this block
-     double* data; // pointer to data
+     SampleType type; // type of the values
+     double* data; // pointer to data, holds floats if type is FLOAT_SAMPLES
 
      /**
       * Return how many tokens can be written in the remaining memory.
@@ -92,11 +114,31 @@ namespace YAAFE
       */
      inline const double* operator[](size_t i) const { return data + size * i; };
 
+     /**
+      * Return a pointer to the i-th token of a block holding values of
+      * type T
+      */
+     template<class T>
+       inline T* token(size_t i) { return reinterpret_cast<T*>(data) + size * i; };
+
      /**
       * Create a data block with the given token size.
       */
      static DataBlock* create(int size);
 
+     /**
+      * Create a data block with the given token size, able to store
+      * maxtokens tokens.
+      */
+     static DataBlock* create(int size, int maxtokens, SampleType type = DOUBLE_SAMPLES);
+
+     /**
+      * Return the default number of tokens of blocks of the given token
+      * size, according to the prefered block size and to the block byte
+      * budget.
+      */
+     static int defaultTokens(int size, SampleType type = DOUBLE_SAMPLES);
+
      /**
       * acquire a reference to a data block
       */
@@ -108,22 +150,39 @@ namespace YAAFE
      static void release(DataBlock* db);
 
      /**
-      * Get the prefered block size. If possible, the create method will create
+      * Get the prefered block size of the engine running in the calling
+      * thread (see EngineConfig). If possible, the create method will create
       * blocks of this size (total number of doubles)
       */
      static int preferedBlockSize();
 
      /**
-      * Set the prefered block size.
+      * Set the process-wide default prefered block size, used by engines
+      * whose configuration does not set it.
       */
      static void setPreferedBlockSize(int size);
 
+     /**
+      * Get the target size in bytes of data blocks of the engine running in
+      * the calling thread (see EngineConfig). Blocks of wide streams hold
+      * fewer tokens so that the blocks read and written by a step stay in
+      * the L2 cache.
+      */
+     static int blockBytes();
+
+     /**
+      * Set the process-wide default target size of data blocks in bytes.
+      */
+     static void setBlockBytes(int bytes);
+
    private:
      DataBlock();
      DataBlock(const DataBlock& db);
      DataBlock& operator=(const DataBlock& db);
 
+     friend class EngineConfig;
      static int s_preferedBlockSize;
+     static int s_blockBytes;
   };
 
   /**
@@ -180,10 +239,21 @@ namespace YAAFE
     int tokenno() const { return _tokenno + _pos; };
 
     /**
-     * Get the token size (number of double)
+     * Get the token number following the last token written to the buffer
+     */
+    int endTokenno() const { return _end; };
+
+    /**
+     * Get the token size (number of values)
      */
     int size() const { return _info.size; }
 
+    /**
+     * Returns the type of the values of the stream, set by the engine. Its
+     * tokens are read with the accessors templated on the matching C++ type.
+     */
+    SampleType sampleType() const { return _type; }
+
     /**
      * Returns true if no token is available
      */
@@ -193,7 +263,9 @@ namespace YAAFE
      * Return a pointer to the current token. The pointer is valid
      * as long as the current has not been consumed.
      */
-    double* readToken() { return (*_data)[_pos]; };
+    double* readToken() { return readToken<double>(); };
+    template<class T>
+      T* readToken() { assert(_type==SampleTypeOf<T>::value); return _data->token<T>(_pos); };
 
     /**
      * Consume the current token.
@@ -213,11 +285,13 @@ namespace YAAFE
     /**
      * Returns a pointer to the i-th token.
      */
-    inline double* token(int i);
+    double* token(int i) { return token<double>(i); }
+    template<class T>
+      inline T* token(int i);
 
     /**
      * Read toks tokens into a buffer. The buffer must have enough memory allocated
-     * to store size*toks doubles.
+     * to store size*toks doubles. The stream must hold doubles.
      */
     int read(double* buf,int toks);
 
@@ -235,7 +309,9 @@ namespace YAAFE
      * Returns a pointer to the i-th tokens assuming that it is in the current contiguous
      * memory block
      */
-    double* blockToken(int i) { return (*_data)[_pos+i]; }
+    double* blockToken(int i) { return blockToken<double>(i); }
+    template<class T>
+      T* blockToken(int i) { assert(_type==SampleTypeOf<T>::value); return _data->token<T>(_pos+i); }
 
     /**
      * Consume the current memory block
@@ -257,6 +333,11 @@ namespace YAAFE
      */
     void clear();
 
+    /**
+     * Returns how many data blocks are waiting to be read
+     */
+    int queuedBlocks() const { return _queue.size() + ((_data==NULL) ? 0 : 1); }
+
     // just for debugging
     void debug();
 
@@ -265,9 +346,11 @@ namespace YAAFE
     InputBuffer(const InputBuffer& in) {};
 
     StreamInfo _info;
+    SampleType _type;
     DataBlock* _data;
     int _tokenno;
     int _pos;
+    int _end;
     std::list<DataBlock*> _queue;
 
   };
@@ -287,6 +370,7 @@ namespace YAAFE
 
      int size() const { return _info.size; } // token size
      const StreamInfo& info() const { return _info; } // data stream info
+     SampleType sampleType() const { return _type; } // type of the values
 
      /**
       * returns how many tokens can be written in the remaining
@@ -297,10 +381,20 @@ namespace YAAFE
      /**
       * Get a pointer where to write a token
       */
-     inline double* writeToken();
+     double* writeToken() { return writeToken<double>(); }
+     template<class T>
+       inline T* writeToken();
 
      /**
-      * Write the toks tokens from buffer buf
+      * Get a pointer where to write toks contiguous tokens. toks must not
+      * exceed remainingSpace().
+      */
+     double* writeTokens(int toks) { return writeTokens<double>(toks); }
+     template<class T>
+       inline T* writeTokens(int toks);
+
+     /**
+      * Write the toks tokens from buffer buf. The stream must hold doubles.
       */
      int write(double* buf,int toks);
 
@@ -309,6 +403,28 @@ namespace YAAFE
       */
      int tokenno() const { return _tokenno; };
 
+     /**
+      * Return how many data blocks have been allocated by this buffer
+      */
+     int allocatedBlocks() const { return _allocated; };
+
+     /**
+      * Number of tokens of the data blocks allocated by this buffer
+      */
+     int blockTokens() const { return _blockTokens; };
+
+     /**
+      * Set the number of tokens of the data blocks allocated by this
+      * buffer. Blocks already holding data are not resized.
+      */
+     void setBlockTokens(int tokens);
+
+     /**
+      * Set the type of the values of the stream and of its bound input
+      * buffers. The buffer must not hold data yet.
+      */
+     void setSampleType(SampleType type);
+
 
      /**
       * Methods used by engine
@@ -316,6 +432,7 @@ namespace YAAFE
 
      // bind to an input buffer
      void bindInputBuffer(InputBuffer* r);
+     void unbindInputBuffer(InputBuffer* r);
 
      // dispatch all complete data block to bound input buffers
      void dispatch();
@@ -333,15 +450,31 @@ namespace YAAFE
      void nextBlock();
 
      StreamInfo _info;
+     SampleType _type;
      DataBlock* _data;
      std::list<DataBlock*> _queue;
      std::list<InputBuffer*> _readers;
      int _tokenno;
+     int _allocated;
+     int _blockTokens;
   };
 
-  double* OutputBuffer::writeToken() {
+  template<class T>
+  T* OutputBuffer::writeToken() {
+    assert(_type==SampleTypeOf<T>::value);
     _tokenno++;
-    double* d = (*_data)[_data->tokens++];
+    T* d = _data->token<T>(_data->tokens++);
+    if (_data->remaining()==0) nextBlock();
+    return d;
+  }
+
+  template<class T>
+  T* OutputBuffer::writeTokens(int toks) {
+    assert(toks<=_data->remaining());
+    assert(_type==SampleTypeOf<T>::value);
+    _tokenno += toks;
+    T* d = _data->token<T>(_data->tokens);
+    _data->tokens += toks;
     if (_data->remaining()==0) nextBlock();
     return d;
   }
@@ -350,15 +483,17 @@ namespace YAAFE
     return new OutputBuffer(info);
   }
 
-  inline double* InputBuffer::token(int i) {
+  template<class T>
+  T* InputBuffer::token(int i) {
+    assert(_type==SampleTypeOf<T>::value);
     if (i<(_data->tokens-_pos))
-      return (*_data)[_pos+i];
+      return _data->token<T>(_pos+i);
     i -= _data->tokens-_pos;
     for (std::list<DataBlock*>::const_iterator it=_queue.begin();
         it!=_queue.end();it++)
     {
       if (i<(*it)->tokens)
-        return (**it)[i];
+        return (*it)->token<T>(i);
       i -= (*it)->tokens;
     }
     return NULL;
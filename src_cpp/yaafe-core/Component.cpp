@@ -79,4 +79,23 @@ namespace YAAFE
     return atof(getStringParam(id, params).c_str());
   }
 
+  ParameterDescriptor Component::kernelPrecisionParameter()
+  {
+    ParameterDescriptor p;
+    p.m_identifier = KERNEL_PRECISION_PARAM;
+    p.m_description = "Precision of the component kernel: auto|double|float. float uses a single-precision kernel, faster but less accurate, and exchanges single precision streams with the components also using it when the engine enables single-precision kernels. auto uses float only when the engine enables single-precision kernels.";
+    p.m_defaultValue = "auto";
+    return p;
+  }
+
+  bool Component::useFloatKernel(const ParameterMap& params)
+  {
+    string precision = getStringParam(KERNEL_PRECISION_PARAM, params);
+    if (precision=="float")
+      return true;
+    if (precision!="double" && precision!="auto")
+      cerr << "WARNING: invalid " << KERNEL_PRECISION_PARAM << " parameter " << precision << ", use double" << endl;
+    return false;
+  }
+
 }
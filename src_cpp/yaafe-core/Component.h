@@ -33,6 +33,17 @@
 #include <vector>
 #include <map>
 
+/**
+ * Parameter declared by components having a single precision kernel.
+ * Its value is "auto" (default), "double" or "float". The engine replaces
+ * "auto" by "float" when single precision kernels are enabled, else
+ * "auto" means "double". With single precision kernels enabled, a stream
+ * holds floats when its producer can write them and all its consumers can
+ * read them (see Component::canWriteFloat and Component::canReadFloat),
+ * other streams stay double.
+ */
+#define KERNEL_PRECISION_PARAM "KernelPrecision"
+
 namespace YAAFE {
 
   /**
@@ -69,6 +80,18 @@ namespace YAAFE {
       */
      virtual Component* clone() const = 0;
 
+     /**
+      * Return a new instance already initialized as this one, sharing its
+      * immutable state (kernels, filter banks, plans) and with its own
+      * per-stream state. Return NULL if the component has to be
+      * initialized again (default). Used by Engine::clone.
+      * Implementations using the copy constructor also copy the
+      * per-stream state of this instance, the copy is reset before use.
+      * Components with per-stream state not cleared by reset() must clear
+      * it in copy(), or not implement copy().
+      */
+     virtual Component* copy() const { return NULL; }
+
      /**
       * A component is stateless if it doesn't hold any information between sucessive calls
       * to init, process and flush methods. If so, it can be used to process several
@@ -76,6 +99,28 @@ namespace YAAFE {
       */
      virtual bool stateLess() const { return false; }
 
+     /**
+      * Returns false if the component, once initialized, does not need
+      * its input data, for example a writer whose output file is already
+      * up to date. Then the data feeding it does not need to be computed.
+      */
+     virtual bool needsInput() const { return true; }
+
+     /**
+      * Returns true if the component, once initialized, can read single
+      * precision values from its i-th input port. The engine sets the sample
+      * type of the input buffers before the first reset, components check it
+      * with InputBuffer::sampleType. Default is false.
+      */
+     virtual bool canReadFloat(int port) const { return false; }
+
+     /**
+      * Returns true if the component, once initialized, can write single
+      * precision values to its i-th output port, checked with
+      * OutputBuffer::sampleType. Default is false.
+      */
+     virtual bool canWriteFloat(int port) const { return false; }
+
      /**
       * Returns the list of acceptable parameters
       */
@@ -112,6 +157,16 @@ namespace YAAFE {
      int getIntParam(const std::string& id, const ParameterMap& params);
      double getDoubleParam(const std::string& id, const ParameterMap& params);
 
+     /**
+      * Descriptor of the KERNEL_PRECISION_PARAM parameter
+      */
+     static ParameterDescriptor kernelPrecisionParameter();
+     /**
+      * Returns true if the KERNEL_PRECISION_PARAM parameter asks for the
+      * single precision kernel.
+      */
+     bool useFloatKernel(const ParameterMap& params);
+
      Ports<StreamInfo>& outStreamInfo();
 
    private:
@@ -68,33 +68,43 @@ namespace YAAFE {
     }
   }
 
+  static string versionString()
+  {
+    ostringstream oss;
+    oss << VERSION;
+    return oss.str();
+  }
+
   const char* ComponentFactory::version()
   {
-    static string v;
-    if (v.size()==0) {
-      ostringstream oss;
-      oss << VERSION;
-      v = oss.str();
-    }
+    static const string v = versionString();
     return v.c_str();
   }
 
 
+  ComponentFactory* ComponentFactory::s_instance = NULL;
+  Mutex ComponentFactory::s_instanceMutex;
+
   ComponentFactory* ComponentFactory::instance() {
-    static ComponentFactory* instance = new ComponentFactory();
-    return instance;
+    MutexLock lock(s_instanceMutex);
+    if (!s_instance)
+      s_instance = new ComponentFactory();
+    return s_instance;
   }
 
   void ComponentFactory::destroy() {
-    ComponentFactory* fact = instance();
-    delete fact;
+    MutexLock lock(s_instanceMutex);
+    delete s_instance;
+    s_instance = NULL;
   }
 
-  const std::vector<const Component*>& ComponentFactory::getPrototypeList() {
+  std::vector<const Component*> ComponentFactory::getPrototypeList() {
+    MutexLock lock(m_mutex);
     return m_prototypes;
   }
 
   const Component* ComponentFactory::getPrototype(const std::string& identifier) {
+    MutexLock lock(m_mutex);
     for (vector<const Component*>::const_iterator it = m_prototypes.begin(); it
         != m_prototypes.end(); it++) {
       if ((*it)->getIdentifier() == identifier)
@@ -106,6 +116,7 @@ namespace YAAFE {
 
   bool ComponentFactory::exists(const std::string& id)
   {
+    MutexLock lock(m_mutex);
     for (vector<const Component*>::const_iterator it=m_prototypes.begin();
         it!=m_prototypes.end(); it++)
       if ((*it)->getIdentifier()==id)
@@ -135,11 +146,16 @@ namespace YAAFE {
   }
 
   int ComponentFactory::loadLibrary(const std::string& libnamestr) {
-
-    if (m_libs.find(libnamestr)!=m_libs.end())
+    // registration function of the library calls registerPrototype, so
+    // only loading is serialized here
+    MutexLock loadLock(m_loadMutex);
     {
-      // library already loaded
-      return 0;
+      MutexLock lock(m_mutex);
+      if (m_libs.find(libnamestr)!=m_libs.end())
+      {
+        // library already loaded
+        return 0;
+      }
     }
 
     std::string complete_name = "lib" + libnamestr + YAAFE_DYNLIB_EXTENSION;
@@ -183,7 +199,10 @@ namespace YAAFE {
       return -2;
     }
 
-    m_libs[libnamestr] = library;
+    {
+      MutexLock lock(m_mutex);
+      m_libs[libnamestr] = library;
+    }
 
     typedef void (*yaafelib_register_function_type)(void*);
     yaafelib_register_function_type func =
@@ -195,6 +214,7 @@ namespace YAAFE {
   }
 
   void ComponentFactory::registerPrototype(const Component* p) {
+    MutexLock lock(m_mutex);
     m_prototypes.push_back(p);
   }
 
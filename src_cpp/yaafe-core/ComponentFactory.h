@@ -27,11 +27,17 @@
 
 #include "Component.h"
 #include "DataFlow.h"
+#include "Thread.h"
 
 #define LIBRARY_HANDLER void*
 
 namespace YAAFE {
 
+  /**
+   * Registry of component prototypes. All methods can be called from
+   * several threads: libraries are loaded one at a time, and registered
+   * prototypes are kept until destroy() is called.
+   */
   class ComponentFactory {
    public:
      virtual ~ComponentFactory();
@@ -40,7 +46,7 @@ namespace YAAFE {
      static ComponentFactory* instance(); // sigleton access method
      static void destroy(); // release memory
 
-     const std::vector<const Component*>& getPrototypeList();
+     std::vector<const Component*> getPrototypeList();
      const Component* getPrototype(const std::string& identifier);
      bool exists(const std::string& identifier);
      Component* createComponent(const std::string& identifier);
@@ -54,6 +60,11 @@ namespace YAAFE {
 
      std::map<std::string,LIBRARY_HANDLER> m_libs;
      std::vector<const Component*> m_prototypes;
+     Mutex m_loadMutex; // held while loading a library
+     Mutex m_mutex; // protects m_libs and m_prototypes
+
+     static ComponentFactory* s_instance;
+     static Mutex s_instanceMutex;
 
   };
 
@@ -36,6 +36,7 @@ namespace YAAFE
   template<class T>
     class StateLessOneInOneOutComponent : public Component
   {
+   public:
     virtual const std::string getIdentifier() const  = 0;
     virtual const std::string getDescription() const { return "";}
     virtual bool stateLess() const { return true; };
@@ -214,6 +215,175 @@ namespace YAAFE
       process(inp,outp);
     }
 
+  /**
+   * Base of integrators computing one output token from a window of
+   * NbFrames input frames every StepNbFrames frames. Windows are centered:
+   * NbFrames/2 zero frames are prepended and (NbFrames-1)/2 appended when
+   * flushing. The window is kept contiguous in memory.
+   *
+   * The derived class T implements initIntegrator, setting the size of the
+   * output stream (other fields are already set), and
+   *
+   *   void emit(const double* window, double* out);
+   *
+   * called with the NbFrames frames of the window (oldest first, one token
+   * after the other). To update its state incrementally, T can also redefine
+   *
+   *   void resetWindow();                          // window is empty
+   *   void addFrame(const double* frame, int pos); // frame enters at pos
+   *   void removeFrame(const double* frame, int pos); // frame at pos leaves
+   *   void advanceWindow(int shift);               // positions decrease by shift
+   *
+   * where pos is the frame position in the current window.
+   */
+  template<class T>
+    class WindowedIntegrator : public Component
+  {
+   public:
+     WindowedIntegrator();
+     virtual ~WindowedIntegrator();
+
+     virtual const std::string getIdentifier() const  = 0;
+     virtual const std::string getDescription() const { return "";}
+     virtual bool stateLess() const { return false; };
+
+     virtual Component* clone() const { return new T();}
+     virtual int getRevision() const { return 0; }
+
+     virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& inp);
+     virtual void reset();
+     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+     virtual void flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+
+     void resetWindow() {}
+     void addFrame(const double* frame, int pos) {}
+     void removeFrame(const double* frame, int pos) {}
+     void advanceWindow(int shift) {}
+
+   protected:
+     virtual bool initIntegrator(const ParameterMap& params, const StreamInfo& in, StreamInfo& out) = 0;
+
+     int m_nbFrames;
+     int m_stepNbFrames;
+     int m_size;
+
+   private:
+     double* m_window; // 2*m_nbFrames frames, each frame stored twice
+     int m_pos; // where next frame is stored
+     int m_count; // number of frames in window
+     int m_skip; // frames to skip before next window, if step > NbFrames
+     bool m_started; // leading zeros have been prepended
+  };
+
+  template<class T>
+    WindowedIntegrator<T>::WindowedIntegrator() :
+      m_nbFrames(0), m_stepNbFrames(0), m_size(0), m_window(NULL),
+      m_pos(0), m_count(0), m_skip(0), m_started(false)
+  {}
+
+  template<class T>
+    WindowedIntegrator<T>::~WindowedIntegrator() {
+      if (m_window)
+        delete [] m_window;
+    }
+
+  template<class T>
+    bool WindowedIntegrator<T>::init(const ParameterMap& params, const Ports<StreamInfo>& inp)
+    {
+      assert(inp.size()==1);
+      const StreamInfo& in = inp[0].data;
+      m_size = in.size;
+
+      m_nbFrames = getIntParam("NbFrames",params);
+      if (m_nbFrames<=0) {
+        std::cerr << "ERROR: Invalid NbFrames parameter !" << std::endl;
+        return false;
+      }
+      m_stepNbFrames = getIntParam("StepNbFrames",params);
+      if (m_stepNbFrames<=0) {
+        std::cerr << "ERROR: Invalid stepNbFrames parameter !" << std::endl;
+        return false;
+      }
+
+      StreamInfo out;
+      out.sampleRate = in.sampleRate;
+      out.frameLength = in.frameLength + (m_nbFrames - 1) * in.sampleStep;
+      out.sampleStep = m_stepNbFrames * in.sampleStep;
+      if (!initIntegrator(params,in,out))
+        return false;
+      outStreamInfo().add(out);
+
+      if (m_window)
+        delete [] m_window;
+      m_window = new double[2*m_nbFrames*m_size];
+      return true;
+    }
+
+  template<class T>
+    void WindowedIntegrator<T>::reset() {
+      m_pos = 0;
+      m_count = 0;
+      m_skip = 0;
+      m_started = false;
+      static_cast<T*>(this)->resetWindow();
+    }
+
+  template<class T>
+    bool WindowedIntegrator<T>::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp) {
+      assert(inp.size()==1);
+      InputBuffer* in = inp[0].data;
+      assert(outp.size()==1);
+      OutputBuffer* out = outp[0].data;
+
+      if (!m_started) {
+        in->prependZeros(m_nbFrames/2);
+        m_started = true;
+      }
+
+      T* integrator = static_cast<T*>(this);
+      const int frameBytes = m_size*sizeof(double);
+      bool written = false;
+      while (!in->empty())
+      {
+        if (m_skip>0) {
+          m_skip--;
+          in->consumeToken();
+          continue;
+        }
+        const double* frame = in->readToken();
+        double* slot = m_window + m_pos*m_size;
+        memcpy(slot,frame,frameBytes);
+        memcpy(slot+m_nbFrames*m_size,frame,frameBytes);
+        integrator->addFrame(slot,m_count);
+        in->consumeToken();
+        m_count++;
+        if (++m_pos==m_nbFrames)
+          m_pos = 0;
+
+        if (m_count==m_nbFrames) {
+          // window starts at the oldest frame, which is at m_pos
+          const double* window = m_window + m_pos*m_size;
+          integrator->emit(window,out->writeToken());
+          written = true;
+          const int leaving = (m_stepNbFrames<m_nbFrames) ? m_stepNbFrames : m_nbFrames;
+          for (int i=0;i<leaving;i++)
+            integrator->removeFrame(window + i*m_size,i);
+          integrator->advanceWindow(leaving);
+          m_count -= leaving;
+          m_skip = m_stepNbFrames - leaving;
+        }
+      }
+      return written;
+    }
+
+  template<class T>
+    void WindowedIntegrator<T>::flush(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+    {
+      InputBuffer* in = inp[0].data;
+      in->appendZeros((m_nbFrames-1)/2);
+      process(inp,outp);
+    }
+
 
 } // YAAFE
 
@@ -74,7 +74,8 @@ namespace YAAFE {
     }
   }
 
-  Component* ComponentPool::get(const std::string& id, const ParameterMap& params, const Ports<StreamInfo>& in)
+  Component* ComponentPool::get(const std::string& id, const ParameterMap& params, const Ports<StreamInfo>& in,
+      const Component* model)
   {
     ComponentProxy* p(NULL);
     // check if suitable proxy already exists
@@ -88,14 +89,23 @@ namespace YAAFE {
     // if no proxy found create one
     if (!p)
     {
-      Component* c = ComponentFactory::instance()->createComponent(id);
-      if (!c)
+      Component* c = (model ? model->copy() : NULL);
+      if (c)
       {
-        cerr << "ERROR: cannot create component " << id << endl;
-        return NULL;
+        // the copy holds the stream state of the model
+        c->reset();
+      }
+      else
+      {
+        c = ComponentFactory::instance()->createComponent(id);
+        if (!c)
+        {
+          cerr << "ERROR: cannot create component " << id << endl;
+          return NULL;
+        }
+        if (!c->init(params, in))
+          return NULL;
       }
-      if (!c->init(params, in))
-        return NULL;
       p = new ComponentProxy(params,in,c);
       m_pool.insert(make_pair(id,p));
     }
@@ -35,7 +35,12 @@ namespace YAAFE {
      ComponentPool();
      virtual ~ComponentPool();
 
-     Component* get(const std::string& id, const ParameterMap& params, const Ports<StreamInfo>& in);
+     /**
+      * Get an initialized component. If model is not NULL, the component
+      * is copied from model when possible instead of being initialized.
+      */
+     Component* get(const std::string& id, const ParameterMap& params, const Ports<StreamInfo>& in,
+         const Component* model = NULL);
      void release(Component* c);
 
    private:
@@ -104,6 +104,10 @@ namespace YAAFE {
        const Node* getNode(const std::string& name) const;
        NodeList rootNodes() const;
        NodeList finalNodes() const;
+       /**
+        * Return all nodes, each node being after all its sources.
+        */
+       NodeList topologicalOrder() const;
        void link(Node* source, const std::string& sourcePort,
            Node* target, const std::string& targetPort);
        const NodeList& getNodes() const { return m_nodes; }
@@ -209,6 +213,24 @@ namespace YAAFE {
       return res;
     }
 
+  template<class T>
+    typename Graph<T>::NodeList Graph<T>::topologicalOrder() const {
+      NodeList res;
+      std::map<Node*,int> count;
+      NodeList toVisit = rootNodes();
+      while (toVisit.size()>0) {
+        Node* n = toVisit.back();
+        toVisit.pop_back();
+        if (++count[n]>=(int)n->sources().size())
+        {
+          res.push_back(n);
+          for (LinkListCIt lIt=n->targets().begin();lIt!=n->targets().end();lIt++)
+            toVisit.push_back((*lIt)->target);
+        }
+      }
+      return res;
+    }
+
   template<class T>
     void Graph<T>::link(Node* source, const std::string& sourcePort,
         Node* target, const std::string& targetPort) {
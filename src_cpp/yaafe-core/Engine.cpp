@@ -27,21 +27,92 @@
 #include "ComponentFactory.h"
 #include "ComponentPool.h"
 #include "DirectedGraph.h"
+#include "EngineConfig.h"
 #include "utils.h"
 
+#include <set>
 #include <stack>
 #include <vector>
 #include <map>
 #include <time.h>
+#include <math.h>
+#include <float.h>
 #include <iostream>
+#include <sstream>
 #include <algorithm>
 
 using namespace std;
 
+// minimum number of tokens per data block
+#define MIN_BLOCK_TOKENS 8
+// maximum data block size, relative to the block byte budget
+#define MAX_BLOCK_FACTOR 8
+// dataflow node parameter forcing the number of tokens of its data blocks
+#define DATA_BLOCK_TOKENS_PARAM "DataBlockTokens"
+// component computing the descriptors below in a single pass
+#define SPECTRAL_DESCRIPTORS_ID "SpectralDescriptors"
+// component computing several loudness descriptors in a single pass
+#define LOUDNESS_DESCRIPTORS_ID "LoudnessDescriptors"
+// band loudness component, also computed by LoudnessDescriptors
+#define LOUDNESS_ID "Loudness"
+
 namespace YAAFE {
 
+  static const char* s_spectralDescriptors[] = { "ShapeStatistics", "Flatness",
+    "Rolloff", "Slope", "Decrease", "SpectralFlatnessPerBand",
+    "SpectralCrestFactorPerBand", "Variation", NULL };
+
+  // numerically sensitive components, whose inputs are always computed
+  // in double precision
+  static const char* s_doubleInputComponents[] = { "AC2LPC", "LPC2LSF", NULL };
+
+  // the data block size of a node is an engine parameter, not passed to
+  // the component
+  static void takeBlockTokens(ParameterMap& params, int& blockTokens)
+  {
+    ParameterMap::iterator it = params.find(DATA_BLOCK_TOKENS_PARAM);
+    if (it==params.end())
+      return;
+    blockTokens = atoi(it->second.c_str());
+    params.erase(it);
+  }
+
+  // loudness descriptor computed by a node, empty if the node cannot be
+  // fused into a LoudnessDescriptors step
+  static std::string loudnessDescriptor(const DataFlow::Node* n)
+  {
+    if (n->v.componentId==LOUDNESS_ID)
+      return "Specific";
+    if (n->v.componentId!=LOUDNESS_DESCRIPTORS_ID)
+      return "";
+    ParameterMap::const_iterator dIt = n->v.params.find("LDescriptors");
+    if (dIt==n->v.params.end() || dIt->second.find(',')!=string::npos)
+      return "";
+    return dIt->second;
+  }
+
+  // duration of a token of the stream in seconds, 0 if unknown
+  static double tokenPeriod(const StreamInfo& info)
+  {
+    double period = info.sampleStep / info.sampleRate;
+    return (period>0 && period<=DBL_MAX) ? period : 0;
+  }
+
+  static bool isSpectralDescriptor(const std::string& componentId)
+  {
+    for (int i=0;s_spectralDescriptors[i];i++)
+      if (componentId==s_spectralDescriptors[i])
+        return true;
+    return false;
+  }
+
   Engine::ProcessingStep::ProcessingStep() :
-    m_id(), m_params(), m_component(NULL), m_pool(NULL), m_input(), m_output() {
+    m_kind(COMPONENT_STEP), m_id(), m_name(), m_params(), m_component(NULL), m_pool(NULL), m_model(NULL), m_input(),
+    m_output(), m_profile(NULL), m_selected(true), m_active(true), m_blockTokens(0) {
+#ifdef WITH_TIMERS
+      m_timer = NULL;
+      m_boundTimer = NULL;
+#endif
     }
 
   Engine::ProcessingStep::~ProcessingStep() {
@@ -62,17 +133,21 @@ namespace YAAFE {
   }
 
   Engine::Engine() :
-    m_graph(NULL) {
+    m_profiler(NULL), m_floatPrecision(false), m_fusion(true), m_graph(NULL) {
       m_graph = new Graph<ProcessingStep>; // initialize with empty graph
     }
 
   Engine::~Engine() {
     if (m_graph)
       delete m_graph;
+    if (m_profiler)
+      delete m_profiler;
   }
 
   bool Engine::load(const DataFlow& df) {
+    EngineConfig::Scope scope(m_config);
     // release old dataflow
+    m_schedule.clear();
     if (m_graph)
       delete m_graph;
     m_graph = new Graph<ProcessingStep>;
@@ -87,23 +162,33 @@ namespace YAAFE {
 
 #ifdef WITH_TIMERS
     static Timer* gt = Timer::get_timer("loading dataflow");
-    gt->start();
+    const double t0 = gt->start();
 #endif
 
     const DataFlow::NodeList& nodes = df.getNodes();
 
-    // create processing steps
+    // create processing steps, fused steps first
     map<DataFlow::Node*,ProcessFlow::Node*> mapping;
+    map<DataFlow::Node*,string> fusedPorts;
+    if (m_fusion)
+      fuseSteps(df,mapping,fusedPorts);
     for (DataFlow::NodeList::const_iterator nodeIt = nodes.begin(); nodeIt
         != nodes.end(); nodeIt++) {
       DataFlow::Node* n = *nodeIt;
+      if (mapping.find(n)!=mapping.end())
+        continue;
       ProcessFlow::Node* s = m_graph->createNode();
-      if ((n->v.componentId!="Input") && (n->v.componentId!="Output"))
+      if (n->v.componentId=="Input")
+        s->v.m_kind = ProcessingStep::INPUT_STEP;
+      else if (n->v.componentId=="Output")
+        s->v.m_kind = ProcessingStep::OUTPUT_STEP;
+      else
         s->v.m_pool = &m_pool;
       s->v.m_id = n->v.componentId;
       s->v.m_params = n->v.params;
+      takeBlockTokens(s->v.m_params,s->v.m_blockTokens);
       mapping[n] = s;
-      if (verboseFlag)
+      if (m_config.verbose())
         cout << "create step for component " << s->v.m_id << endl;
     }
 
@@ -112,6 +197,7 @@ namespace YAAFE {
         nameIt!=df.getNames().end();nameIt++)
     {
       m_graph->setNodeName(mapping[nameIt->second],nameIt->first);
+      mapping[nameIt->second]->v.m_name = nameIt->first;
     }
 
     // create links
@@ -119,21 +205,334 @@ namespace YAAFE {
     for (DataFlow::LinkListCIt it=links.begin();it!=links.end();it++)
     {
       const DataFlow::Link* l = *it;
-      m_graph->link(mapping[l->source],l->sourceOutputPort,mapping[l->target],l->targetInputPort);
+      ProcessFlow::Node* target = mapping[l->target];
+      // fused steps have a single input, linked once
+      if (fusedPorts.find(l->target)!=fusedPorts.end() && target->sources().size()>0)
+        continue;
+      map<DataFlow::Node*,string>::const_iterator pIt = fusedPorts.find(l->source);
+      m_graph->link(mapping[l->source],
+          pIt==fusedPorts.end() ? l->sourceOutputPort : pIt->second,
+          target,l->targetInputPort);
     }
-    // initialize components in order
-    bool initOK =  m_graph->visitAll<Engine::initStep>();
+
+    // single precision kernels, fused steps included
+    const ProcessFlow::NodeList& steps = m_graph->getNodes();
+    for (ProcessFlow::NodeListCIt it=steps.begin();m_floatPrecision && it!=steps.end();it++)
+    {
+      ProcessingStep& step = (*it)->v;
+      if (step.m_kind!=ProcessingStep::COMPONENT_STEP || !hasKernelPrecision(step.m_id)
+          || feedsDoubleInputComponent(*it))
+        continue;
+      ParameterMap::const_iterator pIt = step.m_params.find(KERNEL_PRECISION_PARAM);
+      if (pIt==step.m_params.end() || pIt->second=="auto")
+        step.m_params[KERNEL_PRECISION_PARAM] = "float";
+    }
+    bool initOK = initGraph();
 
 #ifdef WITH_TIMERS
-    gt->stop();
+    gt->stop(t0);
 #endif
 
-    // set start nodes
-    m_startNodes = m_graph->rootNodes();
+    return initOK;
+  }
+
+  bool Engine::hasKernelPrecision(const std::string& componentId)
+  {
+    if (!ComponentFactory::instance()->exists(componentId))
+      return false;
+    const Component* c = ComponentFactory::instance()->getPrototype(componentId);
+    const ParameterDescriptorList pList = c->getParameterDescriptorList();
+    for (ParameterDescriptorList::const_iterator it=pList.begin();
+        it!=pList.end(); it++)
+      if (it->m_identifier==KERNEL_PRECISION_PARAM)
+        return true;
+    return false;
+  }
+
+  bool Engine::feedsDoubleInputComponent(const ProcessFlow::Node* n)
+  {
+    const ProcessFlow::LinkList& targets = n->targets();
+    for (ProcessFlow::LinkListCIt it=targets.begin();it!=targets.end();it++)
+      for (int i=0;s_doubleInputComponents[i];i++)
+        if ((*it)->target->v.m_id==s_doubleInputComponents[i])
+          return true;
+    return false;
+  }
+
+  void Engine::fuseSteps(const DataFlow& df,
+      map<DataFlow::Node*,ProcessFlow::Node*>& mapping,
+      map<DataFlow::Node*,string>& ports)
+  {
+    const bool spectral = ComponentFactory::instance()->exists(SPECTRAL_DESCRIPTORS_ID);
+    const bool loudness = ComponentFactory::instance()->exists(LOUDNESS_DESCRIPTORS_ID);
+    set<DataFlow::Node*> named;
+    for (DataFlow::NameMapCIt it=df.getNames().begin();it!=df.getNames().end();it++)
+      named.insert(it->second);
+
+    // group unnamed and unparameterized descriptor nodes by input stream
+    const DataFlow::NodeList& nodes = df.getNodes();
+    for (DataFlow::NodeList::const_iterator nodeIt = nodes.begin(); nodeIt
+        != nodes.end(); nodeIt++) {
+      map<string,DataFlow::NodeList> groups;
+      map<string,DataFlow::NodeList> loudnessGroups;
+      const DataFlow::LinkList& targets = (*nodeIt)->targets();
+      for (DataFlow::LinkListCIt it=targets.begin();it!=targets.end();it++)
+      {
+        DataFlow::Node* t = (*it)->target;
+        if (t->sources().size()!=1 || named.find(t)!=named.end())
+          continue;
+        if (spectral && isSpectralDescriptor(t->v.componentId) && t->v.params.empty())
+          groups[(*it)->sourceOutputPort].push_back(t);
+        // single loudness descriptors and band loudness, grouped by their
+        // other parameters
+        if (loudness && !loudnessDescriptor(t).empty())
+        {
+          ostringstream key;
+          key << (*it)->sourceOutputPort;
+          for (ParameterMap::const_iterator pIt=t->v.params.begin();
+              pIt!=t->v.params.end();pIt++)
+            if (pIt->first!="LDescriptors")
+              key << " " << pIt->first << "=" << pIt->second;
+          loudnessGroups[key.str()].push_back(t);
+        }
+      }
+      for (map<string,DataFlow::NodeList>::const_iterator gIt=loudnessGroups.begin();
+          gIt!=loudnessGroups.end();gIt++)
+      {
+        const DataFlow::NodeList& group = gIt->second;
+        // band loudness alone is not fused
+        bool hasDescriptor = false;
+        for (size_t i=0;i<group.size();i++)
+          hasDescriptor |= (group[i]->v.componentId==LOUDNESS_DESCRIPTORS_ID);
+        if (group.size()<2 || !hasDescriptor)
+          continue;
+        ProcessFlow::Node* s = m_graph->createNode();
+        s->v.m_pool = &m_pool;
+        s->v.m_id = LOUDNESS_DESCRIPTORS_ID;
+        s->v.m_params = group[0]->v.params;
+        takeBlockTokens(s->v.m_params,s->v.m_blockTokens);
+        set<string> ids;
+        string descr;
+        for (size_t i=0;i<group.size();i++)
+        {
+          const string id = loudnessDescriptor(group[i]);
+          if (ids.insert(id).second)
+            descr += (descr.empty() ? "" : ",") + id;
+          mapping[group[i]] = s;
+          ports[group[i]] = id;
+        }
+        s->v.m_params["LDescriptors"] = descr;
+        if (m_config.verbose())
+          cout << "fuse " << descr << " into a " << LOUDNESS_DESCRIPTORS_ID << " step" << endl;
+      }
+      for (map<string,DataFlow::NodeList>::const_iterator gIt=groups.begin();
+          gIt!=groups.end();gIt++)
+      {
+        const DataFlow::NodeList& group = gIt->second;
+        if (group.size()<2)
+          continue;
+        ProcessFlow::Node* s = m_graph->createNode();
+        s->v.m_pool = &m_pool;
+        s->v.m_id = SPECTRAL_DESCRIPTORS_ID;
+        set<string> ids;
+        string descr;
+        for (size_t i=0;i<group.size();i++)
+        {
+          const string& id = group[i]->v.componentId;
+          if (ids.insert(id).second)
+            descr += (descr.empty() ? "" : ",") + id;
+          mapping[group[i]] = s;
+          ports[group[i]] = id;
+        }
+        s->v.m_params["SDescriptors"] = descr;
+        if (m_config.verbose())
+          cout << "fuse " << descr << " into a " << SPECTRAL_DESCRIPTORS_ID << " step" << endl;
+      }
+    }
+  }
+
+  Engine* Engine::clone() const
+  {
+    Engine* e = new Engine();
+    e->m_floatPrecision = m_floatPrecision;
+    e->m_fusion = m_fusion;
+    e->m_config = m_config;
+    EngineConfig::Scope scope(e->m_config);
+
+    // duplicate processing steps
+    map<ProcessFlow::Node*,ProcessFlow::Node*> mapping;
+    const ProcessFlow::NodeList& nodes = m_graph->getNodes();
+    for (ProcessFlow::NodeListCIt nodeIt=nodes.begin();nodeIt!=nodes.end();nodeIt++)
+    {
+      const ProcessingStep& step = (*nodeIt)->v;
+      ProcessFlow::Node* s = e->m_graph->createNode();
+      s->v.m_kind = step.m_kind;
+      if (step.m_kind==ProcessingStep::COMPONENT_STEP) {
+        s->v.m_pool = &e->m_pool;
+        s->v.m_model = step.m_component;
+      }
+      s->v.m_id = step.m_id;
+      s->v.m_name = step.m_name;
+      s->v.m_params = step.m_params;
+      s->v.m_blockTokens = step.m_blockTokens;
+      mapping[*nodeIt] = s;
+    }
+
+    // set names
+    const ProcessFlow::NameMap& names = m_graph->getNames();
+    for (ProcessFlow::NameMapCIt it=names.begin();it!=names.end();it++)
+      e->m_graph->setNodeName(mapping[it->second],it->first);
+
+    // duplicate links
+    const ProcessFlow::LinkList& links = m_graph->getLinks();
+    for (ProcessFlow::LinkListCIt it=links.begin();it!=links.end();it++)
+    {
+      const ProcessFlow::Link* l = *it;
+      e->m_graph->link(mapping[l->source],l->sourceOutputPort,mapping[l->target],l->targetInputPort);
+    }
+
+    if (m_profiler)
+      e->m_profiler = new Profiler(m_profiler->tracing());
+
+    if (!e->initGraph()) {
+      delete e;
+      return NULL;
+    }
+
+    // models are not needed anymore
+    const ProcessFlow::NodeList& newNodes = e->m_graph->getNodes();
+    for (ProcessFlow::NodeListCIt it=newNodes.begin();it!=newNodes.end();it++)
+      (*it)->v.m_model = NULL;
+
+    return e;
+  }
+
+  bool Engine::initGraph()
+  {
+    // initialize components in order
+    bool initOK =  m_graph->visitAll<Engine::initStep>();
+    // exchange floats between components able to
+    if (initOK && m_floatPrecision)
+      m_graph->visitAll<Engine::sampleTypeStep>();
+    // choose data block sizes of all edges
+    if (initOK)
+      m_graph->visitAll<Engine::blockSizeStep>();
+
+    if (initOK)
+      initOK = buildSchedule();
+
+    if (m_profiler)
+      attachProfiler();
 
     return initOK;
   }
 
+  bool Engine::buildSchedule()
+  {
+    m_schedule.clear();
+    ProcessFlow::NodeList order = m_graph->topologicalOrder();
+    for (size_t i=0;i<order.size();i++)
+    {
+      ProcessFlow::Node* n = order[i];
+      const ProcessingStep& step = n->v;
+      ScheduleEntry e;
+      e.node = n;
+      e.dataDependent = false;
+      // shortest output period, a step without output consumes its input
+      // token per token
+      double outPeriod = 0;
+      if (step.m_kind==ProcessingStep::COMPONENT_STEP)
+      {
+        const Ports<StreamInfo>& outInfo = step.m_component->getOutStreamInfo();
+        for (size_t k=0;k<outInfo.size();k++)
+        {
+          double period = tokenPeriod(outInfo[k].data);
+          if (period==0)
+            e.dataDependent = true;
+          else if (outPeriod==0 || period<outPeriod)
+            outPeriod = period;
+        }
+      }
+      for (size_t k=0;k<step.m_input.size();k++)
+      {
+        ScheduleInput in;
+        in.buffer = step.m_input[k].data;
+        in.end = 0;
+        in.rate = 1;
+        double inPeriod = tokenPeriod(in.buffer->info());
+        if (inPeriod==0)
+          e.dataDependent = true;
+        else if (outPeriod>0)
+          in.rate = max(1, (int) floor(outPeriod / inPeriod + 1e-6));
+        e.inputs.push_back(in);
+      }
+      m_schedule.push_back(e);
+    }
+    if (order.size()!=m_graph->getNodes().size())
+    {
+      cerr << "ERROR: dataflow has cycles !" << endl;
+      m_schedule.clear();
+      return false;
+    }
+
+    if (m_config.verbose())
+    {
+      cout << "schedule:" << endl;
+      for (size_t i=0;i<m_schedule.size();i++)
+      {
+        const ScheduleEntry& e = m_schedule[i];
+        cout << "  " << i << " " << (e.node->v.m_name.empty() ? e.node->v.m_id : e.node->v.m_name);
+        if (e.dataDependent)
+          cout << " (data dependent)";
+        else if (e.inputs.size()>0)
+        {
+          cout << " rate";
+          for (size_t k=0;k<e.inputs.size();k++)
+            cout << " " << e.inputs[k].rate;
+        }
+        cout << endl;
+      }
+    }
+    return true;
+  }
+
+  void Engine::enableProfiling(bool trace)
+  {
+    if (m_profiler)
+      delete m_profiler;
+    m_profiler = new Profiler(trace);
+    attachProfiler();
+  }
+
+  void Engine::disableProfiling()
+  {
+    const ProcessFlow::NodeList& nodes = m_graph->getNodes();
+    for (ProcessFlow::NodeListCIt it=nodes.begin();it!=nodes.end();it++)
+      (*it)->v.m_profile = NULL;
+    if (m_profiler)
+      delete m_profiler;
+    m_profiler = NULL;
+  }
+
+  void Engine::attachProfiler()
+  {
+    m_profiler->removeSteps();
+    // only input and output nodes are named, other steps are named
+    // after their component and their rank in the graph (FFT#0, FFT#1, ...)
+    map<string,int> counts;
+    const ProcessFlow::NodeList& nodes = m_graph->getNodes();
+    for (ProcessFlow::NodeListCIt it=nodes.begin();it!=nodes.end();it++) {
+      ProcessingStep& step = (*it)->v;
+      string name = step.m_name;
+      if (name.empty()) {
+        ostringstream oss;
+        oss << step.m_id << "#" << counts[step.m_id]++;
+        name = oss.str();
+      }
+      step.m_profile = m_profiler->addStep(name, step.m_id);
+    }
+  }
+
   Engine::ProcessingStep* Engine::getInputNode(const std::string& id)
   {
     ProcessFlow::Node* n = m_graph->getNode(id);
@@ -141,7 +540,7 @@ namespace YAAFE {
       cerr << "WARNING: node '" << id << "' does not exist !" << endl;
       return NULL;
     }
-    if (n->v.m_id!="Input")
+    if (n->v.m_kind!=ProcessingStep::INPUT_STEP)
     {
       cerr << "WARNING: node '" << id << "' is not an input node !" << endl;
       return NULL;
@@ -156,7 +555,7 @@ namespace YAAFE {
     ProcessFlow::Node* n = m_graph->getNode(id);
     if (n==NULL)
       return NULL;
-    if (n->v.m_id!="Output")
+    if (n->v.m_kind!=ProcessingStep::OUTPUT_STEP)
     {
       cerr << "WARNING: node '" << id << "' is not an output node !" << endl;
       return NULL;
@@ -195,6 +594,9 @@ namespace YAAFE {
       return false;
     }
     ps->m_component = component;
+#ifdef WITH_TIMERS
+    ps->m_boundTimer = Timer::get_timer(component->getIdentifier());
+#endif
     return true;
   }
 
@@ -203,6 +605,9 @@ namespace YAAFE {
     ProcessingStep* ps = getInputNode(id);
     if (ps) {
       ps->m_component = NULL;
+#ifdef WITH_TIMERS
+      ps->m_boundTimer = NULL;
+#endif
     }
   }
 
@@ -210,7 +615,7 @@ namespace YAAFE {
     std::vector<std::string> res;
     const ProcessFlow::NameMap& names = m_graph->getNames();
     for (ProcessFlow::NameMapCIt it=names.begin();it!=names.end();it++)
-      if (it->second->v.m_id=="Input")
+      if (it->second->v.m_kind==ProcessingStep::INPUT_STEP)
         res.push_back(it->first);
     return res;
   }
@@ -234,6 +639,10 @@ namespace YAAFE {
     ProcessingStep* ps = getOutputNode(id);
     if (ps) {
       ps->m_component = component;
+#ifdef WITH_TIMERS
+      ps->m_boundTimer = Timer::get_timer(component->getIdentifier());
+#endif
+      updateActiveSteps();
     }
   }
 
@@ -242,6 +651,10 @@ namespace YAAFE {
     ProcessingStep* ps = getOutputNode(id);
     if (ps) {
       ps->m_component = NULL;
+#ifdef WITH_TIMERS
+      ps->m_boundTimer = NULL;
+#endif
+      updateActiveSteps();
     }
   }
 
@@ -249,13 +662,95 @@ namespace YAAFE {
     std::vector<std::string> res;
     const ProcessFlow::NameMap& names = m_graph->getNames();
     for (ProcessFlow::NameMapCIt it=names.begin();it!=names.end();it++)
-      if (it->second->v.m_id=="Output")
+      if (it->second->v.m_kind==ProcessingStep::OUTPUT_STEP)
         res.push_back(it->first);
     return res;
   }
 
+  bool Engine::selectOutputs(const std::vector<std::string>& outputs)
+  {
+    for (size_t i=0;i<outputs.size();i++)
+    {
+      if (getOutputNode(outputs[i])==NULL) {
+        cerr << "ERROR: '" << outputs[i] << "' is not an output node !" << endl;
+        return false;
+      }
+    }
+    const ProcessFlow::NodeList& nodes = m_graph->getNodes();
+    for (ProcessFlow::NodeListCIt it=nodes.begin();it!=nodes.end();it++)
+      (*it)->v.m_selected = false;
+    for (size_t i=0;i<outputs.size();i++)
+      getOutputNode(outputs[i])->m_selected = true;
+    updateActiveSteps();
+    return true;
+  }
+
+  void Engine::selectAllOutputs()
+  {
+    const ProcessFlow::NodeList& nodes = m_graph->getNodes();
+    for (ProcessFlow::NodeListCIt it=nodes.begin();it!=nodes.end();it++)
+      (*it)->v.m_selected = true;
+    updateActiveSteps();
+  }
+
+  bool Engine::isActive(const std::string& id)
+  {
+    ProcessFlow::Node* n = m_graph->getNode(id);
+    return (n!=NULL && n->v.m_active);
+  }
+
+  void Engine::updateActiveSteps()
+  {
+    // active steps are the selected or bound outputs, the components
+    // without output ports (writers) and their ancestors
+    const ProcessFlow::NodeList& nodes = m_graph->getNodes();
+    ProcessFlow::NodeList toVisit;
+    for (ProcessFlow::NodeListCIt it=nodes.begin();it!=nodes.end();it++)
+    {
+      ProcessingStep& step = (*it)->v;
+      if ((step.m_kind==ProcessingStep::OUTPUT_STEP
+          && (step.m_selected || step.m_component!=NULL))
+          || (step.m_kind==ProcessingStep::COMPONENT_STEP
+          && step.m_component!=NULL && step.m_output.size()==0))
+        toVisit.push_back(*it);
+      step.m_active = false;
+    }
+    while (!toVisit.empty())
+    {
+      ProcessFlow::Node* n = toVisit.back();
+      toVisit.pop_back();
+      if (n->v.m_active)
+        continue;
+      n->v.m_active = true;
+      for (ProcessFlow::LinkListCIt it=n->sources().begin();it!=n->sources().end();it++)
+        toVisit.push_back((*it)->source);
+    }
+
+    // inactive steps do not receive data
+    for (ProcessFlow::NodeListCIt it=nodes.begin();it!=nodes.end();it++)
+    {
+      ProcessingStep& step = (*it)->v;
+      if (step.m_input.size()!=(*it)->sources().size())
+        continue; // not initialized
+      for (int i=0;i<step.m_input.size();i++)
+      {
+        const ProcessFlow::Link* l = (*it)->sources()[i];
+        OutputBuffer* source = l->source->v.m_output[l->sourceOutputPort].data;
+        InputBuffer* in = step.m_input[i].data;
+        source->unbindInputBuffer(in);
+        if (step.m_active)
+          source->bindInputBuffer(in);
+        else
+          in->clear();
+      }
+    }
+  }
+
   inline bool Engine::initStep(ProcessFlow::Node& node) {
-    if (node.v.m_id == "Input") {
+#ifdef WITH_TIMERS
+    node.v.m_timer = Timer::get_timer(node.v.m_id);
+#endif
+    if (node.v.m_kind == ProcessingStep::INPUT_STEP) {
       node.v.m_component = NULL;
       StreamInfo outStreamInfo;
       outStreamInfo.size = 1;
@@ -283,10 +778,10 @@ namespace YAAFE {
       //		}
       inStreamInfo.add(l->targetInputPort, outInfo[l->sourceOutputPort].data->info());
     }
-    if (node.v.m_id == "Output") {
+    if (node.v.m_kind == ProcessingStep::OUTPUT_STEP) {
       node.v.m_component = NULL;
     } else {
-      node.v.m_component = node.v.m_pool->get(node.v.m_id,node.v.m_params,inStreamInfo);
+      node.v.m_component = node.v.m_pool->get(node.v.m_id,node.v.m_params,inStreamInfo,node.v.m_model);
       if (!node.v.m_component) {
         cerr << "ERROR: cannot initialize component " << node.v.m_id << " !" << endl;
         return false;
@@ -299,19 +794,105 @@ namespace YAAFE {
       l->source->v.m_output[l->sourceOutputPort].data->bindInputBuffer(source);
       node.v.m_input.add(l->targetInputPort, source);
     }
-    if (node.v.m_id != "Output") {
+    if (node.v.m_kind != ProcessingStep::OUTPUT_STEP) {
       node.v.m_output = node.v.m_component->getOutStreamInfo().map(buildOutputBufferFromInfo);
     }
     return true;
   }
 
+  inline bool Engine::blockSizeStep(ProcessFlow::Node& node) {
+    for (size_t i=0;i<node.v.m_output.size();i++)
+    {
+      OutputBuffer* out = node.v.m_output[i].data;
+      const StreamInfo& info = out->info();
+      int tokens = node.v.m_blockTokens;
+      if (tokens<=0) {
+        // blocks fit in the byte budget, so wide streams get few tokens
+        // per block. Narrow streams get at least MIN_BLOCK_TOKENS tokens,
+        // and enough tokens for every consumer to produce at least one
+        // token per block, without exceeding MAX_BLOCK_FACTOR times the
+        // budget.
+        // outputs of size 0 still take one token slot per token.
+        int tokenSize = max(1, info.size);
+        int tokenBytes = tokenSize * sampleBytes(out->sampleType());
+        int budgetTokens = DataBlock::defaultTokens(tokenSize, out->sampleType());
+        int maxTokens = max(budgetTokens, (MAX_BLOCK_FACTOR * DataBlock::blockBytes()) / tokenBytes);
+        int minTokens = min(MIN_BLOCK_TOKENS, budgetTokens);
+        // without a positive and finite period, consumers rates cannot be
+        // compared to this output, only the default size is used.
+        double inPeriod = tokenPeriod(info);
+        for (ProcessFlow::LinkListCIt it=node.targets().begin();inPeriod>0 && it!=node.targets().end();it++)
+        {
+          const ProcessFlow::Link* l = *it;
+          if (l->sourceOutputPort!=node.v.m_output[i].name)
+            continue;
+          const ProcessingStep& target = l->target->v;
+          if (target.m_component==NULL)
+            continue;
+          const Ports<StreamInfo>& outInfo = target.m_component->getOutStreamInfo();
+          for (size_t k=0;k<outInfo.size();k++)
+          {
+            const StreamInfo& o = outInfo[k].data;
+            double ratio = ceil((o.sampleStep / o.sampleRate) / inPeriod);
+            double window = ceil((o.frameLength / o.sampleRate
+                  - info.frameLength / info.sampleRate) / inPeriod) + 1;
+            double needed = max(ratio,window);
+            if (isnan(needed))
+              continue;
+            minTokens = max(minTokens, (int) min(needed, (double) maxTokens));
+          }
+        }
+        tokens = max(budgetTokens, minTokens);
+      }
+      out->setBlockTokens(tokens);
+      if (EngineConfig::current().verbose())
+        cout << "data block of " << (node.v.m_name.empty() ? node.v.m_id : node.v.m_name)
+          << ":" << node.v.m_output[i].name << " " << info << " : "
+          << tokens << (out->sampleType()==FLOAT_SAMPLES ? " float" : "") << " tokens" << endl;
+    }
+    return true;
+  }
+
+  inline bool Engine::sampleTypeStep(ProcessFlow::Node& node) {
+    if (node.v.m_kind!=ProcessingStep::COMPONENT_STEP)
+      return true;
+    for (size_t i=0;i<node.v.m_output.size();i++)
+    {
+      if (!node.v.m_component->canWriteFloat(i))
+        continue;
+      // all consumers must read floats, readers and writers only read
+      // doubles
+      bool floatStream = false;
+      for (ProcessFlow::LinkListCIt it=node.targets().begin();it!=node.targets().end();it++)
+      {
+        const ProcessFlow::Link* l = *it;
+        if (l->sourceOutputPort!=node.v.m_output[i].name)
+          continue;
+        const ProcessingStep& target = l->target->v;
+        const ProcessFlow::LinkList& sources = l->target->sources();
+        const int port = find(sources.begin(),sources.end(),l) - sources.begin();
+        floatStream = (target.m_kind==ProcessingStep::COMPONENT_STEP
+            && target.m_component->canReadFloat(port));
+        if (!floatStream)
+          break;
+      }
+      if (floatStream)
+        node.v.m_output[i].data->setSampleType(FLOAT_SAMPLES);
+    }
+    return true;
+  }
+
   inline bool Engine::resetStep(ProcessFlow::Node& step) {
     for (int i=0;i<step.v.m_input.size();++i)
       step.v.m_input[i].data->clear();
     for (int i=0;i<step.v.m_output.size();++i)
       step.v.m_output[i].data->clear();
-    if ((step.v.m_id=="Input") || (step.v.m_id=="Output"))
+    if (step.v.m_kind!=ProcessingStep::COMPONENT_STEP) {
       step.v.m_component = NULL;
+#ifdef WITH_TIMERS
+      step.v.m_boundTimer = NULL;
+#endif
+    }
     if (step.v.m_component != NULL)
       step.v.m_component->reset();
     return true;
@@ -319,37 +900,44 @@ namespace YAAFE {
 
   inline bool Engine::processStep(ProcessFlow::Node& step) {
 #ifdef DEBUG
-    if (verboseFlag)
+    if (EngineConfig::current().verbose())
       cerr << "process step " << step.v.m_id << endl;
 #endif
-    if (!step.v.hasInputAvailable())
-      return false;
 #ifdef WITH_TIMERS
-    Timer* t = Timer::get_timer(step.v.m_id);
-    t->start();
+    const double t0 = step.v.m_timer->start();
+#endif
+    if (step.v.m_profile)
+      step.v.m_profile->start(step.v.m_input, step.v.m_output);
     bool res = step.v.m_component->process(step.v.m_input, step.v.m_output);
-    t->stop();
-    return res;
-#else
-    return (step.v.m_component->process(step.v.m_input, step.v.m_output));
+    if (step.v.m_profile)
+      step.v.m_profile->stop(step.v.m_input, step.v.m_output, false);
+#ifdef WITH_TIMERS
+    step.v.m_timer->stop(t0);
 #endif
+    return res;
   }
 
   inline bool Engine::flushStep(ProcessFlow::Node& step) {
+    if (!step.v.m_active)
+      return true;
     if (step.v.m_component!=NULL) {
 #ifdef DEBUG
-      if (verboseFlag) {
+      if (EngineConfig::current().verbose()) {
         cerr << "flush step " << step.v.m_component->getIdentifier() << endl;
       }
 #endif
 
 #ifdef WITH_TIMERS
-      Timer* t = Timer::get_timer(step.v.m_component->getIdentifier());
-      t->start();
-      step.v.m_component->flush(step.v.m_input, step.v.m_output);
-      t->stop();
-#else
+      Timer* t = step.v.m_boundTimer ? step.v.m_boundTimer : step.v.m_timer;
+      const double t0 = t->start();
+#endif
+      if (step.v.m_profile)
+        step.v.m_profile->start(step.v.m_input, step.v.m_output);
       step.v.m_component->flush(step.v.m_input, step.v.m_output);
+      if (step.v.m_profile)
+        step.v.m_profile->stop(step.v.m_input, step.v.m_output, true);
+#ifdef WITH_TIMERS
+      t->stop(t0);
 #endif
     }
     for (int i=0;i<step.v.m_output.size();i++)
@@ -358,60 +946,66 @@ namespace YAAFE {
   }
 
   void Engine::reset() {
+    EngineConfig::Scope scope(m_config);
     m_graph->visitAll<Engine::resetStep>();
+    for (size_t i=0;i<m_schedule.size();i++)
+      for (size_t k=0;k<m_schedule[i].inputs.size();k++)
+        m_schedule[i].inputs[k].end = 0;
+    // outputs have been detached
+    updateActiveSteps();
   }
 
   bool Engine::process() {
+    EngineConfig::Scope scope(m_config);
 #ifdef WITH_TIMERS
     static Timer* gt = Timer::get_timer("processing");
-    gt->start();
+    const double t0 = gt->start();
 #endif
 
-    // process data
-    ProcessFlow::NodeList toProcess = m_startNodes;
+    // run steps in topological order, a step runs if it received new
+    // tokens and holds enough tokens to produce an output token.
     bool doneSomething = false;
-    while (toProcess.size()>0)
+    for (size_t i=0;i<m_schedule.size();i++)
     {
-      ProcessFlow::Node* n = toProcess.back();
-      toProcess.pop_back();
-      ProcessingStep& step = n->v;
-#ifdef DEBUG
-      if (verboseFlag)
-        cerr << "process step " << step.m_id << " ( " << toProcess.size() << " in queue)" << endl;
-#endif
-      bool b = true;
-      if (step.m_component!=NULL)
+      ScheduleEntry& e = m_schedule[i];
+      ProcessingStep& step = e.node->v;
+      if (!step.m_active)
+        continue;
+      if (e.inputs.size()>0)
       {
-#ifdef WITH_TIMERS
-        Timer* t = Timer::get_timer(step.m_id);
-        t->start();
-#endif
-        b = step.m_component->process(step.m_input,step.m_output);
-#ifdef WITH_TIMERS
-        t->stop();
-#endif
+        bool received = false;
+        bool enough = true;
+        for (size_t k=0;k<e.inputs.size();k++)
+        {
+          const ScheduleInput& in = e.inputs[k];
+          const int end = in.buffer->endTokenno();
+          received = received || (end!=in.end);
+          enough = enough && (end - in.buffer->tokenno() >= in.rate);
+        }
+        if (!received || !(e.dataDependent ? step.hasInputAvailable() : enough))
+          continue;
+        for (size_t k=0;k<e.inputs.size();k++)
+          e.inputs[k].end = e.inputs[k].buffer->endTokenno();
       }
-      if (b)
+      if (step.m_component!=NULL)
       {
-        if (step.m_component!=NULL)
-          doneSomething = true;
-        for (int i=0;i<n->v.m_output.size();i++) {
-          //					n->v.m_output[i].data->debug();
-          n->v.m_output[i].data->dispatch();
-        }
-        for (ProcessFlow::LinkListCIt it=n->targets().begin(); it!=n->targets().end(); it++)
-          if ((*it)->target->v.hasInputAvailable())
-            toProcess.push_back((*it)->target);
+        if (!processStep(*e.node))
+          continue;
+        doneSomething = true;
       }
+      for (size_t k=0;k<step.m_output.size();k++)
+        step.m_output[k].data->dispatch();
     }
+
 #ifdef WITH_TIMERS
-    gt->stop();
+    gt->stop(t0);
 #endif
 
     return doneSomething;
   }
 
   void Engine::flush() {
+    EngineConfig::Scope scope(m_config);
     m_graph->visitAll<Engine::flushStep> ();
   }
 
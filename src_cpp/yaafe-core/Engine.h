@@ -29,6 +29,8 @@
 #include "Component.h"
 #include "ComponentPool.h"
 #include "DirectedGraph.h"
+#include "EngineConfig.h"
+#include "Profiler.h"
 
 namespace YAAFE
 {
@@ -39,8 +41,48 @@ namespace YAAFE
      Engine();
      virtual ~Engine();
 
+     /**
+      * Use single precision kernels in components supporting them
+      * (see KERNEL_PRECISION_PARAM). Must be set before load. Components
+      * whose KernelPrecision parameter is set to double or float in the
+      * dataflow keep it. Components feeding AC2LPC or LPC2LSF stay double.
+      * Streams hold floats when their producer can write them and all
+      * their consumers can read them, for example the spectrum read by
+      * the spectral descriptors. Other streams stay double.
+      */
+     void setFloatPrecision(bool enable) { m_floatPrecision = enable; }
+     bool floatPrecision() const { return m_floatPrecision; }
+
+     /**
+      * Compute spectral descriptors (ShapeStatistics, Flatness, Rolloff,
+      * Slope, Decrease, SpectralFlatnessPerBand, SpectralCrestFactorPerBand,
+      * Variation) sharing the same input with a single SpectralDescriptors
+      * step, and loudness descriptors sharing the same input with a single
+      * LoudnessDescriptors step. Enabled by default, must be set before load.
+      */
+     void setFusion(bool enable) { m_fusion = enable; }
+     bool fusion() const { return m_fusion; }
+
+     /**
+      * Verbosity and prefered data block size of this engine. Must be set
+      * before load. When Yaafe is built with WITH_THREADS, engines can be
+      * used concurrently in different threads, each engine being used by
+      * one thread at a time.
+      */
+     EngineConfig& config() { return m_config; }
+     const EngineConfig& config() const { return m_config; }
+
      bool load(const DataFlow& df);
 
+     /**
+      * Create a new engine processing the same dataflow. Components are
+      * copied from this engine's ones when they support it, sharing
+      * their precomputed state, so that cloning is much cheaper than
+      * loading the dataflow again. Inputs and outputs of the new engine
+      * are not bound. Returns NULL on failure.
+      */
+     Engine* clone() const;
+
      OutputBuffer* getInput(const std::string& id);
      ParameterMap getInputParams(const std::string& id);
      bool bindInput(const std::string& id, Component* component);
@@ -53,38 +95,118 @@ namespace YAAFE
      void detachOutput(const std::string& id);
      std::vector<std::string> getOutputs();
 
+     /**
+      * Only steps whose results reach a selected output or an output bound
+      * to a component are processed, others are skipped. All outputs are
+      * selected by default. selectOutputs selects the given outputs only
+      * (none if the list is empty), so that other outputs are computed only
+      * while they are bound. Returns false if an output does not exist.
+      * Outputs should be selected, bound and detached between flush() and
+      * the next reset(), or just after reset().
+      */
+     bool selectOutputs(const std::vector<std::string>& outputs);
+     void selectAllOutputs();
+
+     /**
+      * Returns true if the given node is processed, i.e. needed by a
+      * selected or bound output.
+      */
+     bool isActive(const std::string& id);
+
      void reset();
      bool process();
      void flush();
 
+     /**
+      * Enable runtime profiling of all processing steps. If trace is true,
+      * every process and flush call is also recorded as a trace event.
+      */
+     void enableProfiling(bool trace=false);
+     void disableProfiling();
+     Profiler* getProfiler() { return m_profiler; }
+
    private:
      ComponentPool m_pool;
+     Profiler* m_profiler;
+     bool m_floatPrecision;
+     bool m_fusion;
+     EngineConfig m_config;
 
      class ProcessingStep {
       public:
+        enum StepKind { COMPONENT_STEP, INPUT_STEP, OUTPUT_STEP };
+
         ProcessingStep();
         ~ProcessingStep();
+        StepKind m_kind;
         std::string m_id;
+        std::string m_name;
         ParameterMap m_params;
         Component* m_component;
         ComponentPool* m_pool;
+        const Component* m_model;
         Ports<InputBuffer*> m_input;
         Ports<OutputBuffer*> m_output;
+        StepProfile* m_profile;
+        bool m_selected; // output computed even if not bound
+        bool m_active; // needed by a selected or bound output
+        int m_blockTokens; // tokens per output data block, 0 for automatic
+#ifdef WITH_TIMERS
+        Timer* m_timer; // step timer, charged by process
+        Timer* m_boundTimer; // bound reader or writer timer, charged by flush
+#endif
 
         bool hasInputAvailable() const;
      };
 
      typedef Graph<ProcessingStep> ProcessFlow;
      ProcessFlow* m_graph;
-     ProcessFlow::NodeList m_startNodes;
+
+     /**
+      * Input of a scheduled step. rate is the number of input tokens the
+      * step consumes per output token, from the sampleStep of the input
+      * and output streams.
+      */
+     class ScheduleInput {
+      public:
+        InputBuffer* buffer;
+        int rate;
+        int end; // end token number of the buffer when the step last ran
+     };
+
+     /**
+      * Execution schedule: steps in topological order, each step running
+      * at most once per process call, after all its sources. A step runs
+      * when it received new tokens and holds rate tokens on every input.
+      * Steps whose rate cannot be computed (dataDependent) run when they
+      * received new tokens and have input available.
+      */
+     class ScheduleEntry {
+      public:
+        ProcessFlow::Node* node;
+        std::vector<ScheduleInput> inputs;
+        bool dataDependent;
+     };
+     std::vector<ScheduleEntry> m_schedule;
 
      static inline bool initStep(ProcessFlow::Node& step);
      static inline bool resetStep(ProcessFlow::Node& step);
      static inline bool processStep(ProcessFlow::Node& step);
      static inline bool flushStep(ProcessFlow::Node& step);
+     static inline bool blockSizeStep(ProcessFlow::Node& step);
+     static inline bool sampleTypeStep(ProcessFlow::Node& step);
 
      ProcessingStep* getInputNode(const std::string& id);
      ProcessingStep* getOutputNode(const std::string& id);
+     bool hasKernelPrecision(const std::string& componentId);
+     static bool feedsDoubleInputComponent(const ProcessFlow::Node* n);
+     void fuseSteps(const DataFlow& df,
+         std::map<DataFlow::Node*,ProcessFlow::Node*>& mapping,
+         std::map<DataFlow::Node*,std::string>& ports);
+     bool initGraph();
+     bool buildSchedule();
+     void attachProfiler();
+     void updateActiveSteps();
 
   };
 
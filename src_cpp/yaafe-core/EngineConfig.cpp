@@ -0,0 +1,72 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EngineConfig.h"
+#include "Buffer.h"
+#include "Thread.h"
+#include "utils.h"
+
+namespace YAAFE
+{
+
+  static YAAFE_THREAD_LOCAL const EngineConfig* s_current = NULL;
+
+  EngineConfig::EngineConfig() :
+    m_verbose(-1), m_preferedBlockSize(0), m_blockBytes(0)
+  {
+  }
+
+  bool EngineConfig::verbose() const
+  {
+    return (m_verbose<0) ? verboseFlag : (m_verbose==1);
+  }
+
+  int EngineConfig::preferedBlockSize() const
+  {
+    return (m_preferedBlockSize>0) ? m_preferedBlockSize : DataBlock::s_preferedBlockSize;
+  }
+
+  int EngineConfig::blockBytes() const
+  {
+    return (m_blockBytes>0) ? m_blockBytes : DataBlock::s_blockBytes;
+  }
+
+  const EngineConfig& EngineConfig::current()
+  {
+    static const EngineConfig defaults;
+    return s_current ? *s_current : defaults;
+  }
+
+  EngineConfig::Scope::Scope(const EngineConfig& config) :
+    m_previous(s_current)
+  {
+    s_current = &config;
+  }
+
+  EngineConfig::Scope::~Scope()
+  {
+    s_current = m_previous;
+  }
+
+}
@@ -0,0 +1,90 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENGINECONFIG_H_
+#define ENGINECONFIG_H_
+
+namespace YAAFE
+{
+
+  /**
+   * Configuration of an engine, so that engines with different settings can
+   * run in the same process (concurrently when built with WITH_THREADS).
+   * Settings which are not set follow the process-wide defaults
+   * (verboseFlag, DataBlock::setPreferedBlockSize and
+   * DataBlock::setBlockBytes).
+   *
+   * Components read the configuration of the engine calling them with
+   * EngineConfig::current().
+   */
+  class EngineConfig
+  {
+   public:
+     EngineConfig();
+
+     void setVerbose(bool verbose) { m_verbose = verbose ? 1 : 0; }
+     bool verbose() const;
+
+     /**
+      * Prefered size of data blocks, in number of values.
+      */
+     void setPreferedBlockSize(int size) { m_preferedBlockSize = size; }
+     int preferedBlockSize() const;
+
+     /**
+      * Target size of data blocks, in bytes.
+      */
+     void setBlockBytes(int bytes) { m_blockBytes = bytes; }
+     int blockBytes() const;
+
+     /**
+      * Returns the configuration of the engine running in the calling
+      * thread, or the process-wide defaults outside of engine calls.
+      */
+     static const EngineConfig& current();
+
+     /**
+      * Makes a configuration current in the calling thread for the
+      * lifetime of the object.
+      */
+     class Scope
+     {
+      public:
+        explicit Scope(const EngineConfig& config);
+        ~Scope();
+      private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+        const EngineConfig* m_previous;
+     };
+
+   private:
+     int m_verbose; // -1 if not set
+     int m_preferedBlockSize; // 0 if not set
+     int m_blockBytes; // 0 if not set
+  };
+
+}
+
+#endif /* ENGINECONFIG_H_ */
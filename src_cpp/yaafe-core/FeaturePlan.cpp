@@ -0,0 +1,195 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FeaturePlan.h"
+#include "AudioFeature.h"
+#include "ComponentFactory.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace std;
+
+namespace YAAFE
+{
+
+  static std::string strip(const std::string& s)
+  {
+    const char* blanks = " \t\r\n";
+    size_t start = s.find_first_not_of(blanks);
+    if (start==string::npos)
+      return "";
+    size_t end = s.find_last_not_of(blanks);
+    return s.substr(start, end - start + 1);
+  }
+
+  static std::vector<std::string> split(const std::string& s, char sep)
+  {
+    vector<string> res;
+    size_t start = 0;
+    size_t pos;
+    while ((pos=s.find(sep,start))!=string::npos) {
+      res.push_back(s.substr(start, pos - start));
+      start = pos + 1;
+    }
+    res.push_back(s.substr(start));
+    return res;
+  }
+
+  /**
+   * Format a time in seconds as python does for floats
+   */
+  static std::string timeString(double t)
+  {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.15g", t);
+    string s = buf;
+    if (s.find_first_of(".en")==string::npos)
+      s += ".0";
+    return s + "s";
+  }
+
+  FeaturePlan::FeaturePlan(int sampleRate, double normalize, bool resample,
+      double timeStart, double timeLimit) : m_sampleRate(sampleRate)
+  {
+    ostringstream oss;
+    oss << sampleRate;
+    string normalizeStr = "-1";
+    if (normalize>=0) {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%f", normalize);
+      normalizeStr = buf;
+    }
+    m_audioParams["SampleRate"] = oss.str();
+    m_audioParams["Resample"] = resample ? "yes" : "no";
+    m_audioParams["TimeStart"] = timeString(timeStart);
+    m_audioParams["TimeLimit"] = timeString(timeLimit);
+    if (normalize>=0) {
+      m_audioParams["RemoveMean"] = "yes";
+      m_audioParams["ScaleMax"] = normalizeStr;
+    }
+    m_outAttrs["normalize"] = normalizeStr;
+    m_outAttrs["version"] = ComponentFactory::version();
+    m_outAttrs["samplerate"] = oss.str();
+    m_outAttrs["resample"] = resample ? "yes" : "no";
+  }
+
+  bool FeaturePlan::addFeature(const std::string& definition)
+  {
+    vector<string> data = split(definition, ':');
+    if (data.size()!=2) {
+      cerr << "ERROR: syntax error in \"" << definition << "\"" << endl;
+      return false;
+    }
+    string name = strip(data[0]);
+    string featdef = strip(data[1]);
+    // name@rate extracts the feature at another sample rate, from another
+    // input resampling the same audio
+    int sampleRate = m_sampleRate;
+    ParameterMap audioParams = m_audioParams;
+    ParameterMap outAttrs = m_outAttrs;
+    string inputName = "audio";
+    size_t at = name.find('@');
+    if (at!=string::npos) {
+      string rateStr = name.substr(at+1);
+      sampleRate = atoi(rateStr.c_str());
+      name = name.substr(0,at);
+      if (sampleRate<=0) {
+        cerr << "ERROR: invalid sample rate \"" << rateStr << "\" in \"" << definition << "\"" << endl;
+        return false;
+      }
+      if (sampleRate!=m_sampleRate) {
+        ostringstream oss;
+        oss << sampleRate;
+        audioParams["SampleRate"] = oss.str();
+        audioParams["Resample"] = "yes";
+        outAttrs["samplerate"] = oss.str();
+        outAttrs["resample"] = "yes";
+        inputName = "audio_" + oss.str();
+      }
+    }
+    DataFlow dataflow;
+    DataFlow::Node* inNode = dataflow.createNode(NodeDesc("Input",audioParams));
+    dataflow.setNodeName(inNode, inputName);
+    if (featdef.size()>0) {
+      vector<string> steps = split(featdef, '>');
+      for (vector<string>::const_iterator sIt=steps.begin(); sIt!=steps.end(); sIt++)
+      {
+        vector<string> bb = split(strip(*sIt), ' ');
+        const AudioFeature* feature = AudioFeature::get(bb[0]);
+        if (!feature)
+          return false;
+        ParameterMap params;
+        for (size_t i=1; i<bb.size(); i++)
+        {
+          if (bb[i].size()==0)
+            continue;
+          vector<string> dd = split(bb[i], '=');
+          if (dd.size()==1) {
+            cerr << "ERROR: invalid feature parameter \"" << bb[i] << "\"" << endl;
+            return false;
+          }
+          if (dd.size()!=2) {
+            cerr << "ERROR: syntax error in feature parameter \"" << bb[i] << "\"" << endl;
+            return false;
+          }
+          params[dd[0]] = dd[1];
+        }
+        DataFlow featureFlow;
+        feature->getDataFlow(params, sampleRate, featureFlow);
+        dataflow.append(featureFlow);
+      }
+    }
+    DataFlow::Node* fNode = dataflow.finalNodes()[0];
+    ParameterMap featAttrs = outAttrs;
+    featAttrs["yaafedefinition"] = featdef;
+    DataFlow::Node* outNode = dataflow.createNode(NodeDesc("Output",featAttrs));
+    dataflow.setNodeName(outNode, name);
+    dataflow.link(fNode, "", outNode, "");
+    m_dataflow.merge(dataflow);
+    return true;
+  }
+
+  bool FeaturePlan::loadFeaturePlan(const std::string& filename)
+  {
+    ifstream in(filename.c_str());
+    if (!in.good()) {
+      cerr << "ERROR: cannot open file " << filename << " !" << endl;
+      return false;
+    }
+    string line;
+    while (getline(in, line)) {
+      if (line.size()>0 && line[0]=='#')
+        continue;
+      line = strip(line);
+      if (line.size()>0 && !addFeature(line))
+        return false;
+    }
+    return true;
+  }
+
+}
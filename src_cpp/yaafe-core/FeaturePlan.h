@@ -0,0 +1,82 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FEATUREPLAN_H_
+#define FEATUREPLAN_H_
+
+#include "DataFlow.h"
+#include "utils.h"
+
+#include <string>
+
+namespace YAAFE
+{
+
+  /**
+   * Collection of features to extract at a given sample rate, compiled into
+   * a dataflow. Features are defined with the feature definition syntax
+   * used by yaafelib.FeaturePlan:
+   *
+   *   mfcc_d1: MFCC blockSize=512 stepSize=256 > Derivate DOrder=1
+   *
+   * A feature name may be followed by @samplerate to extract it at another
+   * sample rate, from an input named audio_<samplerate> resampling the audio:
+   *
+   *   mfcc44@44100: MFCC blockSize=1024 stepSize=512
+   *
+   * Common steps of several features are merged.
+   */
+  class FeaturePlan
+  {
+   public:
+     /**
+      * normalize is the signal maximum normalization, negative value to
+      * skip normalization. timeStart and timeLimit are in seconds.
+      */
+     FeaturePlan(int sampleRate=44100, double normalize=-1, bool resample=false,
+         double timeStart=0.0, double timeLimit=0.0);
+
+     /**
+      * Add a feature. Returns false on syntax error or unknown feature.
+      */
+     bool addFeature(const std::string& definition);
+
+     /**
+      * Add all features from a file, one feature definition per line. Lines
+      * starting with '#' are ignored.
+      */
+     bool loadFeaturePlan(const std::string& filename);
+
+     DataFlow& getDataFlow() { return m_dataflow; }
+
+   private:
+     int m_sampleRate;
+     ParameterMap m_audioParams;
+     ParameterMap m_outAttrs;
+     DataFlow m_dataflow;
+  };
+
+}
+
+#endif /* FEATUREPLAN_H_ */
@@ -0,0 +1,239 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KernelCache.h"
+#include "Component.h"
+#include "EngineConfig.h"
+#include "Thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <sstream>
+
+#ifdef __WIN32
+#include <windows.h>
+#include <process.h>
+#define KERNEL_CACHE_PATH_DELIMITER "\\"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define KERNEL_CACHE_PATH_DELIMITER "/"
+#endif
+
+#define KERNEL_CACHE_MAGIC "YAAFEKC1"
+#define KERNEL_CACHE_MAGIC_SIZE 8
+// data is aligned on 16 bytes in cache files
+#define KERNEL_CACHE_ALIGN 16
+
+using namespace std;
+
+namespace YAAFE
+{
+
+  // header of a cache file: magic, key size, key, then padding to align data
+  static size_t headerSize(size_t keySize)
+  {
+    size_t s = KERNEL_CACHE_MAGIC_SIZE + sizeof(unsigned int) + keySize;
+    return (s + KERNEL_CACHE_ALIGN - 1) / KERNEL_CACHE_ALIGN * KERNEL_CACHE_ALIGN;
+  }
+
+  // file name of the given key, with a FNV-1a hash of the key
+  static string cacheFile(const string& dir, const string& key)
+  {
+    unsigned long long h = 14695981039346656037ULL;
+    for (size_t i=0;i<key.size();i++) {
+      h ^= (unsigned char) key[i];
+      h *= 1099511628211ULL;
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%016llx", h);
+    return dir + KERNEL_CACHE_PATH_DELIMITER + key.substr(0,key.find(';')) + "-" + buf + ".bin";
+  }
+
+  KernelCache::Entry::Entry() :
+    m_map(NULL), m_mapSize(0), m_data(NULL), m_size(0)
+  {
+  }
+
+  KernelCache::Entry::~Entry()
+  {
+    if (!m_map)
+      return;
+#ifdef __WIN32
+    free(m_map);
+#else
+    munmap(m_map, m_mapSize);
+#endif
+  }
+
+  std::string KernelCache::directory()
+  {
+    const char* dir = getenv("YAAFE_KERNEL_CACHE");
+    if (!dir)
+      return "";
+    return dir;
+  }
+
+  std::string KernelCache::key(const Component& c, const ParameterMap& params,
+      const StreamInfo& in, int version)
+  {
+    ostringstream oss;
+    oss.precision(17);
+    oss << c.getIdentifier() << ";version=" << version;
+    ParameterDescriptorList pList = c.getParameterDescriptorList();
+    for (ParameterDescriptorList::const_iterator it=pList.begin();
+        it!=pList.end(); it++)
+      oss << ";" << it->m_identifier << "=" << getParam(it->m_identifier, params, pList);
+    oss << ";sampleRate=" << in.sampleRate << ";sampleStep=" << in.sampleStep
+        << ";frameLength=" << in.frameLength << ";size=" << in.size;
+    return oss.str();
+  }
+
+  SharedPtr<KernelCache::Entry> KernelCache::load(const std::string& key)
+  {
+    SharedPtr<Entry> entry;
+    string dir = directory();
+    if (dir.empty())
+      return entry;
+    string filename = cacheFile(dir, key);
+
+    Entry* e = new Entry();
+    entry.reset(e);
+#ifdef __WIN32
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f) {
+      entry.reset();
+      return entry;
+    }
+    fseek(f, 0, SEEK_END);
+    e->m_mapSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    e->m_map = (char*) malloc(e->m_mapSize);
+    size_t read = fread(e->m_map, 1, e->m_mapSize, f);
+    fclose(f);
+    if (read!=e->m_mapSize) {
+      entry.reset();
+      return entry;
+    }
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd<0) {
+      entry.reset();
+      return entry;
+    }
+    struct stat st;
+    if (fstat(fd, &st)!=0 || st.st_size==0) {
+      close(fd);
+      entry.reset();
+      return entry;
+    }
+    e->m_mapSize = st.st_size;
+    void* map = mmap(NULL, e->m_mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map==MAP_FAILED) {
+      entry.reset();
+      return entry;
+    }
+    e->m_map = (char*) map;
+#endif
+
+    // check header, the key is stored to detect hash collisions
+    unsigned int keySize = 0;
+    if (e->m_mapSize < KERNEL_CACHE_MAGIC_SIZE + sizeof(keySize)
+        || memcmp(e->m_map, KERNEL_CACHE_MAGIC, KERNEL_CACHE_MAGIC_SIZE)!=0) {
+      cerr << "WARNING: invalid kernel cache file " << filename << endl;
+      entry.reset();
+      return entry;
+    }
+    memcpy(&keySize, e->m_map + KERNEL_CACHE_MAGIC_SIZE, sizeof(keySize));
+    size_t offset = headerSize(keySize);
+    if (keySize!=key.size() || e->m_mapSize < offset
+        || key.compare(0, keySize, e->m_map + KERNEL_CACHE_MAGIC_SIZE + sizeof(keySize), keySize)!=0) {
+      entry.reset();
+      return entry;
+    }
+    e->m_data = e->m_map + offset;
+    e->m_size = e->m_mapSize - offset;
+    if (EngineConfig::current().verbose())
+      cerr << "load " << key << " from kernel cache" << endl;
+    return entry;
+  }
+
+  bool KernelCache::store(const std::string& key, const void* data, size_t size)
+  {
+    string dir = directory();
+    if (dir.empty())
+      return true;
+    struct stat st;
+    if (stat(dir.c_str(), &st)!=0) {
+#ifdef __WIN32
+      CreateDirectory(dir.c_str(), NULL);
+#else
+      mkdir(dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+#endif
+    }
+    string filename = cacheFile(dir, key);
+
+    // write to a temporary file, then rename it so that other processes
+    // never read an incomplete entry. The counter keeps the names of
+    // concurrent stores of the same process apart.
+    static int s_tmpCounter = 0;
+    const int tmpId = atomicIncrement(&s_tmpCounter);
+    ostringstream tmp;
+#ifdef __WIN32
+    tmp << filename << "." << _getpid() << "." << tmpId << ".tmp";
+#else
+    tmp << filename << "." << getpid() << "." << tmpId << ".tmp";
+#endif
+    FILE* f = fopen(tmp.str().c_str(), "wb");
+    if (!f) {
+      cerr << "WARNING: cannot write kernel cache file " << tmp.str() << endl;
+      return false;
+    }
+    unsigned int keySize = key.size();
+    string header(headerSize(keySize), '\0');
+    memcpy(&header[0], KERNEL_CACHE_MAGIC, KERNEL_CACHE_MAGIC_SIZE);
+    memcpy(&header[KERNEL_CACHE_MAGIC_SIZE], &keySize, sizeof(keySize));
+    memcpy(&header[KERNEL_CACHE_MAGIC_SIZE + sizeof(keySize)], key.data(), keySize);
+    bool ok = fwrite(header.data(), 1, header.size(), f)==header.size()
+        && fwrite(data, 1, size, f)==size;
+    ok = (fclose(f)==0) && ok;
+#ifdef __WIN32
+    // rename does not replace existing files on windows
+    remove(filename.c_str());
+#endif
+    if (!ok || rename(tmp.str().c_str(), filename.c_str())!=0) {
+      cerr << "WARNING: cannot write kernel cache file " << filename << endl;
+      remove(tmp.str().c_str());
+      return false;
+    }
+    if (EngineConfig::current().verbose())
+      cerr << "store " << key << " in kernel cache" << endl;
+    return true;
+  }
+
+}
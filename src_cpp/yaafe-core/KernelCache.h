@@ -0,0 +1,99 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KERNELCACHE_H_
+#define KERNELCACHE_H_
+
+#include "Buffer.h"
+#include "SharedPtr.h"
+#include "utils.h"
+#include <string>
+
+namespace YAAFE
+{
+
+  class Component;
+
+  /**
+   * On-disk cache of data precomputed by components at init (kernels, filter
+   * banks...), so that new processes do not compute them again. The cache is
+   * enabled by setting the YAAFE_KERNEL_CACHE environment variable to a
+   * directory.
+   *
+   * Entries are identified by a key built from the component identifier,
+   * its parameters and its input stream, and are mapped in memory when
+   * loaded. Entries are written atomically, so that several processes can
+   * share the same cache directory.
+   */
+  class KernelCache
+  {
+   public:
+     /**
+      * Cached data, read only.
+      */
+     class Entry
+     {
+      public:
+        ~Entry();
+        const char* data() const { return m_data; }
+        size_t size() const { return m_size; }
+      private:
+        friend class KernelCache;
+        Entry();
+        char* m_map;
+        size_t m_mapSize;
+        const char* m_data;
+        size_t m_size;
+     };
+
+     /**
+      * Returns the cache directory, or an empty string if the cache is
+      * disabled.
+      */
+     static std::string directory();
+
+     /**
+      * Build the key of data computed by component c from its parameters and
+      * input stream. version must be changed when the computation or the
+      * layout of the data change.
+      */
+     static std::string key(const Component& c, const ParameterMap& params,
+         const StreamInfo& in, int version);
+
+     /**
+      * Returns the entry stored with the given key, or a null pointer if
+      * there is no such entry or the cache is disabled.
+      */
+     static SharedPtr<Entry> load(const std::string& key);
+
+     /**
+      * Store size bytes of data with the given key. Does nothing if the cache
+      * is disabled. Returns false on error.
+      */
+     static bool store(const std::string& key, const void* data, size_t size);
+  };
+
+}
+
+#endif /* KERNELCACHE_H_ */
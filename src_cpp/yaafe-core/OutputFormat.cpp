@@ -163,7 +163,10 @@ namespace YAAFE {
   {
     Component* writer = ComponentFactory::instance()->createComponent("CSVWriter");
     ParameterMap writerParams = m_params;
-    writerParams["File"] = filenameConcat(m_outDir,inputfile,"." + feature + ".csv");
+    string suffix = "." + feature + ".csv";
+    if (writerParams["Compress"]=="True")
+      suffix += ".gz";
+    writerParams["File"] = filenameConcat(m_outDir,inputfile,suffix);
     writerParams["Attrs"] = encodeParameterMap(featureParams);
     if (!writer->init(writerParams,featureStream)) {
       delete writer;
@@ -0,0 +1,274 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Profiler.h"
+#include <time.h>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+// maximum number of trace events kept in memory
+#define MAX_TRACE_EVENTS 1000000
+
+using namespace std;
+
+namespace YAAFE
+{
+
+  static void writeJSONString(ostream& os, const string& str)
+  {
+    os << '"';
+    for (size_t i=0;i<str.size();i++) {
+      const char c = str[i];
+      if (c=='"' || c=='\\')
+        os << '\\' << c;
+      else if ((unsigned char) c < 0x20)
+        os << ' ';
+      else
+        os << c;
+    }
+    os << '"';
+  }
+
+  StepProfile::StepProfile(Profiler* owner, int index, const std::string& name,
+      const std::string& componentId) :
+    m_name(name), m_componentId(componentId), m_owner(owner), m_index(index)
+  {
+    clear();
+  }
+
+  void StepProfile::clear()
+  {
+    m_calls = 0;
+    m_wallTime = 0;
+    m_cpuTime = 0;
+    m_tokensIn = 0;
+    m_tokensOut = 0;
+    m_bytesIn = 0;
+    m_bytesOut = 0;
+    m_peakQueuedBlocks = 0;
+    m_allocations = 0;
+  }
+
+  void StepProfile::start(const Ports<InputBuffer*>& in,
+      const Ports<OutputBuffer*>& out)
+  {
+    int queued = 0;
+    m_startTokensIn = 0;
+    m_startBytesIn = 0;
+    for (size_t i=0;i<in.size();i++) {
+      const InputBuffer* b = in[i].data;
+      queued += b->queuedBlocks();
+      m_startTokensIn += b->tokenno();
+      m_startBytesIn += (long long) b->tokenno() * b->size() * sampleBytes(b->sampleType());
+    }
+    if (queued>m_peakQueuedBlocks)
+      m_peakQueuedBlocks = queued;
+    m_startTokensOut = 0;
+    m_startBytesOut = 0;
+    m_startAllocations = 0;
+    for (size_t i=0;i<out.size();i++) {
+      const OutputBuffer* b = out[i].data;
+      m_startTokensOut += b->tokenno();
+      m_startBytesOut += (long long) b->tokenno() * b->size() * sampleBytes(b->sampleType());
+      m_startAllocations += b->allocatedBlocks();
+    }
+    m_startCpu = Profiler::cpuClock();
+    m_startWall = Profiler::wallClock();
+  }
+
+  void StepProfile::stop(const Ports<InputBuffer*>& in,
+      const Ports<OutputBuffer*>& out, bool isFlush)
+  {
+    const double wall = Profiler::wallClock();
+    const double cpu = Profiler::cpuClock();
+    m_wallTime += wall - m_startWall;
+    m_cpuTime += cpu - m_startCpu;
+    if (!isFlush)
+      m_calls++;
+    for (size_t i=0;i<in.size();i++) {
+      const InputBuffer* b = in[i].data;
+      m_tokensIn += b->tokenno();
+      m_bytesIn += (long long) b->tokenno() * b->size() * sampleBytes(b->sampleType());
+    }
+    m_tokensIn -= m_startTokensIn;
+    m_bytesIn -= m_startBytesIn;
+    for (size_t i=0;i<out.size();i++) {
+      const OutputBuffer* b = out[i].data;
+      m_tokensOut += b->tokenno();
+      m_bytesOut += (long long) b->tokenno() * b->size() * sampleBytes(b->sampleType());
+      m_allocations += b->allocatedBlocks();
+    }
+    m_tokensOut -= m_startTokensOut;
+    m_bytesOut -= m_startBytesOut;
+    m_allocations -= m_startAllocations;
+    if (m_owner->m_trace)
+      m_owner->addEvent(m_index, isFlush, m_startWall, wall - m_startWall);
+  }
+
+  Profiler::Profiler(bool trace) :
+    m_trace(trace), m_origin(wallClock()), m_steps(), m_events(),
+    m_eventsDropped(false)
+  {
+  }
+
+  Profiler::~Profiler()
+  {
+    removeSteps();
+  }
+
+  StepProfile* Profiler::addStep(const std::string& name,
+      const std::string& componentId)
+  {
+    StepProfile* p = new StepProfile(this, m_steps.size(), name, componentId);
+    m_steps.push_back(p);
+    return p;
+  }
+
+  void Profiler::removeSteps()
+  {
+    for (vector<StepProfile*>::iterator it=m_steps.begin();
+        it!=m_steps.end(); it++)
+      delete *it;
+    m_steps.clear();
+    m_events.clear();
+    m_eventsDropped = false;
+  }
+
+  void Profiler::clear()
+  {
+    for (vector<StepProfile*>::iterator it=m_steps.begin();
+        it!=m_steps.end(); it++)
+      (*it)->clear();
+    m_events.clear();
+    m_eventsDropped = false;
+    m_origin = wallClock();
+  }
+
+  void Profiler::addEvent(int step, bool flush, double start, double duration)
+  {
+    if (m_events.size()>=MAX_TRACE_EVENTS) {
+      if (!m_eventsDropped) {
+        cerr << "WARNING: too many trace events, further events are dropped" << endl;
+        m_eventsDropped = true;
+      }
+      return;
+    }
+    TraceEvent e;
+    e.step = step;
+    e.flush = flush;
+    e.start = start;
+    e.duration = duration;
+    m_events.push_back(e);
+  }
+
+  void Profiler::writeJSON(std::ostream& os) const
+  {
+    double totalWall = 0;
+    double totalCpu = 0;
+    os << "{\n  \"steps\": [";
+    for (size_t i=0;i<m_steps.size();i++) {
+      const StepProfile* p = m_steps[i];
+      totalWall += p->m_wallTime;
+      totalCpu += p->m_cpuTime;
+      os << (i ? ",\n" : "\n") << "    {\"name\": ";
+      writeJSONString(os, p->m_name);
+      os << ", \"component\": ";
+      writeJSONString(os, p->m_componentId);
+      os << ", \"calls\": " << p->m_calls
+         << ", \"wallTime\": " << p->m_wallTime
+         << ", \"cpuTime\": " << p->m_cpuTime
+         << ", \"tokensIn\": " << p->m_tokensIn
+         << ", \"tokensOut\": " << p->m_tokensOut
+         << ", \"bytesIn\": " << p->m_bytesIn
+         << ", \"bytesOut\": " << p->m_bytesOut
+         << ", \"peakQueuedBlocks\": " << p->m_peakQueuedBlocks
+         << ", \"allocations\": " << p->m_allocations << "}";
+    }
+    os << "\n  ],\n  \"wallTime\": " << totalWall
+       << ",\n  \"cpuTime\": " << totalCpu << "\n}\n";
+  }
+
+  void Profiler::writeTrace(std::ostream& os) const
+  {
+    os << "{\"traceEvents\": [";
+    os << fixed << setprecision(3);
+    for (size_t i=0;i<m_events.size();i++) {
+      const TraceEvent& e = m_events[i];
+      const StepProfile* p = m_steps[e.step];
+      os << (i ? ",\n" : "\n") << "{\"name\": ";
+      writeJSONString(os, p->m_name);
+      os << ", \"cat\": ";
+      writeJSONString(os, e.flush ? "flush" : "process");
+      os << ", \"ph\": \"X\", \"pid\": 0, \"tid\": 0"
+         << ", \"ts\": " << (e.start - m_origin) * 1e6
+         << ", \"dur\": " << e.duration * 1e6
+         << ", \"args\": {\"component\": ";
+      writeJSONString(os, p->m_componentId);
+      os << "}}";
+    }
+    os << "\n], \"displayTimeUnit\": \"ms\"}\n";
+  }
+
+  bool Profiler::saveJSON(const std::string& filename) const
+  {
+    ofstream out(filename.c_str());
+    if (!out.is_open()) {
+      cerr << "ERROR: cannot open file " << filename << endl;
+      return false;
+    }
+    writeJSON(out);
+    return out.good();
+  }
+
+  bool Profiler::saveTrace(const std::string& filename) const
+  {
+    ofstream out(filename.c_str());
+    if (!out.is_open()) {
+      cerr << "ERROR: cannot open file " << filename << endl;
+      return false;
+    }
+    writeTrace(out);
+    return out.good();
+  }
+
+  double Profiler::wallClock()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return double(ts.tv_sec) + 1e-9 * double(ts.tv_nsec);
+  }
+
+  double Profiler::cpuClock()
+  {
+    timespec ts;
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+#else
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+#endif
+    return double(ts.tv_sec) + 1e-9 * double(ts.tv_nsec);
+  }
+
+}
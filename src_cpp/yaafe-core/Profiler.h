@@ -0,0 +1,127 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "Buffer.h"
+#include "Ports.h"
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace YAAFE
+{
+
+  class Profiler;
+
+  /**
+   * Runtime statistics of a processing step. Times are in seconds, bytes
+   * and tokens are counted on the step input and output buffers.
+   */
+  class StepProfile
+  {
+   public:
+     StepProfile(Profiler* owner, int index, const std::string& name,
+         const std::string& componentId);
+
+     void start(const Ports<InputBuffer*>& in, const Ports<OutputBuffer*>& out);
+     void stop(const Ports<InputBuffer*>& in, const Ports<OutputBuffer*>& out,
+         bool isFlush);
+     void clear();
+
+     std::string m_name;
+     std::string m_componentId;
+     long m_calls;
+     double m_wallTime;
+     double m_cpuTime;
+     long long m_tokensIn;
+     long long m_tokensOut;
+     long long m_bytesIn;
+     long long m_bytesOut;
+     int m_peakQueuedBlocks;
+     long m_allocations;
+
+   private:
+     Profiler* m_owner;
+     int m_index;
+     double m_startWall;
+     double m_startCpu;
+     long long m_startTokensIn;
+     long long m_startTokensOut;
+     long long m_startBytesIn;
+     long long m_startBytesOut;
+     long m_startAllocations;
+  };
+
+  /**
+   * Profiler collects StepProfile of all steps of an Engine, and optionally
+   * a trace of every process/flush call.
+   *
+   * Statistics can be exported as JSON, and traces in the Chrome trace
+   * event format (to be opened with chrome://tracing or Perfetto).
+   */
+  class Profiler
+  {
+   public:
+     Profiler(bool trace);
+     ~Profiler();
+
+     StepProfile* addStep(const std::string& name, const std::string& componentId);
+     const std::vector<StepProfile*>& getSteps() const { return m_steps; }
+     void removeSteps();
+     void clear();
+
+     bool tracing() const { return m_trace; }
+
+     void writeJSON(std::ostream& os) const;
+     void writeTrace(std::ostream& os) const;
+     bool saveJSON(const std::string& filename) const;
+     bool saveTrace(const std::string& filename) const;
+
+     static double wallClock();
+     static double cpuClock();
+
+   private:
+     friend class StepProfile;
+
+     struct TraceEvent {
+       int step;
+       bool flush;
+       double start;
+       double duration;
+     };
+
+     void addEvent(int step, bool flush, double start, double duration);
+
+     bool m_trace;
+     double m_origin;
+     std::vector<StepProfile*> m_steps;
+     std::vector<TraceEvent> m_events;
+     bool m_eventsDropped;
+  };
+
+}
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,103 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDPTR_H_
+#define SHAREDPTR_H_
+
+#include "Thread.h"
+
+#include <stdlib.h>
+
+namespace YAAFE
+{
+
+  /**
+   * Reference counted pointer to data shared between several component
+   * instances (kernels, filter banks, fft plans...). Shared data must not
+   * be modified once initialized. The reference count is updated
+   * atomically, so that instances sharing data can live in different
+   * threads.
+   */
+  template<class T>
+    class SharedPtr {
+     public:
+       SharedPtr() : m_data(NULL), m_count(NULL) {}
+       explicit SharedPtr(T* data) : m_data(data), m_count(NULL) {
+         if (m_data)
+           m_count = new int(1);
+       }
+       SharedPtr(const SharedPtr<T>& p) : m_data(p.m_data), m_count(p.m_count) {
+         acquire();
+       }
+       ~SharedPtr() { release(); }
+
+       SharedPtr<T>& operator=(const SharedPtr<T>& p) {
+         if (m_count!=p.m_count) {
+           release();
+           m_data = p.m_data;
+           m_count = p.m_count;
+           acquire();
+         }
+         return *this;
+       }
+
+       /**
+        * Release current data and hold the given data.
+        */
+       void reset(T* data=NULL) {
+         SharedPtr<T> p(data);
+         *this = p;
+       }
+
+       T* get() const { return m_data; }
+       T* operator->() const { return m_data; }
+       T& operator*() const { return *m_data; }
+       bool isNull() const { return m_data==NULL; }
+
+       /**
+        * Number of SharedPtr holding the data.
+        */
+       int useCount() const { return (m_count ? *m_count : 0); }
+
+     private:
+       void acquire() {
+         if (m_count)
+           atomicIncrement(m_count);
+       }
+       void release() {
+         if (m_count && atomicDecrement(m_count)==0) {
+           delete m_data;
+           delete m_count;
+         }
+         m_data = NULL;
+         m_count = NULL;
+       }
+
+       T* m_data;
+       int* m_count;
+    };
+
+}
+
+#endif /* SHAREDPTR_H_ */
@@ -0,0 +1,90 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Thread.h"
+#include <assert.h>
+
+namespace YAAFE
+{
+
+#ifdef WITH_THREADS
+
+  Mutex::Mutex() { pthread_mutex_init(&m_mutex,NULL); }
+  Mutex::~Mutex() { pthread_mutex_destroy(&m_mutex); }
+  void Mutex::lock() { pthread_mutex_lock(&m_mutex); }
+  void Mutex::unlock() { pthread_mutex_unlock(&m_mutex); }
+
+  Condition::Condition() { pthread_cond_init(&m_cond,NULL); }
+  Condition::~Condition() { pthread_cond_destroy(&m_cond); }
+  void Condition::wait(Mutex& mutex) { pthread_cond_wait(&m_cond,&mutex.m_mutex); }
+  void Condition::broadcast() { pthread_cond_broadcast(&m_cond); }
+
+  Thread::Thread() : m_started(false) {}
+
+  Thread::~Thread() {
+    assert(!m_started);
+  }
+
+  void* Thread::entry(void* thread)
+  {
+    static_cast<Thread*>(thread)->run();
+    return NULL;
+  }
+
+  bool Thread::start()
+  {
+    if (m_started)
+      return false;
+    m_started = (pthread_create(&m_thread,NULL,&Thread::entry,this)==0);
+    return m_started;
+  }
+
+  void Thread::join()
+  {
+    if (!m_started)
+      return;
+    pthread_join(m_thread,NULL);
+    m_started = false;
+  }
+
+#else
+
+  Mutex::Mutex() {}
+  Mutex::~Mutex() {}
+  void Mutex::lock() {}
+  void Mutex::unlock() {}
+
+  Condition::Condition() {}
+  Condition::~Condition() {}
+  void Condition::wait(Mutex& mutex) { assert(false); }
+  void Condition::broadcast() {}
+
+  Thread::Thread() : m_started(false) {}
+  Thread::~Thread() {}
+  bool Thread::start() { return false; }
+  void Thread::join() {}
+
+#endif
+
+}
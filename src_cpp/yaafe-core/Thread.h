@@ -0,0 +1,160 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_H_
+#define THREAD_H_
+
+#ifdef WITH_THREADS
+#include <pthread.h>
+#endif
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+
+/**
+ * Storage class of thread local variables. Variables are process-wide when
+ * Yaafe is built without WITH_THREADS.
+ */
+#ifndef WITH_THREADS
+#define YAAFE_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define YAAFE_THREAD_LOCAL __declspec(thread)
+#else
+#define YAAFE_THREAD_LOCAL __thread
+#endif
+
+namespace YAAFE
+{
+
+  /**
+   * Atomically increment or decrement a counter, and return its new value.
+   */
+  inline int atomicIncrement(volatile int* value)
+  {
+#ifdef _WIN32
+    return _InterlockedIncrement(reinterpret_cast<volatile long*>(value));
+#else
+    return __sync_add_and_fetch(value, 1);
+#endif
+  }
+
+  inline int atomicDecrement(volatile int* value)
+  {
+#ifdef _WIN32
+    return _InterlockedDecrement(reinterpret_cast<volatile long*>(value));
+#else
+    return __sync_sub_and_fetch(value, 1);
+#endif
+  }
+
+  /**
+   * Minimal wrappers around pthreads. When Yaafe is built without
+   * WITH_THREADS, Mutex and Condition do nothing and Thread::start fails,
+   * so that callers fall back to sequential processing. Locks then protect
+   * nothing: such builds must not use Yaafe from several threads.
+   */
+  class Mutex
+  {
+   public:
+     Mutex();
+     ~Mutex();
+     void lock();
+     void unlock();
+   private:
+     Mutex(const Mutex&);
+     Mutex& operator=(const Mutex&);
+#ifdef WITH_THREADS
+     pthread_mutex_t m_mutex;
+     friend class Condition;
+#endif
+  };
+
+  /**
+   * Locks a mutex for the lifetime of the object.
+   */
+  class MutexLock
+  {
+   public:
+     explicit MutexLock(Mutex& mutex) : m_mutex(mutex) { m_mutex.lock(); }
+     ~MutexLock() { m_mutex.unlock(); }
+   private:
+     MutexLock(const MutexLock&);
+     MutexLock& operator=(const MutexLock&);
+     Mutex& m_mutex;
+  };
+
+  class Condition
+  {
+   public:
+     Condition();
+     ~Condition();
+     /**
+      * Wait for the condition to be signaled. The mutex must be locked.
+      */
+     void wait(Mutex& mutex);
+     void broadcast();
+   private:
+     Condition(const Condition&);
+     Condition& operator=(const Condition&);
+#ifdef WITH_THREADS
+     pthread_cond_t m_cond;
+#endif
+  };
+
+  /**
+   * Thread executing the run method. Subclasses must call join before
+   * being destroyed.
+   */
+  class Thread
+  {
+   public:
+     Thread();
+     virtual ~Thread();
+
+     /**
+      * Start the thread. Returns false if the thread cannot be started, or
+      * if Yaafe is built without threads support.
+      */
+     bool start();
+     /**
+      * Wait for the end of the thread, if started.
+      */
+     void join();
+
+   protected:
+     virtual void run() = 0;
+
+   private:
+     Thread(const Thread&);
+     Thread& operator=(const Thread&);
+     bool m_started;
+#ifdef WITH_THREADS
+     pthread_t m_thread;
+     static void* entry(void* thread);
+#endif
+  };
+
+}
+
+#endif /* THREAD_H_ */
@@ -108,39 +108,35 @@ namespace YAAFE
 #ifdef WITH_TIMERS
 
   vector<Timer*> Timer::s_allTimers;
+  Mutex Timer::s_mutex;
 
   Timer::Timer(const std::string& name) :
-    m_name(name), m_totalTime(0.0), m_lastStart(0)
+    m_name(name), m_totalTime(0.0)
   {}
 
   Timer* Timer::get_timer(const string& name)
   {
-    Timer* t = NULL;
-#pragma omp critical (gettimer)
+    MutexLock lock(s_mutex);
+    for (vector<Timer*>::iterator it=s_allTimers.begin();it!=s_allTimers.end();it++)
     {
-      for (vector<Timer*>::iterator it=s_allTimers.begin();it!=s_allTimers.end();it++)
-      {
-        if ((*it)->m_name == name) {
-          t = *it;
-          break;
-        }
-      }
-      if (t == NULL) {
-        t = new Timer(name);
-        Timer::s_allTimers.push_back(t);
-      }
+      if ((*it)->m_name == name)
+        return *it;
     }
+    Timer* t = new Timer(name);
+    s_allTimers.push_back(t);
     return t;
   }
 
   void Timer::print_all_timers()
   {
+    MutexLock lock(s_mutex);
     for (vector<Timer*>::const_iterator it=s_allTimers.begin();
         it!=s_allTimers.end();it++)
     {
       cout << (*it)->m_name << " : " << (*it)->m_totalTime << endl;
       delete *it;
     }
+    s_allTimers.clear();
   }
 
 #endif
@@ -32,6 +32,8 @@
 
 #ifdef WITH_TIMERS
 #include <unistd.h>
+#include <time.h>
+#include "Thread.h"
 #endif
 
 namespace YAAFE
@@ -51,13 +53,19 @@ namespace YAAFE
   ParameterMap decodeParameterMap(const std::string& str);
 
   /**
-   * verbose flag
+   * Process-wide verbose flag, used by engines whose configuration does not
+   * set it (see EngineConfig).
    */
   extern bool verboseFlag;
 
 
 #ifdef WITH_TIMERS
 
+  /**
+   * Named cpu time accumulator. Timers are shared by all engines, and can be
+   * used from several threads: start returns the start time, which is given
+   * back to stop.
+   */
   class Timer
   {
    public:
@@ -65,8 +73,8 @@ namespace YAAFE
      {
      }
 
-     void start();
-     void stop();
+     double start() const;
+     void stop(double startTime);
 
      static Timer* get_timer(const std::string& name);
      static void print_all_timers();
@@ -76,26 +84,29 @@ namespace YAAFE
 
      std::string m_name;
      double m_totalTime;
-     double m_lastStart;
+     Mutex m_mutex;
 
      static std::vector<Timer*> s_allTimers;
+     static Mutex s_mutex;
   };
 
   static double getCPUTime()
   {
     timespec ts;
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
     return double(ts.tv_sec) + 1e-9 * double(ts.tv_nsec);
   }
 
-  inline void Timer::start()
+  inline double Timer::start() const
   {
-    m_lastStart = getCPUTime();
+    return getCPUTime();
   }
 
-  inline void Timer::stop()
+  inline void Timer::stop(double startTime)
   {
-    m_totalTime += (getCPUTime() - m_lastStart);
+    const double elapsed = getCPUTime() - startTime;
+    MutexLock lock(m_mutex);
+    m_totalTime += elapsed;
   }
 
 #endif
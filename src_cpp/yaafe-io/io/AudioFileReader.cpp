@@ -24,6 +24,7 @@
 
 #include "AudioFileReader.h"
 #include "SmarcPFilterCache.h"
+#include "yaafe-core/EngineConfig.h"
 #include <string.h>
 #include <cstdlib>
 #include <iostream>
@@ -37,18 +38,16 @@ namespace YAAFE {
     m_sampleRate(0), m_bufferSize(0), m_sndfile(NULL), m_sfinfo(), m_readBuffer(NULL),
     m_filter(NULL), m_state(NULL), m_resampleBufferSize(0), m_resampleBuffer(NULL),
     m_resample(false), m_rescale(false), m_mean(0), m_factor(1), m_startSecond(0),
-    m_limitSecond(0), m_frameLeft(0) {
+    m_limitSecond(0), m_frameLeft(0), m_readAheadBlocks(0), m_readAhead(NULL) {
     }
 
   AudioFileReader::~AudioFileReader() {
+    // stop decode thread before closing file
+    if (m_readAhead)
+      delete m_readAhead;
     closeFile();
-    if (m_filter) {
-      SmarcPFilterCache::release();
-    }
     if (m_readBuffer)
       delete[] m_readBuffer;
-    if (m_resampleBuffer)
-      delete[] m_resampleBuffer;
   }
 
   int AudioFileReader::readFramesIntoBuffer() {
@@ -78,10 +77,15 @@ namespace YAAFE {
     return nbRead;
   }
 
+  int AudioFileReader::decodeBlock(double*& data) {
+    data = m_readBuffer;
+    return readFramesIntoBuffer();
+  }
+
   bool AudioFileReader::openFile(const std::string& filename) {
     // close file if one is opened
     if (m_sndfile) {
-      if (verboseFlag)
+      if (EngineConfig::current().verbose())
         cerr << "WARNING: close old audio file when opening " << filename
           << endl;
       closeFile();
@@ -105,9 +109,12 @@ namespace YAAFE {
                                "audio file to mono doing mean of channels");
     }
 
+    if (m_sampleRate<=0)
+      m_sampleRate = m_sfinfo.samplerate; // keep file sample rate
+
     if (m_resample && (m_sampleRate!=m_sfinfo.samplerate)) {
       int fsin = m_sfinfo.samplerate;
-      m_filter = SmarcPFilterCache::getPFilter(fsin,m_sampleRate);
+      m_filter = SmarcPFilterCache::getPFilter(fsin,m_sampleRate,m_resampleQuality);
       if (!m_filter) return false;
       m_state = smarc_init_pstate(m_filter);
       m_resampleBufferSize = smarc_get_output_buffer_size(m_filter,m_bufferSize);
@@ -156,6 +163,14 @@ namespace YAAFE {
       smarc_destroy_pstate(m_state);
       m_state = NULL;
     }
+    if (m_filter) {
+      SmarcPFilterCache::release(m_filter);
+      m_filter = NULL;
+    }
+    if (m_resampleBuffer) {
+      delete[] m_resampleBuffer;
+      m_resampleBuffer = NULL;
+    }
     if (m_sndfile) {
       sf_close(m_sndfile);
       m_sndfile = NULL;
@@ -182,7 +197,7 @@ namespace YAAFE {
     pList.push_back(p);
 
     p.m_identifier = "SampleRate";
-    p.m_description = "Check audio sample rate.";
+    p.m_description = "Check audio sample rate, 0 to output audio at the file sample rate.";
     p.m_defaultValue = "16000";
     pList.push_back(p);
 
@@ -191,6 +206,11 @@ namespace YAAFE {
     p.m_defaultValue = "no";
     pList.push_back(p);
 
+    p.m_identifier = "ResampleQuality";
+    p.m_description = "high|medium|fast, resampling filter quality. Lower quality resamples faster with a narrower bandwidth and a lower stopband attenuation.";
+    p.m_defaultValue = "high";
+    pList.push_back(p);
+
     p.m_identifier = "TimeStart";
     p.m_description = "time position where to start process";
     p.m_defaultValue = "0s";
@@ -201,15 +221,22 @@ namespace YAAFE {
     p.m_defaultValue = "0s";
     pList.push_back(p);
 
+    p.m_identifier = "ReadAheadBlocks";
+    p.m_description = "number of blocks decoded in advance by a background thread, 0 to decode when needed";
+    p.m_defaultValue = "0";
+    pList.push_back(p);
+
     return pList;
   }
 
   bool AudioFileReader::init(const ParameterMap& params, const Ports<StreamInfo>& in)
   {
     m_resample = (getStringParam("Resample", params)=="yes");
+    m_resampleQuality = getStringParam("ResampleQuality", params);
     m_removemean = (getStringParam("RemoveMean",params)=="yes");
     m_scaleMax = getDoubleParam("ScaleMax",params);
     m_sampleRate = 	getIntParam("SampleRate",params);
+    m_readAheadBlocks = getIntParam("ReadAheadBlocks",params);
     string filename = getStringParam("File", params);
     string timeStart = getStringParam("TimeStart",params);
 
@@ -273,7 +300,7 @@ namespace YAAFE {
         return false;
       }
 
-      if (verboseFlag)
+      if (EngineConfig::current().verbose())
         cerr << "INFO: remove mean of input signal (" << m_mean << ") and scale to " << m_scaleMax << endl;
       closeFile();
       if (!openFile(filename)) {
@@ -293,6 +320,16 @@ namespace YAAFE {
     outInfo.sampleRate = m_sampleRate;
     outInfo.sampleStep = 1;
     outInfo.frameLength = 1;
+
+    if (m_readAheadBlocks>0) {
+      m_readAhead = new ReadAhead(this,m_readAheadBlocks);
+      if (!m_readAhead->start()) {
+        if (EngineConfig::current().verbose())
+          cerr << "WARNING: cannot start read-ahead thread, decode " << filename << " when needed" << endl;
+        delete m_readAhead;
+        m_readAhead = NULL;
+      }
+    }
     return true;
   }
 
@@ -302,13 +339,14 @@ namespace YAAFE {
     assert(outp.size()==1);
     OutputBuffer* out = outp[0].data;
 
-    int nbRead = readFramesIntoBuffer();
+    double* buf = m_readBuffer;
+    int nbRead = (m_readAhead ? m_readAhead->next(buf) : readFramesIntoBuffer());
     if (nbRead==0)
       return false;
     if (m_rescale)
       for (int i=0;i<nbRead;i++)
-        m_readBuffer[i] = (m_readBuffer[i] - m_mean) * m_factor;
-    out->write(m_readBuffer,nbRead);
+        buf[i] = (buf[i] - m_mean) * m_factor;
+    out->write(buf,nbRead);
     return true;
   }
 
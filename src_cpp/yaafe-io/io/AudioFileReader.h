@@ -28,13 +28,14 @@
 #include "yaafe-core/Component.h"
 #include "sndfile.h"
 #include "smarc.h"
+#include "ReadAhead.h"
 
 #define AUDIO_FILE_READER_ID "AudioFileReader"
 
 namespace YAAFE
 {
 
-  class AudioFileReader: public ComponentBase<AudioFileReader>
+  class AudioFileReader: public ComponentBase<AudioFileReader>, private ReadAhead::Source
   {
    public:
      AudioFileReader();
@@ -62,6 +63,7 @@ namespace YAAFE
      double* m_resampleBuffer;
 
      bool m_resample;
+     std::string m_resampleQuality;
      bool m_removemean;
      double m_scaleMax;
 
@@ -72,9 +74,13 @@ namespace YAAFE
      double m_startSecond, m_limitSecond;
      sf_count_t m_frameLeft;
 
+     int m_readAheadBlocks;
+     ReadAhead* m_readAhead;
+
      bool openFile(const std::string& filename);
      void closeFile();
      int readFramesIntoBuffer(); // read m_bufferSize frames
+     virtual int decodeBlock(double*& data);
 
   };
 
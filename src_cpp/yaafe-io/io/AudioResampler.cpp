@@ -0,0 +1,146 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AudioResampler.h"
+#include "SmarcPFilterCache.h"
+#include <iostream>
+
+using namespace std;
+
+namespace YAAFE {
+
+  AudioResampler::AudioResampler() :
+    m_filter(NULL), m_state(NULL), m_bufferSize(0), m_buffer(NULL) {
+  }
+
+  AudioResampler::~AudioResampler() {
+    if (m_state)
+      smarc_destroy_pstate(m_state);
+    if (m_filter)
+      SmarcPFilterCache::release(m_filter);
+    if (m_buffer)
+      delete [] m_buffer;
+  }
+
+  ParameterDescriptorList AudioResampler::getParameterDescriptorList() const {
+    ParameterDescriptorList pList;
+    ParameterDescriptor p;
+
+    p.m_identifier = "SampleRate";
+    p.m_description = "output sample rate";
+    p.m_defaultValue = "16000";
+    pList.push_back(p);
+
+    p.m_identifier = "ResampleQuality";
+    p.m_description = "high|medium|fast, resampling filter quality. Lower quality resamples faster with a narrower bandwidth and a lower stopband attenuation.";
+    p.m_defaultValue = "high";
+    pList.push_back(p);
+
+    return pList;
+  }
+
+  bool AudioResampler::init(const ParameterMap& params, const Ports<StreamInfo>& in)
+  {
+    assert(in.size()==1);
+    const StreamInfo& inInfo = in[0].data;
+    if (inInfo.size!=1) {
+      cerr << "ERROR: AudioResampler input must be an audio signal !" << endl;
+      return false;
+    }
+    int fsin = (int) inInfo.sampleRate;
+    int fsout = getIntParam("SampleRate",params);
+    if (fsout<=0) {
+      cerr << "ERROR: invalid sample rate " << fsout << " !" << endl;
+      return false;
+    }
+    if (fsin!=fsout) {
+      m_filter = SmarcPFilterCache::getPFilter(fsin,fsout,getStringParam("ResampleQuality",params));
+      if (!m_filter) {
+        cerr << "ERROR: cannot resample from " << fsin << " to " << fsout << endl;
+        return false;
+      }
+      m_state = smarc_init_pstate(m_filter);
+      resizeBuffer(smarc_get_output_buffer_size(m_filter,DataBlock::preferedBlockSize()));
+    }
+
+    outStreamInfo().add(StreamInfo(inInfo,1));
+    StreamInfo& outInfo = outStreamInfo()[0].data;
+    outInfo.sampleRate = fsout;
+    outInfo.sampleStep = 1;
+    outInfo.frameLength = 1;
+    return true;
+  }
+
+  void AudioResampler::resizeBuffer(int size)
+  {
+    if (size<=m_bufferSize)
+      return;
+    if (m_buffer)
+      delete [] m_buffer;
+    m_bufferSize = size;
+    m_buffer = new double[m_bufferSize];
+  }
+
+  void AudioResampler::reset()
+  {
+    if (m_state)
+      smarc_reset_pstate(m_state,m_filter);
+  }
+
+  bool AudioResampler::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  {
+    assert(inp.size()==1);
+    assert(outp.size()==1);
+    InputBuffer* in = inp[0].data;
+    OutputBuffer* out = outp[0].data;
+    if (in->empty())
+      return false;
+    while (!in->empty()) {
+      int nbTokens = in->blockAvailableTokens();
+      double* data = in->readToken();
+      if (m_filter) {
+        resizeBuffer(smarc_get_output_buffer_size(m_filter,nbTokens));
+        int nbOut = smarc_resample(m_filter,m_state,data,nbTokens,m_buffer,m_bufferSize);
+        out->write(m_buffer,nbOut);
+      } else {
+        out->write(data,nbTokens);
+      }
+      in->blockConsume();
+    }
+    return true;
+  }
+
+  void AudioResampler::flush(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
+  {
+    process(inp,outp);
+    if (m_filter) {
+      // smarc_resample_flush stops when the buffer is full, call it until
+      // all stages are flushed
+      int nbOut;
+      while ((nbOut = smarc_resample_flush(m_filter,m_state,m_buffer,m_bufferSize))>0)
+        outp[0].data->write(m_buffer,nbOut);
+    }
+  }
+
+}
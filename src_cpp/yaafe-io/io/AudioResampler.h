@@ -0,0 +1,67 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIORESAMPLER_H_
+#define AUDIORESAMPLER_H_
+
+#include "yaafe-core/Component.h"
+#include "smarc.h"
+
+#define AUDIO_RESAMPLER_ID "AudioResampler"
+
+namespace YAAFE
+{
+
+  /**
+   * Resample a decoded audio stream to the given sample rate. Used to feed
+   * several inputs at different sample rates from a single audio reader.
+   */
+  class AudioResampler: public ComponentBase<AudioResampler>
+  {
+   public:
+     AudioResampler();
+     virtual ~AudioResampler();
+
+     virtual const std::string getIdentifier() const { return AUDIO_RESAMPLER_ID; }
+     virtual bool stateLess() const { return false; };
+
+     virtual ParameterDescriptorList getParameterDescriptorList() const;
+
+     virtual bool init(const ParameterMap& params, const Ports<StreamInfo>& in);
+     virtual void reset();
+     virtual bool process(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+     virtual void flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
+
+   private:
+     struct PFilter* m_filter;
+     struct PState* m_state;
+     int m_bufferSize;
+     double* m_buffer;
+
+     void resizeBuffer(int size);
+  };
+
+}
+
+#endif /* AUDIORESAMPLER_H_ */
@@ -25,19 +25,35 @@
 #include "CSVWriter.h"
 #include "FileUtils.h"
 #include <sstream>
+#include <cstring>
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
 
-#define BUFSIZE 64
+// maximum number of characters needed to format one value
+#define VALUE_MAXCHARS 64
+// size of the output buffer, flushed to the file with a single write
+#define OUTPUT_BUFFER_SIZE (1<<16)
+
+#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+#define CSV_USE_TO_CHARS 1
+#endif
 
 using namespace std;
 
 namespace YAAFE {
 
-  CSVWriter::CSVWriter() {
+  CSVWriter::CSVWriter() :
+      m_fout(NULL),
+#ifdef WITH_ZLIB
+      m_gzout(NULL),
+#endif
+      m_compress(false), m_precision(6), m_bufferUsed(0)
+  {
   }
 
   CSVWriter::~CSVWriter() {
-    if (m_fout.is_open())
-      m_fout.close();
+    closeOutput();
   }
 
   ParameterDescriptorList CSVWriter::getParameterDescriptorList() const
@@ -61,10 +77,15 @@ namespace YAAFE {
     pList.push_back(p);
 
     p.m_identifier = "Precision";
-    p.m_description = "precision of output floating point number.";
+    p.m_description = "precision of output floating point number. If negative, write the shortest representation that reads back to the same value.";
     p.m_defaultValue = "6";
     pList.push_back(p);
 
+    p.m_identifier = "Compress";
+    p.m_description = "If 'True' then compress the csv file with gzip (requires zlib support).";
+    p.m_defaultValue = "False";
+    pList.push_back(p);
+
     return pList;
   }
 
@@ -75,17 +96,31 @@ namespace YAAFE {
 
     string outputFile = getStringParam("File", params);
     m_precision = getIntParam("Precision",params);
-    if (m_precision > (BUFSIZE-10)) {
-      cerr << "WARNING: precision is too large ! use precision " << BUFSIZE - 10 << endl;
-      m_precision = BUFSIZE - 10;
+    if (m_precision > (VALUE_MAXCHARS-10)) {
+      cerr << "WARNING: precision is too large ! use precision " << VALUE_MAXCHARS - 10 << endl;
+      m_precision = VALUE_MAXCHARS - 10;
     }
+    m_compress = (getStringParam("Compress",params)=="True");
+#ifndef WITH_ZLIB
+    if (m_compress) {
+      cerr << "ERROR: cannot compress csv output, yaafe was built without zlib support !" << endl;
+      return false;
+    }
+#endif
+
+    // lines buffered for a previous file go to that file
+    closeOutput();
+
+    // the buffer always holds at least a few complete lines
+    const size_t lineSize = in.size * (VALUE_MAXCHARS + 1) + 1;
+    m_buffer.resize(max((size_t) OUTPUT_BUFFER_SIZE, 4 * lineSize));
+    m_bufferUsed = 0;
 
     int res = preparedirs(outputFile.c_str());
     if (res!=0)
       return false;
 
-    m_fout.open(outputFile.c_str(), ios_base::trunc);
-    if (!m_fout.is_open() || m_fout.bad())
+    if (!openOutput(outputFile))
       return false;
 
     if (getStringParam("Metadata",params)=="True") {
@@ -94,8 +129,9 @@ namespace YAAFE {
       map<string,string> params = decodeAttributeStr(paramStr);
       ostringstream oss;
       for (map<string,string>::const_iterator it=params.begin();it!=params.end();it++)
-        oss << "% " << it->first << "=" << it->second << endl;
-      m_fout.write(oss.str().c_str(),oss.str().size());
+        oss << "% " << it->first << "=" << it->second << "\n";
+      if (!writeOutput(oss.str().c_str(),oss.str().size()))
+        return false;
     }
 
     return true;
@@ -105,33 +141,116 @@ namespace YAAFE {
     // nothing to do
   }
 
+  bool CSVWriter::openOutput(const std::string& filename)
+  {
+    closeOutput();
+#ifdef WITH_ZLIB
+    if (m_compress) {
+      m_gzout = gzopen(filename.c_str(), "wb");
+      if (m_gzout==NULL) {
+        cerr << "ERROR: cannot open file " << filename << endl;
+        return false;
+      }
+      return true;
+    }
+#endif
+    m_fout = fopen(filename.c_str(), "wb");
+    if (m_fout==NULL) {
+      cerr << "ERROR: cannot open file " << filename << endl;
+      return false;
+    }
+    // data is already buffered in m_buffer
+    setvbuf(m_fout, NULL, _IONBF, 0);
+    return true;
+  }
+
+  bool CSVWriter::writeOutput(const char* data, size_t len)
+  {
+    if (len==0)
+      return true;
+#ifdef WITH_ZLIB
+    if (m_gzout!=NULL)
+      return gzwrite(m_gzout, data, (unsigned) len) == (int) len;
+#endif
+    if (m_fout==NULL)
+      return false;
+    return fwrite(data, 1, len, m_fout) == len;
+  }
+
+  void CSVWriter::closeOutput()
+  {
+    // write out buffered lines before closing
+    if (m_bufferUsed>0 && !writeOutput(&m_buffer[0], m_bufferUsed))
+      cerr << "ERROR: failed to write csv output !" << endl;
+    m_bufferUsed = 0;
+#ifdef WITH_ZLIB
+    if (m_gzout!=NULL) {
+      gzclose(m_gzout);
+      m_gzout = NULL;
+    }
+#endif
+    if (m_fout!=NULL) {
+      fclose(m_fout);
+      m_fout = NULL;
+    }
+  }
+
+  char* CSVWriter::formatValue(char* dst, double value) const
+  {
+#ifdef CSV_USE_TO_CHARS
+    if (m_precision<0)
+      return std::to_chars(dst, dst + VALUE_MAXCHARS, value).ptr;
+    return std::to_chars(dst, dst + VALUE_MAXCHARS, value,
+        std::chars_format::scientific, m_precision).ptr;
+#else
+    if (m_precision<0)
+      return dst + snprintf(dst, VALUE_MAXCHARS, "%.17g", value);
+    return dst + snprintf(dst, VALUE_MAXCHARS, "%0.*e", m_precision, value);
+#endif
+  }
+
   bool CSVWriter::process(Ports<InputBuffer*>& inp, Ports<OutputBuffer*>& outp)
   {
     assert(inp.size()==1);
     InputBuffer* in = inp[0].data;
     assert(outp.size()==0);
-    char buf[BUFSIZE];
+    const int size = in->info().size;
+    const size_t lineSize = size * (VALUE_MAXCHARS + 1) + 1;
+    char* const begin = &m_buffer[0];
+    char* const end = begin + m_buffer.size();
+    char* dst = begin + m_bufferUsed;
+    bool ok = true;
     while (!in->empty())
     {
-      double* data = in->readToken();
-      int strSize = sprintf(buf,"%0.*e",m_precision,data[0]);
-      m_fout.write(buf,strSize);
-      for (int i=1;i<in->info().size;i++)
+      const int nbTokens = in->blockAvailableTokens();
+      const double* data = in->readToken();
+      for (int t=0;t<nbTokens;t++,data+=size)
       {
-        strSize = sprintf(buf,",%0.*e",m_precision,data[i]);
-        m_fout.write(buf,strSize);
+        if ((size_t) (end - dst) < lineSize) {
+          ok = writeOutput(begin, dst - begin) && ok;
+          dst = begin;
+        }
+        if (size>0)
+          dst = formatValue(dst,data[0]);
+        for (int i=1;i<size;i++)
+        {
+          *dst++ = ',';
+          dst = formatValue(dst,data[i]);
+        }
+        *dst++ = '\n';
       }
-      m_fout << endl;
-      in->consumeToken();
+      in->blockConsume();
     }
-    return true;
+    m_bufferUsed = dst - begin;
+    if (!ok)
+      cerr << "ERROR: failed to write csv output !" << endl;
+    return ok;
   }
 
   void CSVWriter::flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out)
   {
     process(in,out);
-    m_fout.close();
+    closeOutput();
   }
 
 }
-
@@ -26,7 +26,11 @@
 #define CSVWRITER_H_
 
 #include "yaafe-core/Component.h"
-#include <fstream>
+#include <cstdio>
+#include <vector>
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
 
 #define CSVWRITER_ID "CSVWriter"
 
@@ -51,8 +55,19 @@ namespace YAAFE {
      virtual void flush(Ports<InputBuffer*>& in, Ports<OutputBuffer*>& out);
 
    private:
-     std::ofstream m_fout;
+     bool openOutput(const std::string& filename);
+     bool writeOutput(const char* data, size_t len);
+     void closeOutput();
+     char* formatValue(char* dst, double value) const;
+
+     FILE* m_fout;
+#ifdef WITH_ZLIB
+     gzFile m_gzout;
+#endif
+     bool m_compress;
      int m_precision;
+     std::vector<char> m_buffer;
+     size_t m_bufferUsed;
   };
 
 }
@@ -24,6 +24,7 @@
 
 #include "H5DatasetWriter.h"
 #include "FileUtils.h"
+#include "yaafe-core/EngineConfig.h"
 #include <iostream>
 #include <string.h>
 #include <stdlib.h>
@@ -51,6 +52,7 @@ namespace YAAFE
 
   H5DatasetWriter::~H5DatasetWriter()
   {
+    MutexLock lock(s_mutex);
     if (m_table>=0)
       H5PTclose(m_table);
     if (m_h5file>=0)
@@ -117,6 +119,7 @@ namespace YAAFE
     }
 
     // open or create outputFile
+    MutexLock lock(s_mutex);
     m_h5file = openH5File(outputFile);
     if (m_h5file<0)
       return false;
@@ -125,7 +128,7 @@ namespace YAAFE
     {
       if (mode=="overwrite")
       {
-        if (verboseFlag)
+        if (EngineConfig::current().verbose())
           cerr << "INFO: overwrite H5 dataset " << dataset << endl;
         herr_t res = H5Ldelete(m_h5file, dataset.c_str(), H5P_DEFAULT);
         if (res < 0)
@@ -210,6 +213,7 @@ namespace YAAFE
     assert(inp.size()==1);
     InputBuffer* in = inp[0].data;
     assert(outp.size()==0);
+    MutexLock lock(s_mutex);
     while (!in->empty()) {
       H5PTappend(m_table, in->blockAvailableTokens(), in->readToken());
       in->blockConsume();
@@ -221,6 +225,7 @@ namespace YAAFE
   {
     process(in, out);
 
+    MutexLock lock(s_mutex);
     // close dataset
     if (m_table>=0)
       H5PTclose(m_table);
@@ -232,6 +237,7 @@ namespace YAAFE
   }
 
   std::vector<H5DatasetWriter::H5FileHandler> H5DatasetWriter::s_files;
+  Mutex H5DatasetWriter::s_mutex;
 
   hid_t H5DatasetWriter::openH5File(const std::string& filename)
   {
@@ -26,6 +26,7 @@
 #define H5FEATUREWRITER_H_
 
 #include "yaafe-core/Component.h"
+#include "yaafe-core/Thread.h"
 #include <vector>
 #include "hdf5.h"
 
@@ -43,6 +44,8 @@ namespace YAAFE {
      }
 
      virtual bool stateLess() const { return false; };
+     // false if the dataset is up to date
+     virtual bool needsInput() const { return m_table>=0; }
 
      virtual ParameterDescriptorList getParameterDescriptorList() const;
 
@@ -57,12 +60,17 @@ namespace YAAFE {
      hid_t m_table;
 
 
+     // files opened by writers, shared by writers of all engines and
+     // closed by the last one
      struct H5FileHandler {
        std::string filename;
        hid_t id;
        int count;
      };
      static std::vector<H5FileHandler> s_files;
+     // serializes HDF5 calls (HDF5 is usually not built thread safe) and
+     // access to s_files
+     static Mutex s_mutex;
      static hid_t openH5File(const std::string& filename);
      static void closeH5File(hid_t h5file);
 
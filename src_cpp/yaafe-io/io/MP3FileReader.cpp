@@ -25,6 +25,7 @@
 #include "MP3FileReader.h"
 #include "yaafe-core/Buffer.h"
 #include "SmarcPFilterCache.h"
+#include "yaafe-core/EngineConfig.h"
 
 #include <cstdio>
 #include <iostream>
@@ -44,10 +45,11 @@ namespace YAAFE {
      MP3Decoder();
      ~MP3Decoder();
 
-     bool openFile(const std::string& filename, bool resample, int outrate);
+     bool openFile(const std::string& filename, bool resample, const std::string& quality, int outrate);
      void closeFile();
      int decode();
      double* outBuffer() { return (m_filter ? m_resampleBuffer : m_outbuffer); }
+     int outRate() const { return m_outrate; }
 
      double m_startSecond;
      double m_limitSecond;
@@ -101,9 +103,6 @@ namespace YAAFE {
   MP3FileReader::MP3Decoder::~MP3Decoder()
   {
     closeFile();
-    if (m_filter) {
-      SmarcPFilterCache::release();
-    }
     mpg123_close(m_mh);
     mpg123_delete_pars(m_mp);
     mpg123_delete(m_mh);
@@ -114,7 +113,8 @@ namespace YAAFE {
     }
   }
 
-  bool MP3FileReader::MP3Decoder::openFile(const std::string& filename, bool resample, int outrate)
+  bool MP3FileReader::MP3Decoder::openFile(const std::string& filename, bool resample,
+      const std::string& quality, int outrate)
   {
     m_resample = resample;
     m_outrate = outrate;
@@ -140,6 +140,9 @@ namespace YAAFE {
       return false;
     }
 
+    if (m_outrate<=0)
+      m_outrate = m_rate; // keep file sample rate
+
     size_t bufferSize = mpg123_outblock(m_mh);
     if (bufferSize != m_bufferSize)
     {
@@ -157,7 +160,7 @@ namespace YAAFE {
         cerr << "ERROR: MP3 file has incorrect sample rate " << m_rate << " (expected " << m_outrate << ")" << endl;
         return false;
       } else {
-        m_filter = SmarcPFilterCache::getPFilter(m_rate,m_outrate);
+        m_filter = SmarcPFilterCache::getPFilter(m_rate,m_outrate,quality);
         if (!m_filter) {
           cerr << "ERROR: cannot resample from " << m_rate << " to " << m_outrate << endl;
           return false;
@@ -209,6 +212,8 @@ namespace YAAFE {
       free(m_buffer);
       m_buffer = NULL;
     }
+    m_bufferSize = 0;
+    m_resampleBufferSize = 0;
     if (m_outbuffer) {
       free(m_outbuffer);
       m_outbuffer = NULL;
@@ -223,7 +228,10 @@ namespace YAAFE {
     }
 
     mpg123_close(m_mh);
-    m_filter = NULL;
+    if (m_filter) {
+      SmarcPFilterCache::release(m_filter);
+      m_filter = NULL;
+    }
   }
 
   int MP3FileReader::MP3Decoder::decode()
@@ -283,14 +291,23 @@ namespace YAAFE {
     return written;
   }
 
-  MP3FileReader::MP3FileReader() : m_rescale(false), m_mean(0.0), m_factor(1.0) {
+  MP3FileReader::MP3FileReader() : m_readAhead(NULL), m_rescale(false), m_mean(0.0), m_factor(1.0) {
     m_decoder = new MP3Decoder();
   }
 
   MP3FileReader::~MP3FileReader() {
+    // stop decode thread before releasing decoder
+    if (m_readAhead)
+      delete m_readAhead;
     delete m_decoder;
   }
 
+  int MP3FileReader::decodeBlock(double*& data) {
+    int read = m_decoder->decode();
+    data = m_decoder->outBuffer();
+    return (read>0 ? read : 0);
+  }
+
   ParameterDescriptorList MP3FileReader::getParameterDescriptorList() const
   {
     ParameterDescriptorList pList;
@@ -312,7 +329,7 @@ namespace YAAFE {
     pList.push_back(p);
 
     p.m_identifier = "SampleRate";
-    p.m_description = "Check audio sample rate.";
+    p.m_description = "Check audio sample rate, 0 to output audio at the file sample rate.";
     p.m_defaultValue = "16000";
     pList.push_back(p);
 
@@ -321,6 +338,11 @@ namespace YAAFE {
     p.m_defaultValue = "no";
     pList.push_back(p);
 
+    p.m_identifier = "ResampleQuality";
+    p.m_description = "high|medium|fast, resampling filter quality. Lower quality resamples faster with a narrower bandwidth and a lower stopband attenuation.";
+    p.m_defaultValue = "high";
+    pList.push_back(p);
+
     p.m_identifier = "TimeStart";
     p.m_description = "time position where to start process, if given a negative value(e.g: \"-10s\" ), it will start at the last 10s.";
     p.m_defaultValue = "0s";
@@ -331,6 +353,11 @@ namespace YAAFE {
     p.m_defaultValue = "0s";
     pList.push_back(p);
 
+    p.m_identifier = "ReadAheadBlocks";
+    p.m_description = "number of blocks decoded in advance by a background thread, 0 to decode when needed";
+    p.m_defaultValue = "0";
+    pList.push_back(p);
+
     return pList;
   }
 
@@ -339,6 +366,7 @@ namespace YAAFE {
     assert(inp.size()==0);
 
     bool resample = (getStringParam("Resample",params)=="yes");
+    string quality = getStringParam("ResampleQuality",params);
     bool removemean = (getStringParam("RemoveMean",params)=="yes");
     double scaleMax = getDoubleParam("ScaleMax",params);
     int sr = getIntParam("SampleRate",params);
@@ -365,7 +393,7 @@ namespace YAAFE {
 
     m_decoder->m_startSecond = startSecond;
     m_decoder->m_limitSecond = limitSecond;
-    if (!m_decoder->openFile(filename,resample,sr))
+    if (!m_decoder->openFile(filename,resample,quality,sr))
       return false;
 
     if (removemean || scaleMax>0) {
@@ -391,7 +419,7 @@ namespace YAAFE {
       max = abs(max-m_mean);
       m_factor = scaleMax / (max>min ? max : min);
       m_decoder->closeFile();
-      if (!m_decoder->openFile(filename,resample,sr)) {
+      if (!m_decoder->openFile(filename,resample,quality,sr)) {
         cerr << "ERROR: cannot re-open file " << filename << " !" << endl;
         return false;
       }
@@ -400,10 +428,21 @@ namespace YAAFE {
     outStreamInfo().add(StreamInfo());
     StreamInfo& out = outStreamInfo()[0].data;
     out.size = 1;
-    out.sampleRate = sr;
+    out.sampleRate = m_decoder->outRate();
     out.frameLength = 1;
     out.sampleStep = 1;
 
+    int readAheadBlocks = getIntParam("ReadAheadBlocks",params);
+    if (readAheadBlocks>0) {
+      m_readAhead = new ReadAhead(this,readAheadBlocks);
+      if (!m_readAhead->start()) {
+        if (EngineConfig::current().verbose())
+          cerr << "WARNING: cannot start read-ahead thread, decode " << filename << " when needed" << endl;
+        delete m_readAhead;
+        m_readAhead = NULL;
+      }
+    }
+
     return true;
   }
 
@@ -418,10 +457,10 @@ namespace YAAFE {
       toRead = DataBlock::preferedBlockSize();
 
     int nbRead = 0;
-    double* buf = m_decoder->outBuffer();
     while (nbRead<toRead)
     {
-      int read = m_decoder->decode();
+      double* buf = NULL;
+      int read = (m_readAhead ? m_readAhead->next(buf) : decodeBlock(buf));
       if (read==0) break;
       if (m_rescale) {
         for (int i=0;i<read;i++) {
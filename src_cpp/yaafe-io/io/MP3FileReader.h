@@ -26,12 +26,13 @@
 #define MP3FILEREADER_H_
 
 #include "yaafe-core/Component.h"
+#include "ReadAhead.h"
 
 #define MP3_FILE_READER_ID "MP3FileReader"
 
 namespace YAAFE {
 
-  class MP3FileReader: public ComponentBase<MP3FileReader> {
+  class MP3FileReader: public ComponentBase<MP3FileReader>, private ReadAhead::Source {
    public:
      MP3FileReader();
      virtual ~MP3FileReader();
@@ -48,10 +49,13 @@ namespace YAAFE {
    private:
      class MP3Decoder;
      MP3Decoder* m_decoder;
+     ReadAhead* m_readAhead;
 
      bool m_rescale;
      double m_mean;
      double m_factor;
+
+     virtual int decodeBlock(double*& data);
   };
 
 }
@@ -0,0 +1,105 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReadAhead.h"
+#include <string.h>
+
+namespace YAAFE
+{
+
+  ReadAhead::ReadAhead(Source* source, int nbBlocks) :
+    m_source(source), m_blocks(nbBlocks<2 ? 2 : nbBlocks),
+    m_sizes(m_blocks.size(),0), m_read(0), m_count(0), m_held(false),
+    m_stop(false)
+  {
+  }
+
+  ReadAhead::~ReadAhead()
+  {
+    {
+      MutexLock lock(m_mutex);
+      m_stop = true;
+      m_cond.broadcast();
+    }
+    join();
+  }
+
+  bool ReadAhead::start()
+  {
+    return Thread::start();
+  }
+
+  void ReadAhead::run()
+  {
+    const int nbBlocks = m_blocks.size();
+    int write = 0;
+    while (true) {
+      {
+        MutexLock lock(m_mutex);
+        while (m_count==nbBlocks && !m_stop)
+          m_cond.wait(m_mutex);
+        if (m_stop)
+          return;
+      }
+      // the block at the write position is not visible to the reader yet
+      double* data = NULL;
+      int size = m_source->decodeBlock(data);
+      if (size<0)
+        size = 0;
+      std::vector<double>& block = m_blocks[write];
+      if ((int)block.size()<size)
+        block.resize(size);
+      if (size>0)
+        memcpy(&block[0],data,size*sizeof(double));
+      MutexLock lock(m_mutex);
+      m_sizes[write] = size;
+      write = (write+1) % nbBlocks;
+      m_count++;
+      m_cond.broadcast();
+      if (size==0)
+        return;
+    }
+  }
+
+  int ReadAhead::next(double*& data)
+  {
+    MutexLock lock(m_mutex);
+    if (m_held) {
+      // release the block returned by previous call
+      m_read = (m_read+1) % m_blocks.size();
+      m_count--;
+      m_held = false;
+      m_cond.broadcast();
+    }
+    while (m_count==0)
+      m_cond.wait(m_mutex);
+    const int size = m_sizes[m_read];
+    if (size==0)
+      return 0; // keep end of stream marker
+    data = &m_blocks[m_read][0];
+    m_held = true;
+    return size;
+  }
+
+}
@@ -0,0 +1,87 @@
+/**
+ * Yaafe
+ *
+ * Copyright (c) 2009-2010 Institut Télécom - Télécom Paristech
+ * Télécom ParisTech / dept. TSI
+ *
+ * Author : Benoit Mathieu
+ *
+ * This file is part of Yaafe.
+ *
+ * Yaafe is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Yaafe is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef READAHEAD_H_
+#define READAHEAD_H_
+
+#include "yaafe-core/Thread.h"
+#include <vector>
+
+namespace YAAFE
+{
+
+  /**
+   * Decodes audio in a background thread into a bounded ring of blocks, so
+   * that file reading and decoding overlap with feature computation. The
+   * decode thread stops when the ring is full, and waits for the reader to
+   * consume blocks.
+   */
+  class ReadAhead : private Thread
+  {
+   public:
+     /**
+      * Source of decoded samples, called from the decode thread only.
+      */
+     class Source {
+      public:
+        virtual ~Source() {}
+        /**
+         * Decode next samples, set data to point to them and return their
+         * number. Returns 0 at end of stream.
+         */
+        virtual int decodeBlock(double*& data) = 0;
+     };
+
+     ReadAhead(Source* source, int nbBlocks);
+     virtual ~ReadAhead();
+
+     /**
+      * Start decoding. Returns false if the decode thread cannot be started.
+      */
+     bool start();
+
+     /**
+      * Wait for the next decoded block, set data to point to it and return
+      * its size. Returns 0 at end of stream. The block can be modified, and
+      * stays valid until the next call.
+      */
+     int next(double*& data);
+
+   private:
+     virtual void run();
+
+     Source* m_source;
+     std::vector<std::vector<double> > m_blocks;
+     std::vector<int> m_sizes;
+     int m_read;   // first decoded block
+     int m_count;  // number of decoded blocks, including the one held by the reader
+     bool m_held;
+     bool m_stop;
+     Mutex m_mutex;
+     Condition m_cond;
+  };
+
+}
+
+#endif /* READAHEAD_H_ */
@@ -26,48 +26,104 @@
 #include <iostream>
 
 #define CACHE_SIZE 5
-#define BANDWIDTH 0.95
 #define RP 0.1
-#define RS 120
 #define TOL 0.000001
 
 using namespace std;
 
 namespace YAAFE {
 
-  std::list<struct PFilter*> SmarcPFilterCache::s_cache;
+  SmarcPFilterCache::EntryList SmarcPFilterCache::s_cache;
+  Mutex SmarcPFilterCache::s_mutex;
 
-  struct PFilter* SmarcPFilterCache::getPFilter(int fsin, int fsout)
+  SmarcPFilterCache::EntryList::~EntryList()
+  {
+    for (iterator it=begin();it!=end();it++)
+      smarc_destroy_pfilter(it->filter);
+  }
+
+  /**
+   * Resampling quality presets: kept bandwidth and stopband attenuation.
+   * Lower quality gives shorter filters.
+   */
+  static bool qualityParameters(const std::string& quality, double& bandwidth, double& rs)
+  {
+    if (quality=="high") {
+      bandwidth = 0.95;
+      rs = 120;
+    } else if (quality=="medium") {
+      bandwidth = 0.9;
+      rs = 90;
+    } else if (quality=="fast") {
+      bandwidth = 0.8;
+      rs = 60;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool SmarcPFilterCache::validQuality(const std::string& quality)
+  {
+    double bandwidth, rs;
+    return qualityParameters(quality,bandwidth,rs);
+  }
+
+  struct PFilter* SmarcPFilterCache::getPFilter(int fsin, int fsout, const std::string& quality)
   {
     if (fsin==fsout)
       return NULL;
+    double bandwidth, rs;
+    if (!qualityParameters(quality,bandwidth,rs)) {
+      cerr << "ERROR: invalid resampling quality " << quality << endl;
+      return NULL;
+    }
+    MutexLock lock(s_mutex);
     // check cache
-    for (list<struct PFilter*>::iterator it=s_cache.begin();it!=s_cache.end();it++)
+    for (EntryList::iterator it=s_cache.begin();it!=s_cache.end();it++)
     {
-      if ((smarc_get_fs_in(*it)==fsin) && (smarc_get_fs_out(*it)==fsout))
+      if (it->fsin==fsin && it->fsout==fsout && it->quality==quality)
       {
-        struct PFilter* f = *it;
+        Entry e = *it;
+        e.refcount++;
         s_cache.erase(it);
-        s_cache.push_front(f);
-        return f;
+        s_cache.push_front(e);
+        return e.filter;
       }
     }
     // create filter and put in cache
     cerr << "initializing Smarc resampler " << fsin << " => " << fsout << endl;
-    s_cache.push_front(smarc_init_pfilter(fsin,fsout,BANDWIDTH,RP,RS,TOL,NULL,1));
+    Entry e;
+    e.filter = smarc_init_pfilter(fsin,fsout,bandwidth,RP,rs,TOL,NULL,1);
+    if (!e.filter)
+      return NULL;
     cerr << "Smarc resampler ok !" << endl;
-    // release old pfilter if cache exceeds size
-    if (s_cache.size()>CACHE_SIZE) {
-      smarc_destroy_pfilter(s_cache.back());
-      s_cache.pop_back();
-    }
-    return s_cache.front();
+    e.fsin = fsin;
+    e.fsout = fsout;
+    e.quality = quality;
+    e.refcount = 1;
+    s_cache.push_front(e);
+    return e.filter;
   }
 
-  void SmarcPFilterCache::release() {
-    for (list<struct PFilter*>::iterator it=s_cache.begin();it!=s_cache.end();it++)
+  void SmarcPFilterCache::release(struct PFilter* filter)
+  {
+    if (!filter)
+      return;
+    MutexLock lock(s_mutex);
+    int unused = 0;
+    EntryList::iterator it=s_cache.begin();
+    while (it!=s_cache.end())
     {
-      smarc_destroy_pfilter(*it);
+      if (it->filter==filter)
+        it->refcount--;
+      if (it->refcount==0 && ++unused>CACHE_SIZE) {
+        // release least recently used filters
+        smarc_destroy_pfilter(it->filter);
+        it = s_cache.erase(it);
+      } else {
+        it++;
+      }
     }
   }
 
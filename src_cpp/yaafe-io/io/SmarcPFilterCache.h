@@ -26,17 +26,48 @@
 #define RESAMPLER_H
 
 #include "smarc.h"
+#include "yaafe-core/Thread.h"
 #include <list>
+#include <string>
 
 namespace YAAFE
 {
 
+  /**
+   * Cache of Smarc resampling filters, shared by all readers. Filters are
+   * reference counted: a filter returned by getPFilter is never destroyed
+   * before being released, and the last unused filters are kept for
+   * next files. The cache can be used from several threads.
+   */
   class SmarcPFilterCache {
    public:
-     static struct PFilter* getPFilter(int fsint, int fsout);
-     static void release();
+     /**
+      * Returns a filter resampling from fsin to fsout with the given quality
+      * ("high", "medium" or "fast"), which must be released with release().
+      * Returns NULL if fsin equals fsout or if the filter cannot be built.
+      */
+     static struct PFilter* getPFilter(int fsin, int fsout, const std::string& quality = "high");
+     static void release(struct PFilter* filter);
+
+     /**
+      * Returns false if quality is not a valid resampling quality.
+      */
+     static bool validQuality(const std::string& quality);
+
    private:
-     static std::list<struct PFilter*> s_cache;
+     struct Entry {
+       struct PFilter* filter;
+       int fsin;
+       int fsout;
+       std::string quality;
+       int refcount;
+     };
+     class EntryList : public std::list<Entry> {
+      public:
+        ~EntryList();
+     };
+     static EntryList s_cache;
+     static Mutex s_mutex;
   };
 
 }
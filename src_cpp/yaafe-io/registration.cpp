@@ -27,6 +27,7 @@
 #include "yaafe-core/ComponentFactory.h"
 
 #include "yaafe-io/io/CSVWriter.h"
+#include "yaafe-io/io/AudioResampler.h"
 #ifdef WITH_SNDFILE
 #include "yaafe-io/io/AudioFileReader.h"
 #endif
@@ -45,6 +46,7 @@ void registerYaafeComponents(void* componentFactory)
   ComponentFactory* factory = reinterpret_cast<ComponentFactory*>(componentFactory);
 
   factory->registerPrototype(new CSVWriter());
+  factory->registerPrototype(new AudioResampler());
 #ifdef WITH_SNDFILE
   factory->registerPrototype(new AudioFileReader());
 #endif
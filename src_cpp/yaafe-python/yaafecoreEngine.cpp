@@ -28,6 +28,7 @@
 #include "stdlib.h"
 #include "string.h"
 #include <iostream>
+#include <sstream>
 
 using namespace YAAFE;
 using namespace std;
@@ -41,12 +42,22 @@ void engine_destroy(void* engine) {
   delete e;
 }
 
+void engine_setFloatPrecision(void* engine, int enable) {
+  Engine* e = static_cast<Engine*>(engine);
+  e->setFloatPrecision(enable!=0);
+}
+
 int engine_load(void* engine, void* dataflow) {
   Engine* e = static_cast<Engine*>(engine);
   DataFlow* df = static_cast<DataFlow*>(dataflow);
   return e->load(*df);
 }
 
+void* engine_clone(void* engine) {
+  Engine* e = static_cast<Engine*>(engine);
+  return e->clone();
+}
+
 char** engine_buildStrList(const vector<string>& vec) {
   char** strList = (char**) malloc((vec.size()+1)*sizeof(char*));
   for (int i=0;i<vec.size();i++)
@@ -67,6 +78,18 @@ char** engine_getOutputList(void* engine) {
   return engine_buildStrList(outputs);
 }
 
+int engine_selectOutputs(void* engine, char** outputs) {
+  Engine* e = static_cast<Engine*>(engine);
+  if (outputs==NULL) {
+    e->selectAllOutputs();
+    return 1;
+  }
+  vector<string> selected;
+  for (char** ptr=outputs;*ptr!=NULL;ptr++)
+    selected.push_back(*ptr);
+  return (e->selectOutputs(selected) ? 1 : 0);
+}
+
 void engine_freeIOList(char** strList) {
   char** ptr = strList;
   while (*ptr!=NULL) {
@@ -186,3 +209,30 @@ void engine_flush(void* engine) {
   e->flush();
 }
 
+void engine_enableProfiling(void* engine, int trace) {
+  Engine* e = static_cast<Engine*>(engine);
+  e->enableProfiling(trace!=0);
+}
+
+void engine_disableProfiling(void* engine) {
+  Engine* e = static_cast<Engine*>(engine);
+  e->disableProfiling();
+}
+
+char* engine_getProfile(void* engine, int trace) {
+  Engine* e = static_cast<Engine*>(engine);
+  Profiler* p = e->getProfiler();
+  if (p==NULL)
+    return NULL;
+  ostringstream oss;
+  if (trace)
+    p->writeTrace(oss);
+  else
+    p->writeJSON(oss);
+  return strdup(oss.str().c_str());
+}
+
+void engine_freeProfile(char* profile) {
+  if (profile!=NULL)
+    free(profile);
+}
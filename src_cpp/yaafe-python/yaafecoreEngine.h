@@ -30,11 +30,14 @@ extern "C" {
   void* engine_create();
   void engine_destroy(void* engine);
 
+  void engine_setFloatPrecision(void* engine, int enable);
   int engine_load(void* engine, void* dataflow);
+  void* engine_clone(void* engine);
 
   char** engine_getInputList(void* engine);
   char** engine_getOutputList(void* engine);
   void engine_freeIOList(char** strList);
+  int engine_selectOutputs(void* engine, char** outputs);
 
   struct IOInfo {
     double sampleRate;
@@ -56,6 +59,11 @@ extern "C" {
   int engine_process(void* engine);
   void engine_flush(void* engine);
 
+  void engine_enableProfiling(void* engine, int trace);
+  void engine_disableProfiling(void* engine);
+  char* engine_getProfile(void* engine, int trace);
+  void engine_freeProfile(char* profile);
+
 }
 
 
@@ -271,13 +271,19 @@ yaafecore.engine_create.restype = c_void_p
 yaafecore.engine_create.argtypes = []
 yaafecore.engine_destroy.restype = None
 yaafecore.engine_destroy.argtypes = [c_void_p]
+yaafecore.engine_setFloatPrecision.restype = None
+yaafecore.engine_setFloatPrecision.argtypes = [c_void_p, c_int]
 yaafecore.engine_load.argtypes = [c_void_p, c_void_p]
+yaafecore.engine_clone.restype = c_void_p
+yaafecore.engine_clone.argtypes = [c_void_p]
 yaafecore.engine_getInputList.restype = POINTER(c_char_p)
 yaafecore.engine_getInputList.argtypes = [c_void_p]
 yaafecore.engine_getOutputList.restype = POINTER(c_char_p)
 yaafecore.engine_getOutputList.argtypes = [c_void_p]
 yaafecore.engine_freeIOList.restype = None
 yaafecore.engine_freeIOList.argtypes = [POINTER(c_char_p)]
+yaafecore.engine_selectOutputs.restype = c_int
+yaafecore.engine_selectOutputs.argtypes = [c_void_p, POINTER(c_char_p)]
 
 
 class IOInfo(Structure):
@@ -321,3 +327,11 @@ yaafecore.engine_process.restype = None
 yaafecore.engine_process.argtypes = [c_void_p]
 yaafecore.engine_flush.restype = None
 yaafecore.engine_flush.argtypes = [c_void_p]
+yaafecore.engine_enableProfiling.restype = None
+yaafecore.engine_enableProfiling.argtypes = [c_void_p, c_int]
+yaafecore.engine_disableProfiling.restype = None
+yaafecore.engine_disableProfiling.argtypes = [c_void_p]
+yaafecore.engine_getProfile.restype = c_void_p
+yaafecore.engine_getProfile.argtypes = [c_void_p, c_int]
+yaafecore.engine_freeProfile.restype = None
+yaafecore.engine_freeProfile.argtypes = [c_void_p]
@@ -24,7 +24,8 @@
 
 from __future__ import absolute_import, print_function
 
-from ctypes import c_int, pointer
+import json
+from ctypes import c_int, c_char_p, pointer, cast
 
 from yaafelib._compat import to_char, to_str
 from yaafelib.core import yaafecore as yc
@@ -136,6 +137,18 @@ class Engine(object):
     def __del__(self):
         yc.engine_destroy(self.ptr)
 
+    def setFloatPrecision(self, enable=True):
+        """
+            Use single precision kernels in components supporting them,
+            which is faster but less accurate. Streams between such
+            components, like the spectrum read by the spectral
+            descriptors, hold single precision values. Must be called
+            before :py:meth:`load`. Components whose ``KernelPrecision``
+            parameter is set to ``double`` in the dataflow are not
+            affected.
+        """
+        yc.engine_setFloatPrecision(self.ptr, enable and 1 or 0)
+
     def load(self, dataflow):
         """
             Configure engine according to the given dataflow.
@@ -153,6 +166,22 @@ class Engine(object):
         raise TypeError('dataflow parameter must be a DataFlow object or '
                         'dataflow filename !')
 
+    def clone(self):
+        """
+            Create a new engine processing the same dataflow. Precomputed
+            component data (kernels, filter banks, fft plans) is shared
+            with this engine, so cloning a loaded engine is much faster
+            than loading the dataflow again.
+
+            :return: a new :py:class:`Engine`, or None on fail.
+        """
+        ptr = yc.engine_clone(self.ptr)
+        if not ptr:
+            return None
+        e = Engine.__new__(Engine)
+        e.ptr = ptr
+        return e
+
     def getInputs(self):
         """
             Get input metadata. Result format is the same as for
@@ -213,6 +242,25 @@ class Engine(object):
         yc.engine_freeIOList(oList)
         return res
 
+    def selectOutputs(self, names=None):
+        """
+            Compute only the given outputs. Steps of the dataflow which are
+            not needed by these outputs are skipped, so that a subset of the
+            features of a large dataflow can be extracted without loading
+            another dataflow. Other outputs are empty.
+
+            :param names: output names, or None to compute all outputs
+                          (default).
+            :type names: list of string
+            :return: True on success, False if an output does not exist.
+        """
+        if names is None:
+            return yc.engine_selectOutputs(self.ptr, None) and True or False
+        arr = (c_char_p * (len(names) + 1))()
+        arr[:-1] = [to_char(n) for n in names]
+        arr[-1] = None
+        return yc.engine_selectOutputs(self.ptr, arr) and True or False
+
     def writeInput(self, name, data):
         """
             Write data on an input.
@@ -301,3 +349,48 @@ class Engine(object):
         self.process()
         self.flush()
         return self.readAllOutputs()
+
+    def enableProfiling(self, trace=False):
+        """
+            Enable runtime profiling of all processing steps. Statistics
+            are accumulated over all subsequent calls to :py:meth:`process`
+            and :py:meth:`flush`, until :py:meth:`disableProfiling` is
+            called. If *trace* is True, each component call is also
+            recorded (see :py:meth:`getTrace`).
+        """
+        yc.engine_enableProfiling(self.ptr, trace and 1 or 0)
+
+    def disableProfiling(self):
+        """
+            Disable profiling and discard collected statistics.
+        """
+        yc.engine_disableProfiling(self.ptr)
+
+    def _getProfile(self, trace):
+        ptr = yc.engine_getProfile(self.ptr, trace)
+        if not ptr:
+            return None
+        buf = cast(ptr, c_char_p).value
+        yc.engine_freeProfile(ptr)
+        return json.loads(to_str(buf))
+
+    def getProfile(self):
+        """
+            Get profiling statistics, or None if profiling is not enabled.
+
+            :return: dictionary with a *steps* list, with for each processing
+                     step its *name*, *component*, number of *calls*,
+                     *wallTime* and *cpuTime* (in seconds), *tokensIn*,
+                     *tokensOut*, *bytesIn*, *bytesOut*, *peakQueuedBlocks*
+                     and *allocations*.
+        """
+        return self._getProfile(0)
+
+    def getTrace(self):
+        """
+            Get recorded component calls in the Chrome trace event format
+            (can be saved with :py:func:`json.dump` and opened in
+            chrome://tracing), or None if profiling is not enabled. Events
+            are recorded only if profiling was enabled with *trace=True*.
+        """
+        return self._getProfile(1)
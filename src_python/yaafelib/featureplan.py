@@ -101,6 +101,11 @@ class FeaturePlan(object):
             Add a feature defined according the
             :ref:`feature definition syntax <featplan>`.
 
+            The feature name may be followed by ``@samplerate`` to extract
+            the feature at another sample rate, for example
+            ``'mfcc16k@16000: MFCC blockSize=512 stepSize=256'``. The audio
+            is decoded once, and resampled for each sample rate.
+
             :param definition: feature definition
             :type definition: string
             :rtype: True on success, False on fail.
@@ -110,8 +115,32 @@ class FeaturePlan(object):
             print('Syntax error in "%s"' % definition)
             return False
         name, featdef = data
+        name = name.strip()
+        # name@rate extracts the feature at another sample rate, from
+        # another input resampling the same audio
+        sample_rate = self.sample_rate
+        audio_params = self.audio_params
+        out_attrs = self.out_attrs
+        input_name = 'audio'
+        if '@' in name:
+            name, rate = name.split('@', 1)
+            try:
+                sample_rate = int(rate)
+            except ValueError:
+                sample_rate = 0
+            if sample_rate <= 0:
+                print('Invalid sample rate "%s" in "%s"' % (rate, definition))
+                return False
+            if sample_rate != self.sample_rate:
+                audio_params = dict(self.audio_params)
+                audio_params['SampleRate'] = str(sample_rate)
+                audio_params['Resample'] = 'yes'
+                out_attrs = dict(self.out_attrs)
+                out_attrs['samplerate'] = str(sample_rate)
+                out_attrs['resample'] = 'yes'
+                input_name = 'audio_%i' % sample_rate
         dataflow = DataFlow()
-        dataflow.createInput('audio', self.audio_params)
+        dataflow.createInput(input_name, audio_params)
         if featdef.strip():
             for s in featdef.split('>'):
                 s = s.strip()
@@ -131,9 +160,9 @@ class FeaturePlan(object):
                         print('Syntax error in feature parameter "%s"' % d)
                         return False
                     params[dd[0]] = dd[1]
-                dataflow.append(feat.get_dataflow(params, self.sample_rate))
+                dataflow.append(feat.get_dataflow(params, sample_rate))
         fNode = dataflow.finalNodes()[0]
-        feat_attrs = self.out_attrs.copy()
+        feat_attrs = out_attrs.copy()
         feat_attrs['yaafedefinition'] = featdef.strip()
         outNode = dataflow.createOutput(name, feat_attrs)
         dataflow.link(fNode, '', outNode, '')
@@ -312,7 +312,7 @@ class SpectralFlatnessPerBand(AudioFeature):
     '''
     COMPONENT_LIBS = ['yaafe-components']
     PARAMS = [(MagnitudeSpectrum, {}),
-              ('Sqr', {}),
+              ('Sqr', {'KernelPrecision': None}),
               ('SpectralFlatnessPerBand', {})]
 
     @classmethod
@@ -331,7 +331,7 @@ class SpectralCrestFactorPerBand(AudioFeature):
     '''
     COMPONENT_LIBS = ['yaafe-components']
     PARAMS = [(MagnitudeSpectrum, {}),
-              ('Sqr', {}),
+              ('Sqr', {'KernelPrecision': None}),
               ('SpectralCrestFactorPerBand', {})]
 
     @classmethod
@@ -710,7 +710,7 @@ class Loudness(AudioFeature):
     '''
     COMPONENT_LIBS = ['yaafe-components']
     PARAMS = [(MagnitudeSpectrum, {}),
-              ('Sqr', {}),
+              ('Sqr', {'KernelPrecision': None}),
               ('Loudness', {}),
               ('LMode', 'Relative',
                '"Specific" computes loudness without normalization, '
@@ -723,11 +723,15 @@ class Loudness(AudioFeature):
         df = MagnitudeSpectrum.get_dataflow(
             MagnitudeSpectrum.filter_params(params), samplerate)
         dataflow_safe_append(df, 'Sqr', {})
+        if (params['LMode'] == 'Total'):
+            # same as Loudness > Sum, in a single pass
+            lParams = params.copy()
+            lParams['LDescriptors'] = 'Total'
+            dataflow_safe_append(df, 'LoudnessDescriptors', lParams)
+            return df
         dataflow_safe_append(df, 'Loudness', params)
         if (params['LMode'] == 'Relative'):
             dataflow_safe_append(df, 'Normalize', {'NNorm': 'Sum'})
-        elif (params['LMode'] == 'Total'):
-            dataflow_safe_append(df, 'Sum', {})
         return df
 
 
@@ -738,16 +742,19 @@ class PerceptualSharpness(AudioFeature):
     according to [GP2004]_.
     '''
     COMPONENT_LIBS = ['yaafe-components']
-    PARAMS = [(Loudness, {'LMode': None}),
-              ('LoudnessSharpness', {})]
+    PARAMS = [(MagnitudeSpectrum, {}),
+              ('Sqr', {'KernelPrecision': None}),
+              ('LoudnessDescriptors', {'LDescriptors': None})]
 
     @classmethod
     @check_dataflow_params
     def get_dataflow(cls, params, samplerate):
-        lParams = Loudness.filter_params(params)
-        lParams['LMode'] = 'Relative'
-        df = Loudness.get_dataflow(lParams, samplerate)
-        dataflow_safe_append(df, 'LoudnessSharpness', {})
+        df = MagnitudeSpectrum.get_dataflow(
+            MagnitudeSpectrum.filter_params(params), samplerate)
+        dataflow_safe_append(df, 'Sqr', {})
+        lParams = params.copy()
+        lParams['LDescriptors'] = 'Sharpness'
+        dataflow_safe_append(df, 'LoudnessDescriptors', lParams)
         return df
 
 
@@ -758,16 +765,19 @@ class PerceptualSpread(AudioFeature):
     according to [GP2004]_.
     '''
     COMPONENT_LIBS = ['yaafe-components']
-    PARAMS = [(Loudness, {'LMode': None}),
-              ('LoudnessSpread', {})]
+    PARAMS = [(MagnitudeSpectrum, {}),
+              ('Sqr', {'KernelPrecision': None}),
+              ('LoudnessDescriptors', {'LDescriptors': None})]
 
     @classmethod
     @check_dataflow_params
     def get_dataflow(cls, params, samplerate):
-        lParams = Loudness.filter_params(params)
-        lParams['LMode'] = 'Relative'
-        df = Loudness.get_dataflow(lParams, samplerate)
-        dataflow_safe_append(df, 'LoudnessSpread', {})
+        df = MagnitudeSpectrum.get_dataflow(
+            MagnitudeSpectrum.filter_params(params), samplerate)
+        dataflow_safe_append(df, 'Sqr', {})
+        lParams = params.copy()
+        lParams['LDescriptors'] = 'Spread'
+        dataflow_safe_append(df, 'LoudnessDescriptors', lParams)
         return df
 
 
@@ -783,7 +793,7 @@ class OBSI(AudioFeature):
     '''
     COMPONENT_LIBS = ['yaafe-components']
     PARAMS = [(MagnitudeSpectrum, {}),
-              ('Sqr', {}),
+              ('Sqr', {'KernelPrecision': None}),
               ('OBSI', {})]
 
     @classmethod
@@ -924,61 +934,30 @@ class CQT(AudioFeature):
     def get_dataflow(cls, params, samplerate):
         nboct = decimal.Decimal(params['CQTNbOctaves'])
         original_fs = samplerate
-        original_step = int(params['stepSize'])
         samplerate = decimal.Decimal(samplerate)
         minFreq = decimal.Decimal(params['CQTMinFreq']) * (2 ** (nboct - 1))
         bandwidth = decimal.Decimal('0.95')
         # create dataflow
         df = DataFlow()
         signal_node = None
-        # decimate until first octave to analyse
-        nbdecim = 0
+        # decimate until first octave to analyse, these decimations can be
+        # shared with other features
         while ((bandwidth * samplerate / 8) > minFreq):
             s = df.createNode('Decimate2', {})
             if signal_node:
                 df.link(signal_node, '', s, '')
             signal_node = s
             samplerate = samplerate / 2
-            nbdecim = nbdecim + 1
-        # check stepsize is OK with decimation
-#        stepSize = int(params['stepSize'])
-#        if (stepSize % (2**(nbdecim+nboct-1)))!=0:
-#            stepSize = stepSize - stepSize % (2**(nbdecim+nboct-1))
-#            print('WARNING: adjust stepSize to %i to make it compatible with successive decimation'%stepSize)
-        # compute octave CQT parameters
-        Q = 2 / (2 ** (1.0 / int(params['CQTBinsPerOctave'])) - 1)
-        fftLen = Q * float(samplerate / minFreq)
-        fftLen = pow(2, math.ceil(math.log(fftLen) / math.log(2)))
-#        current_stepSize = stepSize / (2**nbdecim)
-        oct_params = {'CQTBinsPerOctave': params['CQTBinsPerOctave'],
-                      'CQTAlign': params['CQTAlign'],
-                      'CQTMinFreq': '%s' % str(minFreq / samplerate),
-                      'CQTMaxFreq': '%s' % str(2 * minFreq / samplerate - decimal.Decimal('1e-14'))}
-        # for each octave, analysis, concatenate and decimation
-        concat_node = df.createNode('Concatenate', {})
-        for oct in range(int(nboct), 0, -1):
-            frames = df.createNode('AdvancedFrameTokenizer',
-                                   {'blockSize': '%i' % fftLen,
-                                    'outStepSize': '%i' % original_step,
-                                    'outSampleRate': '%f' % original_fs})
-            if signal_node:
-                df.link(signal_node, '', frames, '')
-            cspec = df.createNode(
-                'FFT', {'FFTLength': '%i' % fftLen, 'FFTWindow': 'None'})
-            df.link(frames, '', cspec, '')
-            oct_cq = df.createNode('CQT', oct_params)
-            df.link(cspec, '', oct_cq, '')
-            df.link(oct_cq, '', concat_node, '%i' % (oct - 1))
-            if (oct == 1):
-                # no more octave to analyze, no need to decimate any more
-                break
-            # decimation for next actave analysis
-            s = df.createNode('Decimate2', {})
-            if signal_node:
-                df.link(signal_node, '', s, '')
-            signal_node = s
-#            current_stepSize = current_stepSize / 2
-            minFreq = minFreq / 2
+        # decimations and analysis of each octave
+        cqt = df.createNode('MultiOctaveCQT',
+                            {'CQTMinFreq': params['CQTMinFreq'],
+                             'CQTBinsPerOctave': params['CQTBinsPerOctave'],
+                             'CQTAlign': params['CQTAlign'],
+                             'CQTNbOctaves': params['CQTNbOctaves'],
+                             'stepSize': params['stepSize'],
+                             'outSampleRate': '%f' % original_fs})
+        if signal_node:
+            df.link(signal_node, '', cqt, '')
         return df
 
 